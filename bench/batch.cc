@@ -0,0 +1,80 @@
+#include<cerberus-cpp/validator.hh>
+#include<yaml-cpp/yaml.h>
+
+#include<algorithm>
+#include<chrono>
+#include<cstdlib>
+#include<iostream>
+#include<string>
+#include<thread>
+#include<vector>
+
+// Compares validating a batch of documents in a serial loop with validateBatch
+// Usage: benchbatch [documents] [repetitions]
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+  const std::size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  const int repetitions = (argc > 2) ? std::atoi(argv[2]) : 3;
+
+  cerberus::Validator validator;
+  auto schema = validator.compile(YAML::Load(
+    "name: {type: string, regex: '[a-z]+[0-9]*'}\n"
+    "age: {type: integer, min: 0, max: 150}\n"
+    "email: {type: string, regex: '[^@]+@[^@]+'}\n"
+    "roles: {type: list, schema: {type: string, allowed: [admin, user, guest]}}\n"
+    "address: {type: dict, schema: {street: {type: string}, zip: {type: integer}}}\n"
+  ));
+
+  std::vector<YAML::Node> documents;
+  for(std::size_t i = 0; i < count; ++i)
+  {
+    auto index = std::to_string(i);
+    documents.push_back(YAML::Load(
+      "{name: user" + index + ", age: " + std::to_string(i % 200) + ", email: user" + index + "@example.com, "
+      "roles: [user, guest], address: {street: Main Street, zip: " + index + "}}"
+    ));
+  }
+
+  double serial = 1e300;
+  std::size_t valid = 0;
+  for(int r = 0; r < repetitions; ++r)
+  {
+    valid = 0;
+    auto start = std::chrono::steady_clock::now();
+    for(const auto& document : documents)
+      valid += validator.validate(document, schema) ? 1 : 0;
+    serial = std::min(serial, seconds_since(start));
+  }
+  std::cout << "documents: " << count << ", valid: " << valid << std::endl;
+  std::cout << "serial:    " << static_cast<std::size_t>(count / serial) << " docs/s" << std::endl;
+
+  const std::size_t hardware = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+  std::vector<std::size_t> thread_counts;
+  for(std::size_t threads = 1; threads < hardware; threads *= 2)
+    thread_counts.push_back(threads);
+  thread_counts.push_back(hardware);
+
+  for(auto threads : thread_counts)
+  {
+    cerberus::ThreadPool pool(threads);
+    cerberus::BatchOptions options;
+    options.pool = &pool;
+
+    double batch = 1e300;
+    for(int r = 0; r < repetitions; ++r)
+    {
+      auto start = std::chrono::steady_clock::now();
+      auto results = validator.validateBatch(documents, schema, options);
+      batch = std::min(batch, seconds_since(start));
+    }
+    std::cout << "threads " << threads << ": " << static_cast<std::size_t>(count / batch) << " docs/s, speedup "
+              << serial / batch << std::endl;
+  }
+  return 0;
+}
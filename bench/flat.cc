@@ -0,0 +1,103 @@
+#include<cerberus-cpp/flat.hh>
+#include<cerberus-cpp/validator.hh>
+#include<yaml-cpp/yaml.h>
+
+#include<algorithm>
+#include<chrono>
+#include<cstdlib>
+#include<fstream>
+#include<iostream>
+#include<sstream>
+#include<string>
+
+// Compares loading and validating a large document with yaml-cpp and the flat document model
+// Usage: benchflat [entries] [repetitions] [schema.yml document.yml]
+// Without files, a document with a list of generated user records is used.
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static std::string read_file(const std::string& filename)
+{
+  std::ifstream stream(filename);
+  if(!stream)
+  {
+    std::cerr << "Cannot open " << filename << std::endl;
+    std::exit(1);
+  }
+  std::stringstream buffer;
+  buffer << stream.rdbuf();
+  return buffer.str();
+}
+
+template<typename F>
+static double best_of(int repetitions, F&& f)
+{
+  double best = 1e300;
+  for(int r = 0; r < repetitions; ++r)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    best = std::min(best, seconds_since(start));
+  }
+  return best;
+}
+
+int main(int argc, char** argv)
+{
+  const std::size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  const int repetitions = (argc > 2) ? std::atoi(argv[2]) : 3;
+
+  YAML::Node schema;
+  std::string text;
+  if(argc > 4)
+  {
+    schema = YAML::LoadFile(argv[3]);
+    text = read_file(argv[4]);
+  }
+  else
+  {
+    schema = YAML::Load(
+      "users:\n"
+      "  type: list\n"
+      "  schema:\n"
+      "    type: dict\n"
+      "    schema:\n"
+      "      name: {type: string, regex: '[a-z]+[0-9]*'}\n"
+      "      age: {type: integer, min: 0, max: 150}\n"
+      "      email: {type: string, regex: '[^@]+@[^@]+'}\n"
+      "      roles: {type: list, schema: {type: string, allowed: [admin, user, guest]}}\n"
+      "      address: {type: dict, schema: {street: {type: string}, zip: {type: integer}}}\n"
+    );
+    std::ostringstream document;
+    document << "users:\n";
+    for(std::size_t i = 0; i < count; ++i)
+      document << "  - {name: user" << i << ", age: " << 1 + i % 100 << ", email: user" << i << "@example.com, "
+               << "roles: [user, guest], address: {street: Main Street, zip: " << i << "}}\n";
+    text = document.str();
+  }
+
+  cerberus::Validator validator;
+  cerberus::FlatValidator flat_validator;
+  auto compiled = validator.compile(schema);
+  auto flat_compiled = flat_validator.compile(schema);
+
+  YAML::Node yaml;
+  cerberus::FlatDocument flat;
+  const double load_yaml = best_of(repetitions, [&](){ yaml = YAML::Load(text); });
+  const double load_flat = best_of(repetitions, [&](){ flat = cerberus::FlatDocument::load(text); });
+
+  bool valid_yaml = false, valid_flat = false;
+  const double validate_yaml = best_of(repetitions, [&](){ valid_yaml = validator.validate(yaml, compiled); });
+  const double validate_flat = best_of(repetitions, [&](){ valid_flat = flat_validator.validate(flat.root(), flat_compiled); });
+
+  std::cout << "document: " << text.size() << " bytes, " << flat.nodeCount() << " nodes" << std::endl;
+  std::cout << "valid:    yaml-cpp " << valid_yaml << ", flat " << valid_flat << std::endl;
+  std::cout << "load:     yaml-cpp " << load_yaml << " s, flat " << load_flat << " s, speedup "
+            << load_yaml / load_flat << std::endl;
+  std::cout << "validate: yaml-cpp " << validate_yaml << " s, flat " << validate_flat << " s, speedup "
+            << validate_yaml / validate_flat << std::endl;
+  return 0;
+}
@@ -0,0 +1,80 @@
+#include<cerberus-cpp/flat.hh>
+#include<cerberus-cpp/json.hh>
+#include<cerberus-cpp/validator.hh>
+#include<yaml-cpp/yaml.h>
+
+#include<algorithm>
+#include<chrono>
+#include<cstdlib>
+#include<iostream>
+#include<sstream>
+#include<string>
+
+// Compares parsing JSON with yaml-cpp and with the JsonParser
+// Usage: benchjson [entries] [repetitions]
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+static double best_of(int repetitions, F&& f)
+{
+  double best = 1e300;
+  for(int r = 0; r < repetitions; ++r)
+  {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    best = std::min(best, seconds_since(start));
+  }
+  return best;
+}
+
+int main(int argc, char** argv)
+{
+  const std::size_t count = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  const int repetitions = (argc > 2) ? std::atoi(argv[2]) : 3;
+
+  std::ostringstream json;
+  json << "{\"users\": [";
+  for(std::size_t i = 0; i < count; ++i)
+    json << (i > 0 ? ",\n" : "\n") << "{\"name\": \"user" << i << "\", \"age\": " << 1 + i % 100 << ", \"email\": \"user" << i
+         << "@example.com\", \"roles\": [\"user\", \"guest\"], \"address\": {\"street\": \"Main Street\", \"zip\": " << i << "}}";
+  json << "]}";
+  const std::string text = json.str();
+
+  cerberus::Validator validator;
+  auto schema = validator.compile(YAML::Load(
+    "users:\n"
+    "  type: list\n"
+    "  schema:\n"
+    "    type: dict\n"
+    "    schema:\n"
+    "      name: {type: string, regex: '[a-z]+[0-9]*'}\n"
+    "      age: {type: integer, min: 0, max: 150}\n"
+    "      email: {type: string, regex: '[^@]+@[^@]+'}\n"
+    "      roles: {type: list, schema: {type: string, allowed: [admin, user, guest]}}\n"
+    "      address: {type: dict, schema: {street: {type: string}, zip: {type: integer}}}\n"
+  ));
+
+  YAML::Node node;
+  const double yaml = best_of(repetitions, [&](){ node = YAML::Load(text); });
+  const double parser = best_of(repetitions, [&](){
+    cerberus::NodeBuilder builder;
+    cerberus::JsonParser(text).parse(builder);
+    node = builder.node();
+  });
+  const double flat = best_of(repetitions, [&](){ cerberus::FlatDocument::loadJson(text); });
+
+  bool valid_yaml = false, valid_json = false;
+  const double validate_yaml = best_of(repetitions, [&](){ valid_yaml = validator.validate(YAML::Load(text), schema); });
+  const double validate_json = best_of(repetitions, [&](){ valid_json = validator.validateJson(text, schema); });
+
+  std::cout << "document:      " << text.size() << " bytes" << std::endl;
+  std::cout << "parse:         yaml-cpp " << yaml << " s, JsonParser " << parser << " s, speedup " << yaml / parser << std::endl;
+  std::cout << "parse flat:    " << flat << " s, speedup " << yaml / flat << std::endl;
+  std::cout << "load+validate: yaml-cpp " << validate_yaml << " s (valid " << valid_yaml << "), validateJson "
+            << validate_json << " s (valid " << valid_json << "), speedup " << validate_yaml / validate_json << std::endl;
+  return 0;
+}
@@ -0,0 +1,463 @@
+#include<cerberus-cpp/validator.hh>
+#include<yaml-cpp/yaml.h>
+
+#include<algorithm>
+#include<atomic>
+#include<chrono>
+#include<cstdlib>
+#include<cstring>
+#include<functional>
+#include<iomanip>
+#include<iostream>
+#include<new>
+#include<sstream>
+#include<string>
+#include<vector>
+
+// A suite of micro and macro benchmarks whose results can be compared across releases
+// Usage: cerberus-bench [--format csv|json] [--filter substring] [--min-time seconds] [--repetitions n]
+//
+// Every benchmark is run in batches of doubling size until a batch takes at least the
+// minimum time. The fastest of the repeated batches is reported as nanoseconds and heap
+// allocations per operation. Throughput is given in document nodes per second.
+
+static std::atomic<std::size_t> allocation_count(0);
+static std::atomic<std::size_t> allocated_bytes(0);
+
+// The replacements are not inlined, as GCC would otherwise pair the inlined malloc with
+// calls to operator delete and warn about mismatched allocation functions
+__attribute__((noinline)) void* operator new(std::size_t size)
+{
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if(void* pointer = std::malloc(size ? size : 1))
+    return pointer;
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](std::size_t size)
+{
+  return operator new(size);
+}
+
+__attribute__((noinline)) void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+__attribute__((noinline)) void operator delete(void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+__attribute__((noinline)) void operator delete[](void* pointer) noexcept
+{
+  operator delete(pointer);
+}
+
+__attribute__((noinline)) void operator delete[](void* pointer, std::size_t) noexcept
+{
+  operator delete(pointer);
+}
+
+#ifdef __cpp_aligned_new
+__attribute__((noinline)) void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  void* pointer = nullptr;
+  if(posix_memalign(&pointer, std::max(static_cast<std::size_t>(alignment), sizeof(void*)), size ? size : 1) == 0)
+    return pointer;
+  throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+  return operator new(size, alignment);
+}
+
+__attribute__((noinline)) void operator delete(void* pointer, std::align_val_t) noexcept
+{
+  std::free(pointer);
+}
+
+__attribute__((noinline)) void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+  std::free(pointer);
+}
+
+__attribute__((noinline)) void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+  std::free(pointer);
+}
+
+__attribute__((noinline)) void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+  std::free(pointer);
+}
+#endif
+
+namespace {
+
+  struct Benchmark
+  {
+    std::string name;
+    // The operation to measure, returns whether the document was valid
+    std::function<bool()> operation;
+    // The number of document nodes that one operation processes
+    std::size_t nodes;
+  };
+
+  struct Result
+  {
+    std::string name;
+    std::size_t iterations;
+    double ns_per_op;
+    double allocs_per_op;
+    double bytes_per_op;
+    std::size_t nodes;
+  };
+
+  // Prevents the compiler from discarding the measured operations
+  volatile bool sink;
+
+  std::size_t count_nodes(const YAML::Node& node)
+  {
+    std::size_t count = 1;
+    if(node.IsSequence())
+      for(auto element : node)
+        count += count_nodes(element);
+    if(node.IsMap())
+      for(auto entry : node)
+        count += count_nodes(entry.second);
+    return count;
+  }
+
+  Result measure(const Benchmark& benchmark, double min_time, int repetitions)
+  {
+    // Warm up
+    sink = benchmark.operation();
+
+    Result result{benchmark.name, 0, 1e300, 0.0, 0.0, benchmark.nodes};
+    std::size_t iterations = 1;
+    for(int r = 0; r < repetitions; ++r)
+    {
+      while(true)
+      {
+        const auto allocations_before = allocation_count.load(std::memory_order_relaxed);
+        const auto bytes_before = allocated_bytes.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+        for(std::size_t i = 0; i < iterations; ++i)
+          sink = benchmark.operation();
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const auto allocations = allocation_count.load(std::memory_order_relaxed) - allocations_before;
+        const auto bytes = allocated_bytes.load(std::memory_order_relaxed) - bytes_before;
+
+        if((elapsed < min_time) && (iterations < (std::size_t(1) << 40)))
+        {
+          iterations *= 2;
+          continue;
+        }
+
+        const double ns_per_op = elapsed * 1e9 / iterations;
+        if(ns_per_op < result.ns_per_op)
+        {
+          result.iterations = iterations;
+          result.ns_per_op = ns_per_op;
+          result.allocs_per_op = static_cast<double>(allocations) / iterations;
+          result.bytes_per_op = static_cast<double>(bytes) / iterations;
+        }
+        break;
+      }
+    }
+    return result;
+  }
+
+  // A benchmark that validates a document against a schema with a shared validator
+  Benchmark validation(const std::string& name, const YAML::Node& schema, const YAML::Node& document,
+                       const std::vector<std::pair<std::string, YAML::Node>>& registry = {})
+  {
+    auto validator = std::make_shared<cerberus::Validator>();
+    for(const auto& entry : registry)
+      validator->registerSchema(entry.first, entry.second);
+    auto compiled = validator->compile(schema);
+    if(!validator->validate(document, compiled))
+    {
+      std::cerr << name << ": the benchmark document is not valid" << std::endl << *validator;
+      std::exit(1);
+    }
+    return Benchmark{name, [validator, compiled, document](){ return validator->validate(document, compiled); }, count_nodes(document)};
+  }
+
+  // A schema for a single field "value" with the given rules and the corresponding document
+  Benchmark rule(const std::string& name, const std::string& rules, const std::string& value, const std::string& siblings = "")
+  {
+    return validation("rule/" + name,
+                      YAML::Load("value: " + rules + "\n" + siblings),
+                      YAML::Load("value: " + value));
+  }
+
+  std::vector<Benchmark> builtin_rules()
+  {
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back(rule("(none)", "{}", "1"));
+    benchmarks.push_back(rule("allow_unknown", "{type: dict, allow_unknown: true}", "{a: 1, b: 2}"));
+    benchmarks.push_back(rule("allowed", "{type: string, allowed: [red, green, blue, black, white]}", "white"));
+    benchmarks.push_back(rule("contains", "{type: list, contains: [c]}", "[a, b, c, d]"));
+    benchmarks.push_back(validation("rule/default", YAML::Load("value: {default: 42}\nother: {}"), YAML::Load("other: 1")));
+    benchmarks.push_back(rule("dependencies", "{dependencies: other}", "1\nother: 2", "other: {}"));
+    benchmarks.push_back(rule("empty", "{empty: false}", "abc"));
+    benchmarks.push_back(rule("excludes", "{excludes: other}", "1", "other: {}"));
+    benchmarks.push_back(rule("forbidden", "{type: string, forbidden: [red, green, blue, black, white]}", "yellow"));
+    benchmarks.push_back(rule("items", "{type: list, items: [{}, {}, {}]}", "[1, a, true]"));
+    benchmarks.push_back(rule("keysrules", "{type: dict, keysrules: {}}", "{a: 1, b: 2}"));
+    benchmarks.push_back(rule("max", "{type: integer, max: 100}", "42"));
+    benchmarks.push_back(rule("maxlength", "{type: list, maxlength: 10}", "[1, 2, 3]"));
+    benchmarks.push_back(rule("meta", "{meta: {description: A value}}", "1"));
+    benchmarks.push_back(rule("min", "{type: integer, min: 0}", "42"));
+    benchmarks.push_back(rule("minlength", "{type: list, minlength: 1}", "[1, 2, 3]"));
+    benchmarks.push_back(rule("nullable", "{nullable: true}", "~"));
+    benchmarks.push_back(rule("purge_unknown", "{type: dict, purge_unknown: true, schema: {}}", "{a: 1}"));
+    benchmarks.push_back(rule("regex", "{regex: '[a-z]+[0-9]*'}", "user42"));
+    benchmarks.push_back(rule("rename", "{rename: renamed}", "1", "renamed: {}"));
+    benchmarks.push_back(rule("require_all", "{type: dict, require_all: true, schema: {a: {}}}", "{a: 1}"));
+    benchmarks.push_back(rule("required", "{required: true}", "1"));
+    benchmarks.push_back(rule("schema", "{type: dict, schema: {a: {}}}", "{a: 1}"));
+    benchmarks.push_back(rule("type", "{type: integer}", "42"));
+    benchmarks.push_back(rule("valuesrules", "{type: dict, valuesrules: {}}", "{a: 1, b: 2}"));
+    return benchmarks;
+  }
+
+  const char* record_schema =
+    "name: {type: string, regex: '[a-z]+[0-9]*'}\n"
+    "age: {type: integer, min: 0, max: 150}\n"
+    "email: {type: string, regex: '[^@]+@[^@]+'}\n"
+    "roles: {type: list, schema: {type: string, allowed: [admin, user, guest]}}\n"
+    "address: {type: dict, schema: {street: {type: string}, zip: {type: integer}}}\n";
+
+  std::vector<Benchmark> schemas()
+  {
+    std::vector<Benchmark> benchmarks;
+    benchmarks.push_back(Benchmark{"construct/validator", [](){ cerberus::Validator validator; return true; }, 0});
+
+    // Compiling includes the validation of the schema against the schema for schemas
+    const auto schema = YAML::Load(record_schema);
+    const auto nodes = count_nodes(schema);
+    benchmarks.push_back(Benchmark{"schema/compile-fresh-validator", [schema](){
+      cerberus::Validator validator;
+      validator.compile(schema);
+      return true;
+    }, nodes});
+    auto validator = std::make_shared<cerberus::Validator>();
+    benchmarks.push_back(Benchmark{"schema/compile", [validator, schema](){
+      validator->compile(schema);
+      return true;
+    }, nodes});
+    benchmarks.push_back(Benchmark{"schema/prepare-cached", [validator, schema](){
+      validator->prepare(schema);
+      return true;
+    }, nodes});
+    return benchmarks;
+  }
+
+  std::vector<Benchmark> documents()
+  {
+    std::vector<Benchmark> benchmarks;
+
+    // Nested dictionaries
+    for(int depth : {8, 64})
+    {
+      std::string schema = "{type: integer}", document = "1";
+      for(int i = 0; i < depth; ++i)
+      {
+        schema = "{type: dict, schema: {value: {type: integer}, child: " + schema + "}}";
+        document = "{value: " + std::to_string(i) + ", child: " + document + "}";
+      }
+      benchmarks.push_back(validation("document/deep-" + std::to_string(depth),
+                                      YAML::Load("root: " + schema), YAML::Load("root: " + document)));
+    }
+
+    // Many fields in a single dictionary
+    for(int width : {16, 1024})
+    {
+      std::ostringstream schema, document;
+      for(int i = 0; i < width; ++i)
+      {
+        schema << "field" << i << ": {type: integer, min: -1}\n";
+        document << "field" << i << ": " << i << "\n";
+      }
+      benchmarks.push_back(validation("document/wide-" + std::to_string(width),
+                                      YAML::Load(schema.str()), YAML::Load(document.str())));
+    }
+
+    // Large lists and mappings
+    const std::size_t count = 10000;
+    std::ostringstream list, items, mapping, records;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+      list << (i ? ", " : "[") << i;
+      mapping << (i ? ", " : "{") << "key" << i << ": " << i;
+      records << "  - {name: user" << i << ", age: " << 1 + i % 100 << ", email: user" << i << "@example.com, "
+              << "roles: [user, guest], address: {street: Main Street, zip: " << i << "}}\n";
+    }
+    list << "]";
+    mapping << "}";
+    for(std::size_t i = 0; i < 1000; ++i)
+      items << (i ? ", " : "[") << "{type: integer, min: -1}";
+    items << "]";
+
+    benchmarks.push_back(validation("list/schema-10000",
+                                    YAML::Load("values: {type: list, schema: {type: integer, min: -1}}"),
+                                    YAML::Load("values: " + list.str())));
+    std::ostringstream short_list;
+    for(std::size_t i = 0; i < 1000; ++i)
+      short_list << (i ? ", " : "[") << i;
+    short_list << "]";
+    benchmarks.push_back(validation("list/items-1000",
+                                    YAML::Load("values: {type: list, items: " + items.str() + "}"),
+                                    YAML::Load("values: " + short_list.str())));
+    benchmarks.push_back(validation("dict/valuesrules-10000",
+                                    YAML::Load("values: {type: dict, valuesrules: {type: integer, min: -1}}"),
+                                    YAML::Load("values: " + mapping.str())));
+    YAML::Node record_list;
+    record_list["users"]["type"] = "list";
+    record_list["users"]["schema"]["type"] = "dict";
+    record_list["users"]["schema"]["schema"] = YAML::Load(record_schema);
+    const auto record_document = YAML::Load("users:\n" + records.str());
+    benchmarks.push_back(validation("list/records-10000", record_list, record_document));
+
+    // The same with a timeline recorded into a trace buffer
+    auto trace = std::make_shared<cerberus::TraceBuffer>();
+    auto traced = std::make_shared<cerberus::Validator>();
+    traced->setTrace(trace.get());
+    auto traced_schema = traced->compile(record_list);
+    benchmarks.push_back(Benchmark{"trace/records-10000", [trace, traced, traced_schema, record_document](){
+      return traced->validate(record_document, traced_schema);
+    }, count_nodes(record_document)});
+    return benchmarks;
+  }
+
+  std::vector<Benchmark> registries()
+  {
+    std::vector<Benchmark> benchmarks;
+
+    // Records whose schema is assembled from registered schemas
+    std::vector<std::pair<std::string, YAML::Node>> registry = {
+      {"address", YAML::Load("street: {type: string}\nzip: {type: integer}")},
+      {"roles", YAML::Load("type: string\nallowed: [admin, user, guest]")},
+      {"user", YAML::Load("name: {type: string, regex: '[a-z]+[0-9]*'}\n"
+                          "age: {type: integer, min: 0, max: 150}\n"
+                          "email: {type: string, regex: '[^@]+@[^@]+'}\n"
+                          "roles: {type: list, schema: roles}\n"
+                          "address: {type: dict, schema: address}\n")},
+    };
+    std::ostringstream records;
+    for(std::size_t i = 0; i < 1000; ++i)
+      records << "  - {name: user" << i << ", age: " << 1 + i % 100 << ", email: user" << i << "@example.com, "
+              << "roles: [user, guest], address: {street: Main Street, zip: " << i << "}}\n";
+    benchmarks.push_back(validation("registry/records-1000",
+                                    YAML::Load("users: {type: list, schema: {type: dict, schema: user}}"),
+                                    YAML::Load("users:\n" + records.str()), registry));
+
+    // A chain of registered schemas that each reference the next one
+    const int length = 32;
+    std::vector<std::pair<std::string, YAML::Node>> chain;
+    std::string document = "1";
+    for(int i = 0; i < length; ++i)
+    {
+      const std::string next = (i + 1 < length) ? "{type: dict, schema: level" + std::to_string(i + 1) + "}" : "{type: integer}";
+      chain.emplace_back("level" + std::to_string(i), YAML::Load("value: {type: integer}\nchild: " + next));
+      document = "{value: " + std::to_string(length - 1 - i) + ", child: " + document + "}";
+    }
+    benchmarks.push_back(validation("registry/chain-32",
+                                    YAML::Load("root: {type: dict, schema: level0}"),
+                                    YAML::Load("root: " + document), chain));
+
+    // Compiling a schema that references many registered schemas
+    auto validator = std::make_shared<cerberus::Validator>();
+    std::ostringstream wide;
+    for(int i = 0; i < 64; ++i)
+    {
+      validator->registerSchema("schema" + std::to_string(i), YAML::Load("value: {type: integer, min: " + std::to_string(i) + "}"));
+      wide << "field" << i << ": {type: dict, schema: schema" << i << "}\n";
+    }
+    const auto schema = YAML::Load(wide.str());
+    benchmarks.push_back(Benchmark{"registry/compile-64", [validator, schema](){
+      validator->compile(schema);
+      return true;
+    }, count_nodes(schema)});
+    return benchmarks;
+  }
+
+  void print_csv(const std::vector<Result>& results)
+  {
+    std::cout << "name,iterations,ns_per_op,allocs_per_op,bytes_allocated_per_op,nodes_per_op,nodes_per_second\n";
+    for(const auto& result : results)
+      std::cout << result.name << "," << result.iterations << "," << result.ns_per_op << ","
+                << result.allocs_per_op << "," << result.bytes_per_op << "," << result.nodes << ","
+                << result.nodes * 1e9 / result.ns_per_op << "\n";
+  }
+
+  void print_json(const std::vector<Result>& results)
+  {
+    std::cout << "{\n  \"benchmarks\": [";
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+      const auto& result = results[i];
+      std::cout << (i ? "," : "") << "\n    {\"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+                << ", \"ns_per_op\": " << result.ns_per_op << ", \"allocs_per_op\": " << result.allocs_per_op
+                << ", \"bytes_allocated_per_op\": " << result.bytes_per_op << ", \"nodes_per_op\": " << result.nodes
+                << ", \"nodes_per_second\": " << result.nodes * 1e9 / result.ns_per_op << "}";
+    }
+    std::cout << "\n  ]\n}\n";
+  }
+
+  int usage(const char* program)
+  {
+    std::cerr << "Usage: " << program << " [--format csv|json] [--filter substring] [--min-time seconds] [--repetitions n]" << std::endl;
+    return 2;
+  }
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+  std::string format = "csv";
+  std::string filter;
+  double min_time = 0.1;
+  int repetitions = 3;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    const bool has_value = i + 1 < argc;
+    if((std::strcmp(argv[i], "--format") == 0) && has_value)
+      format = argv[++i];
+    else if((std::strcmp(argv[i], "--filter") == 0) && has_value)
+      filter = argv[++i];
+    else if((std::strcmp(argv[i], "--min-time") == 0) && has_value)
+      min_time = std::atof(argv[++i]);
+    else if((std::strcmp(argv[i], "--repetitions") == 0) && has_value)
+      repetitions = std::max(std::atoi(argv[++i]), 1);
+    else
+      return usage(argv[0]);
+  }
+  if((format != "csv") && (format != "json"))
+    return usage(argv[0]);
+
+  std::vector<Benchmark> benchmarks;
+  for(auto group : {builtin_rules, schemas, documents, registries})
+    for(auto& benchmark : group())
+      if(benchmark.name.find(filter) != std::string::npos)
+        benchmarks.push_back(std::move(benchmark));
+
+  std::vector<Result> results;
+  for(const auto& benchmark : benchmarks)
+    results.push_back(measure(benchmark, min_time, repetitions));
+
+  std::cout << std::setprecision(6);
+  if(format == "json")
+    print_json(results);
+  else
+    print_csv(results);
+  return 0;
+}
@@ -0,0 +1,45 @@
+# Generate a validator for a schema at build time and make it available to a target
+#
+# cerberus_generate_validator(<target> <schema>
+#                             [NAME <name>]
+#                             [NAMESPACE <namespace>]
+#                             [REGISTRY <registry>...])
+#
+# The header is written to cerberus-codegen/<name>.hh in the current binary directory,
+# which is added to the include directories of the target. NAME defaults to the
+# name of the schema file without extension. The generator is the executable
+# target cerberus-cpp::cerberus-codegen, which is either built in-tree or
+# imported through find_package(cerberus-cpp).
+function(cerberus_generate_validator target schema)
+  if(NOT TARGET cerberus-cpp::cerberus-codegen)
+    message(FATAL_ERROR "cerberus_generate_validator requires the cerberus-cpp::cerberus-codegen target")
+  endif()
+
+  cmake_parse_arguments(GENERATE "" "NAME;NAMESPACE" "REGISTRY" ${ARGN})
+  get_filename_component(schema ${schema} ABSOLUTE)
+  if(NOT GENERATE_NAME)
+    get_filename_component(GENERATE_NAME ${schema} NAME_WE)
+  endif()
+
+  set(arguments --name ${GENERATE_NAME})
+  if(GENERATE_NAMESPACE)
+    list(APPEND arguments --namespace ${GENERATE_NAMESPACE})
+  endif()
+  set(registries)
+  foreach(registry ${GENERATE_REGISTRY})
+    get_filename_component(registry ${registry} ABSOLUTE)
+    list(APPEND arguments --registry ${registry})
+    list(APPEND registries ${registry})
+  endforeach()
+
+  set(output ${CMAKE_CURRENT_BINARY_DIR}/cerberus-codegen/${GENERATE_NAME}.hh)
+  add_custom_command(
+    OUTPUT ${output}
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${CMAKE_CURRENT_BINARY_DIR}/cerberus-codegen
+    COMMAND $<TARGET_FILE:cerberus-cpp::cerberus-codegen> ${arguments} --output ${output} ${schema}
+    DEPENDS cerberus-cpp::cerberus-codegen ${schema} ${registries}
+    COMMENT "Generating validator ${GENERATE_NAME} from ${schema}"
+  )
+  target_sources(${target} PRIVATE ${output})
+  target_include_directories(${target} PRIVATE ${CMAKE_CURRENT_BINARY_DIR}/cerberus-codegen)
+endfunction()
@@ -0,0 +1,6 @@
+include(${CMAKE_CURRENT_LIST_DIR}/cerberus-cpp-targets.cmake)
+
+# The code generation function is only available if the generator was installed
+if(TARGET cerberus-cpp::cerberus-codegen)
+  include(${CMAKE_CURRENT_LIST_DIR}/CerberusCodegen.cmake)
+endif()
@@ -0,0 +1,80 @@
+#include<cerberus-cpp/codegen.hh>
+#include<yaml-cpp/yaml.h>
+
+#include<cstring>
+#include<exception>
+#include<fstream>
+#include<iostream>
+#include<string>
+#include<vector>
+
+// Generates a header with a specialized validator for a schema
+// Usage: cerberus-codegen [--name Name] [--namespace ns] [--registry registry.yml]... [--output file.hh] schema.yml
+//
+// Registry files contain a mapping of names to schemas that are registered
+// before the schema is translated.
+
+static int usage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [--name Name] [--namespace ns] [--registry registry.yml]... [--output file.hh] schema.yml" << std::endl;
+  return 2;
+}
+
+int main(int argc, char** argv)
+{
+  std::string name = "Generated";
+  std::string ns;
+  std::string output;
+  std::string schema;
+  std::vector<std::string> registries;
+
+  for(int i = 1; i < argc; ++i)
+  {
+    const bool has_value = i + 1 < argc;
+    if((std::strcmp(argv[i], "--name") == 0) && has_value)
+      name = argv[++i];
+    else if((std::strcmp(argv[i], "--namespace") == 0) && has_value)
+      ns = argv[++i];
+    else if((std::strcmp(argv[i], "--registry") == 0) && has_value)
+      registries.push_back(argv[++i]);
+    else if((std::strcmp(argv[i], "--output") == 0) && has_value)
+      output = argv[++i];
+    else if((argv[i][0] != '-') && schema.empty())
+      schema = argv[i];
+    else
+      return usage(argv[0]);
+  }
+  if(schema.empty())
+    return usage(argv[0]);
+
+  std::string header;
+  try
+  {
+    cerberus::CodeGenerator generator;
+    for(const auto& registry : registries)
+      for(auto entry : YAML::LoadFile(registry))
+        generator.registerSchema(entry.first.as<std::string>(), entry.second);
+    header = generator.generateHeader(YAML::LoadFile(schema), name, ns);
+  }
+  catch(const std::exception& e)
+  {
+    std::cerr << schema << ": " << e.what() << std::endl;
+    return 1;
+  }
+
+  if(output.empty())
+  {
+    std::cout << header;
+    return 0;
+  }
+
+  // The output is always written, such that build systems see it as up to date
+  std::ofstream file(output, std::ios::binary);
+  file << header;
+  if(!file)
+  {
+    std::cerr << "Could not write " << output << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef CERBERUS_CPP_BATCH_HH
+#define CERBERUS_CPP_BATCH_HH
+
+#include<cerberus-cpp/error.hh>
+#include<cerberus-cpp/threadpool.hh>
+
+#include<yaml-cpp/yaml.h>
+
+#include<cstddef>
+#include<vector>
+
+namespace cerberus {
+
+  //! Options for validating many documents at once with @c Validator::validateBatch and @c Validator::validateStream
+  struct BatchOptions
+  {
+    /** @brief The thread pool to run on
+     *
+     * Pools are expensive to create, so reuse one for repeated batches. If
+     * this is empty, a pool with @ref threads threads is created for the batch.
+     */
+    ThreadPool* pool = nullptr;
+    //! The number of threads of a pool created for the batch (0 for the number of hardware threads)
+    std::size_t threads = 0;
+    /** @brief The number of consecutive documents handed to a thread at once
+     *
+     * The default of 0 picks a chunk size that keeps the overhead low for
+     * small documents while leaving enough chunks for balancing the load.
+     */
+    std::size_t chunk_size = 0;
+    /** @brief The maximum number of documents of a stream held in memory at once
+     *
+     * This includes documents that are parsed but not validated yet and
+     * results that wait for the results of preceding documents. The default
+     * of 0 allows four documents per thread.
+     */
+    std::size_t queue_size = 0;
+  };
+
+  /** @brief The result of validating a single document
+   *
+   * @tparam Document The handle type of the document model
+   */
+  template<typename Document = YAML::Node>
+  struct BasicValidationResult
+  {
+    //! Whether or not the validation process was successful
+    bool success = false;
+    //! Whether validation stopped at the maximum number of errors
+    bool truncated = false;
+    //! The errors found in the document
+    std::vector<ValidationErrorItem> errors;
+    //! The validated and normalized document
+    Document document;
+  };
+
+  //! The result of validating a single YAML document
+  using ValidationResult = BasicValidationResult<>;
+
+} // namespace cerberus
+
+#endif
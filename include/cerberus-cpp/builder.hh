@@ -0,0 +1,184 @@
+#ifndef CERBERUS_CPP_BUILDER_HH
+#define CERBERUS_CPP_BUILDER_HH
+
+#include<yaml-cpp/eventhandler.h>
+#include<yaml-cpp/yaml.h>
+
+#include<string>
+#include<unordered_map>
+#include<utility>
+#include<vector>
+
+namespace cerberus {
+
+  /** @brief Builds YAML nodes from the events of the yaml-cpp parser
+   *
+   * yaml-cpp only loads entire streams at once. Passing an instance of this
+   * class to @c YAML::Parser::HandleNextDocument loads a single document
+   * instead. The events of a part of a document can also be fed to the
+   * builder directly, which is what the @c StreamingValidator does for the
+   * values that it does not stream through.
+   */
+  class NodeBuilder
+    : public YAML::EventHandler
+  {
+    public:
+    //! Whether a mapping or list is currently being built
+    bool building() const
+    {
+      return !stack.empty();
+    }
+
+    /** @brief The node built last
+     *
+     * This is only valid after the outermost node was completed.
+     */
+    YAML::Node node() const
+    {
+      return root;
+    }
+
+    //! Drop all state, including the anchors seen so far
+    void clear()
+    {
+      stack.clear();
+      keys.clear();
+      anchors.clear();
+      root.reset();
+    }
+
+    /** @brief Add a scalar or null node
+     *
+     * @returns Whether this completed the outermost node
+     */
+    bool addLeaf(const YAML::Node& node, YAML::anchor_t anchor)
+    {
+      if(anchor != YAML::NullAnchor)
+        anchors[anchor] = node;
+      return add(node);
+    }
+
+    /** @brief Add a node for an alias
+     *
+     * @returns Whether the anchor was known to the builder
+     */
+    bool addAlias(YAML::anchor_t anchor)
+    {
+      auto anchored = anchors.find(anchor);
+      if(anchored == anchors.end())
+      {
+        add(YAML::Node(YAML::NodeType::Null));
+        return false;
+      }
+      add(anchored->second);
+      return true;
+    }
+
+    //! Start building a mapping or list
+    void startContainer(bool map, const std::string& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style = YAML::EmitterStyle::Default)
+    {
+      YAML::Node node(map ? YAML::NodeType::Map : YAML::NodeType::Sequence);
+      node.SetTag(tag);
+      node.SetStyle(style);
+      if(anchor != YAML::NullAnchor)
+        anchors[anchor] = node;
+      // The container is added before its children, so that they share its memory
+      add(node);
+      stack.push_back(node);
+      keys.emplace_back();
+    }
+
+    /** @brief Finish building a mapping or list
+     *
+     * @returns Whether this completed the outermost node
+     */
+    bool endContainer()
+    {
+      stack.pop_back();
+      keys.pop_back();
+      return stack.empty();
+    }
+
+    void OnDocumentStart(const YAML::Mark&) override
+    {
+      clear();
+    }
+
+    void OnDocumentEnd() override {}
+
+    void OnNull(const YAML::Mark&, YAML::anchor_t anchor) override
+    {
+      addLeaf(YAML::Node(YAML::NodeType::Null), anchor);
+    }
+
+    void OnAlias(const YAML::Mark&, YAML::anchor_t anchor) override
+    {
+      addAlias(anchor);
+    }
+
+    void OnScalar(const YAML::Mark&, const std::string& tag, YAML::anchor_t anchor, const std::string& value) override
+    {
+      YAML::Node node(value);
+      node.SetTag(tag);
+      addLeaf(node, anchor);
+    }
+
+    void OnSequenceStart(const YAML::Mark&, const std::string& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override
+    {
+      startContainer(false, tag, anchor, style);
+    }
+
+    void OnSequenceEnd() override
+    {
+      endContainer();
+    }
+
+    void OnMapStart(const YAML::Mark&, const std::string& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override
+    {
+      startContainer(true, tag, anchor, style);
+    }
+
+    void OnMapEnd() override
+    {
+      endContainer();
+    }
+
+    private:
+    bool add(const YAML::Node& node)
+    {
+      // Note that YAML::Node::reset is needed to rebind, assignment would alter the last node
+      if(stack.empty())
+      {
+        root.reset(node);
+        return true;
+      }
+
+      auto& parent = stack.back();
+      auto& key = keys.back();
+      if(parent.IsSequence())
+        parent.push_back(node);
+      else if(!key.first)
+      {
+        key.first = true;
+        key.second.reset(node);
+      }
+      else
+      {
+        // yaml-cpp does not reject duplicate keys. Like YAML::Load, this keeps all of
+        // them in document order, so keys of built mappings are not necessarily unique
+        parent.force_insert(key.second, node);
+        key.first = false;
+      }
+      return false;
+    }
+
+    std::vector<YAML::Node> stack;
+    // The pending key of each mapping on the stack
+    std::vector<std::pair<bool, YAML::Node>> keys;
+    std::unordered_map<YAML::anchor_t, YAML::Node> anchors;
+    YAML::Node root;
+  };
+
+} // namespace cerberus
+
+#endif
@@ -0,0 +1,799 @@
+#ifndef CERBERUS_CPP_CODEGEN_HH
+#define CERBERUS_CPP_CODEGEN_HH
+
+#include<cerberus-cpp/error.hh>
+#include<cerberus-cpp/stack.hh>
+#include<cerberus-cpp/validator.hh>
+
+#include<yaml-cpp/yaml.h>
+
+#include<cctype>
+#include<cmath>
+#include<cstddef>
+#include<deque>
+#include<iomanip>
+#include<limits>
+#include<map>
+#include<sstream>
+#include<string>
+#include<utility>
+#include<vector>
+
+namespace cerberus {
+
+  /** @brief Translates schemas into C++ code of specialized validators
+   *
+   * The schema is compiled with a @c Validator first, such that it is checked
+   * by the same rules and resolved exactly like the interpreting validator
+   * would resolve it. The compiled schema is then translated into one function
+   * per schema item and dictionary schema. These apply the built-in rules in
+   * order of their priority as straight-line code, with types, constants and
+   * allowed values resolved at generation time. The generated validators
+   * behave like a @c BasicValidator in @c ValidationMode::READ_ONLY and use the
+   * support code in @c cerberus-cpp/generated.hh. This is what the
+   * @c cerberus-codegen tool runs.
+   */
+  class CodeGenerator
+  {
+    public:
+    /** @brief Register a schema to reference within larger schema
+     *
+     * @param name The name for the registered schema
+     * @param schema The YAML::Node that represents the schema
+     */
+    void registerSchema(const std::string& name, const YAML::Node& schema)
+    {
+      validator.registerSchema(name, schema);
+    }
+
+    /** @brief Generate the code of a validator for a schema
+     *
+     * This defines a class @c <name>Schema that implements the schema and
+     * an alias @c <name> for the validator class that users interact with.
+     *
+     * @param schema The schema
+     * @param name The name of the generated validator class
+     * @throws SchemaError if the given schema is not valid
+     * @throws CodegenError if the schema cannot be translated
+     */
+    std::string generate(const YAML::Node& schema, const std::string& name)
+    {
+      auto compiled = validator.compile(schema);
+
+      items.clear();
+      dicts.clear();
+      pending_items.clear();
+      pending_dicts.clear();
+
+      std::ostringstream functions;
+      const std::string root = dictFunction(&compiled.root());
+      while(!pending_items.empty() || !pending_dicts.empty())
+      {
+        if(!pending_dicts.empty())
+        {
+          auto dict = pending_dicts.front();
+          pending_dicts.pop_front();
+          generateDict(functions, *dict.first, dict.second);
+        }
+        else
+        {
+          auto item = pending_items.front();
+          pending_items.pop_front();
+          generateItem(functions, *item.first, item.second);
+        }
+      }
+
+      std::ostringstream code;
+      code << "struct " << name << "Schema\n"
+           << "{\n"
+           << "  template<typename Document>\n"
+           << "  static void validate(cerberus::generated::Context<Document>& c, const cerberus::generated::Frame<Document>& f)\n"
+           << "  {\n"
+           << "    " << root << "(c, f);\n"
+           << "  }\n"
+           << functions.str()
+           << "};\n"
+           << "\n"
+           << "using " << name << " = cerberus::generated::Validator<" << name << "Schema>;\n";
+      return code.str();
+    }
+
+    /** @brief Generate a self-contained header with a validator for a schema
+     *
+     * @param schema The schema
+     * @param name The name of the generated validator class
+     * @param ns The namespace of the generated code, e.g. @c app::schemas (may be empty)
+     * @throws SchemaError if the given schema is not valid
+     * @throws CodegenError if the schema cannot be translated
+     */
+    std::string generateHeader(const YAML::Node& schema, const std::string& name, const std::string& ns = "")
+    {
+      std::string guard = "CERBERUS_GENERATED_";
+      for(char c : ns + "_" + name)
+        guard += std::isalnum(static_cast<unsigned char>(c)) ? static_cast<char>(std::toupper(static_cast<unsigned char>(c))) : '_';
+      guard += "_HH";
+
+      std::vector<std::string> namespaces;
+      for(std::size_t pos = 0; pos < ns.size();)
+      {
+        auto end = ns.find("::", pos);
+        if(end == std::string::npos)
+          end = ns.size();
+        namespaces.push_back(ns.substr(pos, end - pos));
+        pos = end + 2;
+      }
+
+      std::ostringstream header;
+      header << "// This file was generated by cerberus-codegen, do not edit\n"
+             << "#ifndef " << guard << "\n"
+             << "#define " << guard << "\n"
+             << "\n"
+             << "#include<cerberus-cpp/generated.hh>\n"
+             << "\n"
+             << "#include<cstddef>\n"
+             << "#include<regex>\n"
+             << "#include<string>\n"
+             << "#include<vector>\n"
+             << "\n";
+      for(const auto& n : namespaces)
+        header << "namespace " << n << " {\n\n";
+      header << generate(schema, name);
+      for(auto it = namespaces.rbegin(); it != namespaces.rend(); ++it)
+        header << "\n} // namespace " << *it << "\n";
+      header << "\n#endif\n";
+      return header.str();
+    }
+
+    private:
+    using CompiledSchema = Validator::CompiledSchema;
+    using CompiledItem = CompiledSchema::Item;
+    using CompiledDict = CompiledSchema::Dict;
+    using CompiledRule = CompiledSchema::Rule;
+
+    //! The built-in types, which are the only ones the generator knows how to decode
+    enum class Type { UNKNOWN, INTEGER, STRING, FLOAT, BOOLEAN };
+
+    static Type builtinType(const std::string& name)
+    {
+      if(name == "integer")
+        return Type::INTEGER;
+      if(name == "string")
+        return Type::STRING;
+      if((name == "float") || (name == "number"))
+        return Type::FLOAT;
+      if(name == "boolean")
+        return Type::BOOLEAN;
+      return Type::UNKNOWN;
+    }
+
+    static const char* cppType(Type type)
+    {
+      switch(type)
+      {
+        case Type::INTEGER: return "long long";
+        case Type::STRING: return "std::string";
+        case Type::FLOAT: return "long double";
+        case Type::BOOLEAN: return "bool";
+        default: return "";
+      }
+    }
+
+    //! Render the arguments of a string literal and its length, which may contain any character
+    static std::string literal(const std::string& value)
+    {
+      std::ostringstream out;
+      out << '"';
+      for(unsigned char c : value)
+      {
+        if((c == '"') || (c == '\\'))
+          out << '\\' << c;
+        else if((c >= 0x20) && (c < 0x7f) && (c != '?'))
+          out << c;
+        else
+          out << '\\' << std::oct << std::setw(3) << std::setfill('0') << static_cast<int>(c) << std::dec;
+      }
+      out << "\", " << value.size();
+      return out.str();
+    }
+
+    static std::string integerLiteral(long long value)
+    {
+      if(value == std::numeric_limits<long long>::min())
+        return "(-" + std::to_string(std::numeric_limits<long long>::max()) + "LL - 1)";
+      return std::to_string(value) + "LL";
+    }
+
+    static std::string floatLiteral(long double value)
+    {
+      if(std::isnan(value))
+        return "std::numeric_limits<long double>::quiet_NaN()";
+      if(std::isinf(value))
+        return std::string(value < 0 ? "-" : "") + "std::numeric_limits<long double>::infinity()";
+      std::ostringstream out;
+      out << std::scientific << std::setprecision(std::numeric_limits<long double>::max_digits10) << value << 'L';
+      return out.str();
+    }
+
+    //! Decode a schema value with a built-in type and render it as a C++ expression
+    static bool valueLiteral(Type type, const YAML::Node& node, std::string& result, long double& number)
+    {
+      switch(type)
+      {
+        case Type::INTEGER:
+        {
+          long long value;
+          if(!YAML::convert<long long>::decode(node, value))
+            return false;
+          number = static_cast<long double>(value);
+          result = integerLiteral(value);
+          return true;
+        }
+        case Type::STRING:
+        {
+          std::string value;
+          if(!YAML::convert<std::string>::decode(node, value))
+            return false;
+          result = value;
+          return true;
+        }
+        case Type::FLOAT:
+        {
+          long double value;
+          if(!YAML::convert<long double>::decode(node, value))
+            return false;
+          number = value;
+          result = floatLiteral(value);
+          return true;
+        }
+        case Type::BOOLEAN:
+        {
+          bool value;
+          if(!YAML::convert<bool>::decode(node, value))
+            return false;
+          number = value ? 1 : 0;
+          result = value ? "true" : "false";
+          return true;
+        }
+        default:
+          return false;
+      }
+    }
+
+    static std::string str(const std::string& value)
+    {
+      return "std::string(" + literal(value) + ")";
+    }
+
+    //! The type of the item that a rule belongs to, as used by e.g. the allowed rule
+    static Type itemType(const CompiledItem& item, const std::string& rule)
+    {
+      const YAML::Node schema = item.schema;
+      const YAML::Node type = schema.IsMap() ? schema["type"] : YAML::Node();
+      if(type && type.IsScalar() && (builtinType(type.Scalar()) != Type::UNKNOWN))
+        return builtinType(type.Scalar());
+      throw CodegenError("The " + rule + " rule requires a built-in scalar type in the same schema");
+    }
+
+    template<typename T>
+    static const T& prepared(const CompiledRule& rule)
+    {
+      return static_cast<const PreparedArgument<T>&>(*rule.prepared).value;
+    }
+
+    std::string itemFunction(const CompiledItem* item)
+    {
+      auto it = items.find(item);
+      if(it != items.end())
+        return it->second;
+      const std::string name = "item_" + std::to_string(items.size());
+      items[item] = name;
+      pending_items.emplace_back(item, name);
+      return name;
+    }
+
+    std::string dictFunction(const CompiledDict* dict)
+    {
+      auto it = dicts.find(dict);
+      if(it != dicts.end())
+        return it->second;
+      const std::string name = "dict_" + std::to_string(dicts.size());
+      dicts[dict] = name;
+      pending_dicts.emplace_back(dict, name);
+      return name;
+    }
+
+    static void functionHeader(std::ostream& out, const std::string& name)
+    {
+      out << "\n"
+          << "  template<typename Document>\n"
+          << "  static void " << name << "(cerberus::generated::Context<Document>& c, const cerberus::generated::Frame<Document>& f)\n"
+          << "  {\n"
+          << "    const Document& doc = f.document;\n";
+    }
+
+    void generateDict(std::ostream& out, const CompiledDict& dict, const std::string& name)
+    {
+      functionHeader(out, name);
+      for(const auto& field : dict.fields)
+      {
+        out << "    {\n"
+            << "      static const std::string key(" << literal(field.first) << ");\n"
+            << "      const cerberus::generated::Frame<Document> field(f, key.data(), key.size(), cerberus::document::lookup(doc, key));\n"
+            << "      " << itemFunction(field.second) << "(c, field);\n"
+            << "    }\n";
+      }
+
+      // Keys are known if they are fields of the schema, renaming does not happen without normalization
+      out << "    if(!c.allow_unknown)\n"
+          << "    {\n"
+          << "      cerberus::document::for_each_item(doc, [&c, &f](const Document& key, const Document&)\n"
+          << "      {\n"
+          << "        if((!cerberus::document::is_scalar(key)) || (!" << name << "_known(cerberus::document::scalar(key))))\n"
+          << "          c.raiseError(f, \"Unknown item found in validator that does not accept unknown items: \" + cerberus::document::to_yaml(key).template as<std::string>());\n"
+          << "      });\n"
+          << "    }\n"
+          << "  }\n";
+
+      std::map<std::size_t, std::vector<std::string>> keys;
+      for(const auto& field : dict.fields)
+        keys[field.first.size()].push_back(field.first);
+      out << "\n"
+          << "  static bool " << name << "_known(const std::string& key)\n"
+          << "  {\n"
+          << "    switch(key.size())\n"
+          << "    {\n";
+      for(const auto& length : keys)
+      {
+        out << "      case " << length.first << ":\n"
+            << "        return ";
+        for(std::size_t i = 0; i < length.second.size(); ++i)
+          out << (i > 0 ? " ||\n               " : "") << "cerberus::generated::equals(key, " << literal(length.second[i]) << ")";
+        out << ";\n";
+      }
+      out << "      default:\n"
+          << "        return false;\n"
+          << "    }\n"
+          << "  }\n";
+    }
+
+    void generateItem(std::ostream& out, const CompiledItem& item, const std::string& name)
+    {
+      functionHeader(out, name);
+      regexes = 0;
+
+      const auto first = static_cast<std::size_t>(RulePriority::FIRST);
+      const auto normalization = static_cast<std::size_t>(RulePriority::NORMALIZATION);
+      const auto post_normalization = static_cast<std::size_t>(RulePriority::POST_NORMALIZATION);
+      const auto validation = static_cast<std::size_t>(RulePriority::VALIDATION);
+      const auto typechecking = static_cast<std::size_t>(RulePriority::TYPECHECKING);
+      const auto last = static_cast<std::size_t>(RulePriority::LAST);
+
+      // The policies are overridden before and restored after all other rules
+      for(const auto& rule : item.rules[first])
+      {
+        if(rule.name == "allow_unknown")
+          out << "    const bool saved_allow_unknown = c.allow_unknown;\n"
+              << "    c.allow_unknown = " << (rule.argument.as<bool>() ? "true" : "false") << ";\n";
+        else if(rule.name == "require_all")
+          out << "    const bool saved_require_all = c.require_all;\n"
+              << "    c.require_all = " << (rule.argument.as<bool>() ? "true" : "false") << ";\n";
+        else if(rule.name == "purge_unknown")
+        {
+          if(rule.argument.as<bool>())
+            throw CodegenError("The normalization rule purge_unknown cannot be translated to C++");
+        }
+        else
+          unsupported(rule);
+      }
+
+      // Generated validators do not normalize, so normalization rules would silently be ignored
+      for(const auto priority : {normalization, post_normalization})
+        if(!item.rules[priority].empty())
+          throw CodegenError("The normalization rule " + item.rules[priority].front().name + " cannot be translated to C++");
+
+      // The require all policy replaces the required rule
+      const bool require_all = !item.require_all.empty() && (item.require_all_priority == validation);
+
+      const auto& rules = item.rules[validation];
+      for(std::size_t i = 0; i < rules.size(); ++i)
+      {
+        if(require_all && (static_cast<int>(i) == item.required_index))
+          generateRequired(out, rules[i].argument.as<bool>() ? "true" : "c.require_all");
+        else
+          generateRule(out, item, rules[i]);
+      }
+      if(require_all && (item.required_index < 0))
+        generateRequired(out, "c.require_all");
+
+      for(const auto& rule : item.rules[typechecking])
+        generateRule(out, item, rule);
+
+      for(const auto& rule : item.rules[last])
+      {
+        if(rule.name == "allow_unknown")
+          out << "    c.allow_unknown = saved_allow_unknown;\n";
+        else if(rule.name == "require_all")
+          out << "    c.require_all = saved_require_all;\n";
+        else if(rule.name != "purge_unknown")
+          unsupported(rule);
+      }
+      out << "  }\n";
+    }
+
+    [[noreturn]] static void unsupported(const CompiledRule& rule)
+    {
+      throw CodegenError("The rule " + rule.name + " cannot be translated to C++");
+    }
+
+    //! The policy only changes in rules of FIRST and LAST priority, so it can be read when applying the rule
+    static void generateRequired(std::ostream& out, const std::string& condition)
+    {
+      out << "    // required\n";
+      if(condition == "false")
+        return;
+      out << "    if(" << (condition == "true" ? "" : "(" + condition + ") && ") << "(!cerberus::document::is_defined(doc)))\n"
+          << "      c.raiseError(f, \"Required-Rule violated!\");\n";
+    }
+
+    static void generatePathLookup(std::ostream& out, const DocumentPath& path)
+    {
+      out << "cerberus::generated::lookup_path(f, 1, " << (path.isAbsolute() ? "true" : "false") << ", {";
+      bool separator = false;
+      for(const auto& token : path.getTokens())
+      {
+        out << (separator ? ", " : "") << "{" << (token.is_index ? "true" : "false") << ", \"";
+        for(unsigned char c : token.key)
+        {
+          if((c == '"') || (c == '\\'))
+            out << '\\' << c;
+          else if((c >= 0x20) && (c < 0x7f) && (c != '?'))
+            out << c;
+          else
+            out << '\\' << std::oct << std::setw(3) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        }
+        out << "\", " << token.index << "}";
+        separator = true;
+      }
+      out << "})";
+    }
+
+    //! Generate the lookup of a value in the argument of the allowed or forbidden rule
+    static void generateValueSet(std::ostream& out, const CompiledItem& item, const CompiledRule& rule)
+    {
+      // Only the forbidden rule reports which value was found
+      auto found = [&rule](const std::string& indent, const std::string& value)
+      {
+        if(rule.name == "forbidden")
+          return indent + "c.raiseError(f, \"Forbidden-Rule violated: \" + " + str(value) + ");\n";
+        return std::string();
+      };
+
+      const Type type = itemType(item, rule.name);
+      const YAML::Node argument = rule.argument;
+
+      // The first occurence of equal values wins, just like in the value sets of types
+      std::vector<std::pair<std::string, std::string>> values;
+      std::vector<long double> numbers;
+      for(const auto& node : impl::as_list(argument))
+      {
+        std::string value;
+        long double number = 0;
+        if(!valueLiteral(type, node, value, number))
+          continue;
+        bool duplicate = false;
+        for(std::size_t i = 0; i < values.size(); ++i)
+          if(((type == Type::STRING) || (type == Type::INTEGER)) ? (values[i].first == value) : (numbers[i] == number))
+            duplicate = true;
+        // Not a number is never found
+        if(duplicate || (number != number))
+          continue;
+        values.emplace_back(value, node.as<std::string>());
+        numbers.push_back(number);
+      }
+
+      out << "    {\n"
+          << "      " << cppType(type) << " value;\n"
+          << "      bool found = false;\n"
+          << "      if(cerberus::generated::decode(doc, value))\n"
+          << "      {\n";
+      if(type == Type::INTEGER)
+      {
+        out << "        switch(value)\n"
+            << "        {\n";
+        for(const auto& value : values)
+          out << "          case " << value.first << ":\n"
+              << "            found = true;\n"
+              << found("            ", value.second)
+              << "            break;\n";
+        out << "          default:\n"
+            << "            break;\n"
+            << "        }\n";
+      }
+      else if(type == Type::STRING)
+      {
+        std::map<std::size_t, std::vector<std::pair<std::string, std::string>>> lengths;
+        for(const auto& value : values)
+          lengths[value.first.size()].push_back(value);
+        out << "        switch(value.size())\n"
+            << "        {\n";
+        for(const auto& length : lengths)
+        {
+          out << "          case " << length.first << ":\n";
+          for(std::size_t i = 0; i < length.second.size(); ++i)
+            out << "            " << (i > 0 ? "else if" : "if") << "(cerberus::generated::equals(value, " << literal(length.second[i].first) << "))\n"
+                << "            {\n"
+                << "              found = true;\n"
+                << found("              ", length.second[i].second)
+                << "            }\n";
+          out << "            break;\n";
+        }
+        out << "          default:\n"
+            << "            break;\n"
+            << "        }\n";
+      }
+      else
+      {
+        for(std::size_t i = 0; i < values.size(); ++i)
+          out << "        " << (i > 0 ? "else if" : "if") << "(value == " << values[i].first << ")\n"
+              << "        {\n"
+              << "          found = true;\n"
+              << found("          ", values[i].second)
+              << "        }\n";
+      }
+      out << "      }\n";
+    }
+
+    void generateRule(std::ostream& out, const CompiledItem& item, const CompiledRule& rule)
+    {
+      out << "    // " << rule.name << "\n";
+      const YAML::Node argument = rule.argument;
+
+      if(rule.name == "allowed")
+      {
+        generateValueSet(out, item, rule);
+        out << "      if(!found)\n"
+            << "        c.raiseError(f, \"Value disallowed by Allowed-Rule!\");\n"
+            << "    }\n";
+      }
+      else if(rule.name == "contains")
+      {
+        std::vector<std::string> needed;
+        for(const auto& node : impl::as_list(argument))
+        {
+          std::string value;
+          YAML::convert<std::string>::decode(node, value);
+          needed.push_back(value);
+        }
+        if(needed.empty())
+          return;
+        out << "    {\n"
+            << "      bool needed[] = {";
+        for(std::size_t i = 0; i < needed.size(); ++i)
+          out << (i > 0 ? ", " : "") << "true";
+        out << "};\n"
+            << "      cerberus::document::for_each_element(doc, [&needed](const Document& element)\n"
+            << "      {\n"
+            << "        const std::string value = cerberus::generated::as_string(element);\n";
+        for(std::size_t i = 0; i < needed.size(); ++i)
+          out << "        if(cerberus::generated::equals(value, " << literal(needed[i]) << "))\n"
+              << "          needed[" << i << "] = false;\n";
+        out << "      });\n"
+            << "      if(";
+        for(std::size_t i = 0; i < needed.size(); ++i)
+          out << (i > 0 ? " || " : "") << "needed[" << i << "]";
+        out << ")\n"
+            << "        c.raiseError(f, \"Contains-Rule violated\");\n"
+            << "    }\n";
+      }
+      else if(rule.name == "dependencies")
+      {
+        const auto& deps = prepared<impl::DependenciesRuleArgument>(rule);
+        out << "    if(cerberus::document::is_defined(doc))\n"
+            << "    {\n";
+        for(std::size_t i = 0; i < deps.paths.size(); ++i)
+        {
+          const auto& path = deps.paths[i];
+          out << "      {\n"
+              << "        const Document dependency = ";
+          generatePathLookup(out, path);
+          out << ";\n"
+              << "        if(!cerberus::document::is_defined(dependency))\n"
+              << "          c.raiseError(f, " << str("dependencies-Rule violated: " + path.str() + " required!") << ");\n";
+          if(deps.mapping)
+          {
+            std::string condition, options;
+            for(const auto& value : deps.values[i])
+            {
+              std::string decoded;
+              YAML::convert<std::string>::decode(value, decoded);
+              condition += (condition.empty() ? "" : " || ") + std::string("cerberus::generated::equals(value, ") + literal(decoded) + ")";
+              options += value.as<std::string>() + ", ";
+            }
+            out << "        const std::string value = cerberus::generated::as_string(dependency);\n"
+                << "        if(!(" << (condition.empty() ? "false" : condition) << "))\n"
+                << "          c.raiseError(f, " << str("dependencies-Rule violated: " + path.str() + " requires value out of [" + options + "]") << ");\n";
+          }
+          out << "      }\n";
+        }
+        out << "    }\n";
+      }
+      else if(rule.name == "empty")
+      {
+        if(!argument.as<bool>())
+          out << "    if(cerberus::document::is_sequence(doc) && (cerberus::document::size(doc) == 0))\n"
+              << "      c.raiseError(f, \"Empty-Rule violated for sequence\");\n";
+      }
+      else if(rule.name == "excludes")
+      {
+        const auto& excludes = prepared<std::vector<DocumentPath>>(rule);
+        out << "    if(cerberus::document::is_defined(doc))\n"
+            << "    {\n";
+        for(const auto& path : excludes)
+        {
+          out << "      if(cerberus::document::is_defined(";
+          generatePathLookup(out, path);
+          out << "))\n"
+              << "        c.raiseError(f, " << str("excludes-Rule violated: " + path.str() + " is not allowed!") << ");\n";
+        }
+        out << "    }\n";
+      }
+      else if(rule.name == "forbidden")
+      {
+        generateValueSet(out, item, rule);
+        out << "      static_cast<void>(found);\n"
+            << "    }\n";
+      }
+      else if(rule.name == "items")
+      {
+        const auto& subschemas = prepared<CompiledSchema::Subschemas>(rule);
+        for(std::size_t i = 0; i < subschemas.items.size(); ++i)
+          out << "    {\n"
+              << "      const cerberus::generated::Frame<Document> element(f, " << i << ", cerberus::document::element(doc, " << i << "));\n"
+              << "      " << itemFunction(subschemas.items[i]) << "(c, element);\n"
+              << "    }\n";
+      }
+      else if(rule.name == "keysrules")
+      {
+        const auto& subschemas = prepared<CompiledSchema::Subschemas>(rule);
+        out << "    cerberus::document::for_each_item(doc, [&c, &f](const Document& key, const Document&)\n"
+            << "    {\n"
+            << "      const cerberus::generated::Frame<Document> detached(f, key);\n"
+            << "      " << itemFunction(subschemas.items.front()) << "(c, detached);\n"
+            << "    });\n";
+      }
+      else if((rule.name == "max") || (rule.name == "min"))
+      {
+        const Type type = itemType(item, rule.name);
+        std::string constant;
+        long double number;
+        if(!valueLiteral(type, argument, constant, number))
+          throw CodegenError("The argument of the " + rule.name + " rule cannot be decoded with its type");
+        out << "    if(cerberus::document::is_defined(doc))\n"
+            << "    {\n";
+        if(type == Type::STRING)
+        {
+          out << "      static const std::string constant(" << literal(constant) << ");\n";
+          constant = "constant";
+        }
+        out << "      " << cppType(type) << " value;\n"
+            << "      const bool decoded = cerberus::generated::decode(doc, value);\n";
+        // Like the comparison of a type with a constant, values that are not ordered (e.g. NaN) are neither greater nor equal
+        if(rule.name == "max")
+          out << "      if(decoded && (!(value < " << constant << ")) && ((" << constant << " < value) || (value == " << constant << ")))\n"
+              << "        c.raiseError(f, \"Max-Rrule violated!\");\n";
+        else
+          out << "      if(!(decoded && (" << constant << " < value)))\n"
+              << "        c.raiseError(f, \"Min-Rule violated!\");\n";
+        out << "    }\n";
+      }
+      else if((rule.name == "maxlength") || (rule.name == "minlength"))
+      {
+        out << "    if(cerberus::document::size(doc) " << (rule.name == "maxlength" ? ">" : "<")
+            << " static_cast<std::size_t>(" << argument.as<std::size_t>() << "))\n"
+            << "      c.raiseError(f, \"" << (rule.name == "maxlength" ? "Maxlength" : "Minlength") << "-Rule violated!\");\n";
+      }
+      else if(rule.name == "meta")
+      {}
+      else if(rule.name == "nullable")
+      {
+        if(!argument.as<bool>())
+          out << "    if(cerberus::document::is_null(doc))\n"
+              << "      c.raiseError(f, \"Nullable-Rule violated!\");\n";
+      }
+      else if(rule.name == "regex")
+      {
+        const std::string regex = "regex_" + std::to_string(regexes++);
+        out << "    static const std::regex " << regex << "(" << str(argument.as<std::string>()) << ");\n"
+            << "    if(!std::regex_match(cerberus::document::to_yaml(doc).template as<std::string>(), " << regex << "))\n"
+            << "      c.raiseError(f, \"Regex-Rule violated!\");\n";
+      }
+      else if(rule.name == "required")
+        generateRequired(out, argument.as<bool>() ? "true" : "false");
+      else if(rule.name == "schema")
+      {
+        const auto& subschemas = prepared<CompiledSchema::Subschemas>(rule);
+        auto dict = [this, &subschemas](const std::string& indent)
+        {
+          return indent + dictFunction(subschemas.dict) + "(c, f);\n";
+        };
+        auto list = [this, &subschemas](const std::string& indent)
+        {
+          return indent + "for(std::size_t i = 0, size = cerberus::document::size(doc); i < size; ++i)\n" +
+                 indent + "{\n" +
+                 indent + "  const cerberus::generated::Frame<Document> element(f, i, cerberus::document::element(doc, i));\n" +
+                 indent + "  " + itemFunction(subschemas.items.front()) + "(c, element);\n" +
+                 indent + "}\n";
+        };
+        if(subschemas.dict && subschemas.items.empty())
+          out << dict("    ");
+        else if(!subschemas.dict && !subschemas.items.empty())
+          out << list("    ");
+        else if(subschemas.dict)
+          out << "    if(cerberus::document::is_map(doc))\n"
+              << "    {\n"
+              << dict("      ")
+              << "    }\n"
+              << "    else if(cerberus::document::is_sequence(doc))\n"
+              << "    {\n"
+              << list("      ")
+              << "    }\n"
+              << "    else\n"
+              << "      c.raiseError(f, \"Schema-Rule is only available for type=dict|list\");\n";
+        else
+          out << "    c.raiseError(f, \"Schema-Rule is only available for type=dict|list\");\n";
+      }
+      else if(rule.name == "type")
+      {
+        bool list = false, dict = false;
+        std::vector<Type> types;
+        for(const auto& node : impl::as_list(argument))
+        {
+          const auto name = node.as<std::string>();
+          if(name == "list")
+            list = true;
+          else if(name == "dict")
+            dict = true;
+          else if(builtinType(name) != Type::UNKNOWN)
+            types.push_back(builtinType(name));
+        }
+        out << "    if(cerberus::document::is_defined(doc) && (!cerberus::document::is_null(doc))";
+        if(list)
+          out << " &&\n       (!cerberus::document::is_sequence(doc))";
+        if(dict)
+          out << " &&\n       (!cerberus::document::is_map(doc))";
+        for(auto type : types)
+          out << " &&\n       (!cerberus::generated::is_convertible<" << cppType(type) << ">(doc))";
+        out << ")\n"
+            << "      c.raiseError(f, \"Type-Rule violated\");\n";
+      }
+      else if(rule.name == "valuesrules")
+      {
+        const auto& subschemas = prepared<CompiledSchema::Subschemas>(rule);
+        out << "    {\n"
+            << "      std::vector<std::string> keys;\n"
+            << "      cerberus::document::for_each_item(doc, [&keys](const Document& key, const Document&)\n"
+            << "      {\n"
+            << "        keys.push_back(cerberus::document::to_yaml(key).template as<std::string>());\n"
+            << "      });\n"
+            << "      for(const auto& key : keys)\n"
+            << "      {\n"
+            << "        const cerberus::generated::Frame<Document> value(f, key.data(), key.size(), cerberus::document::lookup(doc, key));\n"
+            << "        " << itemFunction(subschemas.items.front()) << "(c, value);\n"
+            << "      }\n"
+            << "    }\n";
+      }
+      else
+        unsupported(rule);
+    }
+
+    Validator validator;
+    std::map<const CompiledItem*, std::string> items;
+    std::map<const CompiledDict*, std::string> dicts;
+    std::deque<std::pair<const CompiledItem*, std::string>> pending_items;
+    std::deque<std::pair<const CompiledDict*, std::string>> pending_dicts;
+    std::size_t regexes = 0;
+  };
+
+} // namespace cerberus
+
+#endif
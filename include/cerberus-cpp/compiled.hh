@@ -0,0 +1,180 @@
+#ifndef CERBERUS_CPP_COMPILED_HH
+#define CERBERUS_CPP_COMPILED_HH
+
+#include<cerberus-cpp/rules.hh>
+#include<cerberus-cpp/types.hh>
+
+#include<yaml-cpp/yaml.h>
+
+#include<array>
+#include<deque>
+#include<memory>
+#include<string>
+#include<unordered_set>
+#include<utility>
+#include<vector>
+
+namespace cerberus {
+
+  /** @brief Abstract base class for rule arguments that were decoded at compile time
+   *
+   * Rules may register a preparation function alongside their implementation.
+   * Its result is stored with the compiled schema and can be accessed from the
+   * rule implementation without decoding the schema again.
+   */
+  struct PreparedArgumentBase
+  {
+    virtual ~PreparedArgumentBase() = default;
+  };
+
+  /** @brief An implementation of the @c PreparedArgumentBase interface that wraps a value
+   *
+   * @tparam T The C++ type of the decoded argument
+   */
+  template<typename T>
+  struct PreparedArgument
+    : PreparedArgumentBase
+  {
+    explicit PreparedArgument(T value)
+      : value(std::move(value))
+    {}
+
+    T value;
+  };
+
+  //! The number of different values in the @c RulePriority enumeration
+  constexpr std::size_t RulePriorityCount = 6;
+
+  /** @brief An immutable, pre-interpreted representation of a schema
+   *
+   * A compiled schema stores, for each schema item, the rule implementations
+   * that apply to it bucketed by @c RulePriority together with their already
+   * decoded arguments. Validating against a compiled schema does not require
+   * any rule name lookups. Instances are cheap to copy, as all copies share
+   * the same immutable storage. Compiled schemas are produced by the @c compile
+   * method of the @c Validator class and should only be used with the validator
+   * instance that produced them.
+   *
+   * @tparam RuleFunction The type of the callables that implement rules
+   */
+  template<typename RuleFunction>
+  class CompiledSchema
+  {
+    public:
+    //! A rule that was resolved for a given schema item
+    struct Rule
+    {
+      //! The name of the rule
+      std::string name;
+      //! The implementation of the rule
+      RuleFunction function;
+      //! The schema snippet that is the argument of this rule
+      YAML::Node argument;
+      //! The argument as decoded by the rule's preparation function (may be empty)
+      std::shared_ptr<const PreparedArgumentBase> prepared;
+      //! Whether this is a custom rule that may alter the document outside of normalization
+      bool custom = false;
+    };
+
+    //! A schema item, i.e. the set of rules that apply to a field
+    struct Item
+    {
+      //! The schema snippet that this item was compiled from
+      YAML::Node schema;
+      //! The location of the item in the schema, e.g. @c ^users.schema.name, or the name of a registered schema
+      std::string path;
+      //! The type implementation as given by a scalar @c type rule (may be empty)
+      std::shared_ptr<TypeItemBase> type;
+      //! The resolved rules bucketed by priority in the order of the schema
+      std::array<std::vector<Rule>, RulePriorityCount> rules;
+      //! The @c required rule applied under the require all policy (if registered)
+      std::vector<Rule> require_all;
+      //! The priority bucket of the @c required rule
+      std::size_t require_all_priority = 0;
+      //! The index of the @c required rule within its bucket (or -1)
+      int required_index = -1;
+    };
+
+    //! A dictionary schema, i.e. a mapping of field names to items
+    struct Dict
+    {
+      //! The schema snippet that this dictionary was compiled from
+      YAML::Node schema;
+      //! The fields of the dictionary in the order of the schema
+      std::vector<std::pair<std::string, const Item*>> fields;
+      //! The field names for constant time lookup of unknown keys
+      std::unordered_set<std::string> keys;
+    };
+
+    /** @brief The compiled subschemas of a rule like e.g. @c schema or @c items
+     *
+     * This is a convenience type to be returned from the preparation
+     * callables of rules that recursively validate subdocuments.
+     */
+    struct Subschemas
+    {
+      //! The argument compiled as a dictionary schema (if applicable)
+      const Dict* dict = nullptr;
+      //! The argument compiled as schema items (if applicable)
+      std::vector<const Item*> items;
+    };
+
+    //! The storage shared by all copies of a compiled schema
+    struct Storage
+    {
+      // Deques are used because they guarantee stable addresses of their elements
+      std::deque<Item> items;
+      std::deque<Dict> dicts;
+      const Dict* root = nullptr;
+      bool normalizing = false;
+      bool custom = false;
+    };
+
+    //! Default construct an empty compiled schema
+    CompiledSchema() = default;
+
+    //! Construct a compiled schema from the given storage
+    explicit CompiledSchema(std::shared_ptr<const Storage> storage)
+      : storage(std::move(storage))
+    {}
+
+    //! Whether this instance holds a compiled schema
+    explicit operator bool() const
+    {
+      return storage && storage->root;
+    }
+
+    /** @brief Whether the schema contains normalization rules
+     *
+     * These are rules executed with @c NORMALIZATION or @c POST_NORMALIZATION
+     * priority, as well as the @c purge_unknown rule.
+     */
+    bool isNormalizing() const
+    {
+      return storage->normalizing;
+    }
+
+    /** @brief Whether the schema contains custom rules outside of normalization
+     *
+     * These are rules registered with @c registerRule that are not executed
+     * with @c NORMALIZATION or @c POST_NORMALIZATION priority. They may alter
+     * the document through @c getDocument, so the schema is not validated in place.
+     */
+    bool hasCustomRules() const
+    {
+      return storage->custom;
+    }
+
+    //! The top-level dictionary schema
+    const Dict& root() const
+    {
+      return *(storage->root);
+    }
+
+    private:
+    std::shared_ptr<const Storage> storage;
+  };
+
+} // namespace cerberus
+
+#endif
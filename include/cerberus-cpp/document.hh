@@ -0,0 +1,258 @@
+#ifndef CERBERUS_CPP_DOCUMENT_HH
+#define CERBERUS_CPP_DOCUMENT_HH
+
+#include<yaml-cpp/yaml.h>
+
+#include<cstddef>
+#include<string>
+#include<utility>
+
+namespace cerberus {
+
+  /** @brief Traits that describe how the validator accesses a document model
+   *
+   * The validator does not depend on a particular document model: It accesses
+   * documents only through a specialization of this template for a handle type,
+   * i.e. a cheap to copy object that refers to a (sub)document without copying it.
+   * @c YAML::Node is supported out of the box. To validate another document model,
+   * e.g. a faster DOM or the C++ structs of an application, specialize this
+   * template for a handle type and instantiate @c BasicValidator with it.
+   * A specialization needs to provide the following static members:
+   *
+   * * <tt>Node undefined()</tt> returns a handle that refers to no document,
+   *   which is e.g. used for missing fields.
+   * * <tt>bool is_defined(const Node&)</tt>, <tt>bool is_null(const Node&)</tt>,
+   *   <tt>bool is_scalar(const Node&)</tt>, <tt>bool is_sequence(const Node&)</tt>
+   *   and <tt>bool is_map(const Node&)</tt> classify a document.
+   * * <tt>std::size_t size(const Node&)</tt> returns the number of entries of
+   *   a mapping or sequence and 0 for any other document.
+   * * <tt>Node lookup(const Node& map, const std::string& key)</tt> looks up a
+   *   key of a mapping and returns an undefined document if it is not found.
+   * * <tt>Node element(const Node& sequence, std::size_t i)</tt> returns an
+   *   entry of a sequence or an undefined document if it does not exist.
+   * * <tt>void for_each_item(const Node& map, F&& f)</tt> calls <tt>f(key, value)</tt>
+   *   with handles to the keys and values of a mapping in order.
+   * * <tt>void for_each_element(const Node& sequence, F&& f)</tt> calls @c f
+   *   with handles to the entries of a sequence in order.
+   * * <tt>scalar(const Node&)</tt> returns the text of a scalar as a @c std::string
+   *   or a reference to one.
+   * * <tt>to_yaml(const Node&)</tt> returns a @c YAML::Node for the document,
+   *   which is how types registered with the validator decode values. This
+   *   only needs to be efficient for scalars.
+   *
+   * Documents accessed through traits are validated in place without
+   * normalization, as normalization requires altering the document. Only
+   * @c YAML::Node documents are normalized.
+   *
+   * @tparam Node The handle type of the document model
+   */
+  template<typename Node>
+  struct DocumentTraits;
+
+  //! The document traits for yaml-cpp, the default document model
+  template<>
+  struct DocumentTraits<YAML::Node>
+  {
+    // Note that all lookups are done on const nodes, as non-const lookups alter the document
+    static YAML::Node undefined()
+    {
+      return YAML::Node(YAML::NodeType::Undefined);
+    }
+
+    static bool is_defined(const YAML::Node& node)
+    {
+      return node.IsDefined();
+    }
+
+    static bool is_null(const YAML::Node& node)
+    {
+      return node.IsNull();
+    }
+
+    static bool is_scalar(const YAML::Node& node)
+    {
+      return node.IsScalar();
+    }
+
+    static bool is_sequence(const YAML::Node& node)
+    {
+      return node.IsSequence();
+    }
+
+    static bool is_map(const YAML::Node& node)
+    {
+      return node.IsMap();
+    }
+
+    static std::size_t size(const YAML::Node& node)
+    {
+      return node.size();
+    }
+
+    static YAML::Node lookup(const YAML::Node& map, const std::string& key)
+    {
+      const YAML::Node item = map[key];
+      return item.IsDefined() ? item : undefined();
+    }
+
+    static YAML::Node element(const YAML::Node& sequence, std::size_t i)
+    {
+      const YAML::Node item = sequence[i];
+      return item.IsDefined() ? item : undefined();
+    }
+
+    template<typename F>
+    static void for_each_item(const YAML::Node& map, F&& f)
+    {
+      if(map.IsMap())
+        for(auto item : map)
+          f(item.first, item.second);
+    }
+
+    template<typename F>
+    static void for_each_element(const YAML::Node& sequence, F&& f)
+    {
+      if(sequence.IsSequence())
+        for(const YAML::Node& item : sequence)
+          f(item);
+    }
+
+    static const std::string& scalar(const YAML::Node& node)
+    {
+      return node.Scalar();
+    }
+
+    static const YAML::Node& to_yaml(const YAML::Node& node)
+    {
+      return node;
+    }
+  };
+
+  /** @brief Uniform access to documents of any model with document traits
+   *
+   * These free functions forward to the @c DocumentTraits of their argument,
+   * such that rules can be written once for all document models.
+   */
+  namespace document {
+
+    template<typename Node>
+    Node undefined()
+    {
+      return DocumentTraits<Node>::undefined();
+    }
+
+    template<typename Node>
+    bool is_defined(const Node& node)
+    {
+      return DocumentTraits<Node>::is_defined(node);
+    }
+
+    template<typename Node>
+    bool is_null(const Node& node)
+    {
+      return DocumentTraits<Node>::is_null(node);
+    }
+
+    template<typename Node>
+    bool is_scalar(const Node& node)
+    {
+      return DocumentTraits<Node>::is_scalar(node);
+    }
+
+    template<typename Node>
+    bool is_sequence(const Node& node)
+    {
+      return DocumentTraits<Node>::is_sequence(node);
+    }
+
+    template<typename Node>
+    bool is_map(const Node& node)
+    {
+      return DocumentTraits<Node>::is_map(node);
+    }
+
+    template<typename Node>
+    std::size_t size(const Node& node)
+    {
+      return DocumentTraits<Node>::size(node);
+    }
+
+    template<typename Node>
+    Node lookup(const Node& map, const std::string& key)
+    {
+      return DocumentTraits<Node>::lookup(map, key);
+    }
+
+    template<typename Node>
+    Node element(const Node& sequence, std::size_t i)
+    {
+      return DocumentTraits<Node>::element(sequence, i);
+    }
+
+    template<typename Node, typename F>
+    void for_each_item(const Node& map, F&& f)
+    {
+      DocumentTraits<Node>::for_each_item(map, std::forward<F>(f));
+    }
+
+    template<typename Node, typename F>
+    void for_each_element(const Node& sequence, F&& f)
+    {
+      DocumentTraits<Node>::for_each_element(sequence, std::forward<F>(f));
+    }
+
+    template<typename Node>
+    decltype(auto) scalar(const Node& node)
+    {
+      return DocumentTraits<Node>::scalar(node);
+    }
+
+    template<typename Node>
+    decltype(auto) to_yaml(const Node& node)
+    {
+      return DocumentTraits<Node>::to_yaml(node);
+    }
+
+  } // namespace document
+
+  namespace impl {
+
+    //! Deep copy a document, documents other than YAML are never copied as they are not normalized
+    inline YAML::Node clone_document(const YAML::Node& node)
+    {
+      return YAML::Clone(node);
+    }
+
+    template<typename Node>
+    Node clone_document(const Node& node)
+    {
+      return node;
+    }
+
+    //! Let a handle refer to another document, assigning a YAML::Node would alter the document instead
+    inline void rebind_document(YAML::Node& target, const YAML::Node& source)
+    {
+      target.reset(source);
+    }
+
+    template<typename Node>
+    void rebind_document(Node& target, const Node& source)
+    {
+      target = source;
+    }
+
+    //! Assign to a YAML document, documents of other models are never normalized
+    inline void assign_document(YAML::Node target, const YAML::Node& value)
+    {
+      target = value;
+    }
+
+    template<typename Node>
+    void assign_document(const Node&, const YAML::Node&)
+    {}
+
+  } // namespace impl
+
+} // namespace cerberus
+
+#endif
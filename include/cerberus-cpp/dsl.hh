@@ -0,0 +1,1160 @@
+#ifndef CERBERUS_CPP_DSL_HH
+#define CERBERUS_CPP_DSL_HH
+
+#include<cerberus-cpp/document.hh>
+#include<cerberus-cpp/generated.hh>
+#include<cerberus-cpp/rules.hh>
+#include<cerberus-cpp/stack.hh>
+
+#include<yaml-cpp/yaml.h>
+
+#include<algorithm>
+#include<cstddef>
+#include<iomanip>
+#include<limits>
+#include<regex>
+#include<sstream>
+#include<string>
+#include<type_traits>
+#include<utility>
+#include<vector>
+
+/** @brief Define a string literal for use in the compile-time schema DSL
+ *
+ * C++14 does not allow string literals as template arguments, so field names
+ * and string values are given as types that this macro defines, e.g.
+ * <tt>CERBERUS_DSL_STRING(Port, "port");</tt>. Note that the DSL names its rules and
+ * types in lower case, e.g. @c type, which these names must not shadow.
+ */
+#define CERBERUS_DSL_STRING(name, text)            \
+  struct name                                      \
+  {                                                \
+    using value_type = std::string;                \
+    static const std::string& value()              \
+    {                                              \
+      static const std::string literal(text);      \
+      return literal;                              \
+    }                                              \
+    static std::string text_value()                \
+    {                                              \
+      return value();                              \
+    }                                              \
+  }
+
+namespace cerberus {
+
+  /** @brief A compile-time schema DSL
+   *
+   * Schemas that never change at runtime can be written as C++ types instead
+   * of YAML, e.g.
+   *
+   * @code
+   * CERBERUS_DSL_STRING(Port, "port");
+   * using Server = dict<field<Port, type<types::integer>, min<1>, max<65535>>>;
+   * @endcode
+   *
+   * Every rule of @c rules.hh has a counterpart here. Rules are dispatched by
+   * the compiler: Validating against such a schema involves neither rule nor
+   * type lookups nor a YAML schema. Validation is read-only and reports the
+   * same errors as a @c BasicValidator in @c ValidationMode::READ_ONLY that
+   * validates against the equivalent YAML schema, which @c to_yaml returns for
+   * cross-checking. Normalization rules like @c default_ and @c rename are
+   * part of that YAML schema, but are not applied.
+   *
+   * Literals are types with a static @c value() and a @c value_type, e.g. the
+   * types defined by @c CERBERUS_DSL_STRING, @c int_, @c bool_ and @c ratio.
+   * Their @c text_value() is their representation in the YAML schema.
+   */
+  namespace dsl {
+
+    using generated::Context;
+    using generated::Frame;
+
+    //! The built-in types for use with the @c type rule
+    namespace types {
+
+      struct integer
+      {
+        using value_type = long long;
+        static const char* name() { return "integer"; }
+      };
+
+      struct string
+      {
+        using value_type = std::string;
+        static const char* name() { return "string"; }
+      };
+
+      struct float_
+      {
+        using value_type = long double;
+        static const char* name() { return "float"; }
+      };
+
+      struct number
+      {
+        using value_type = long double;
+        static const char* name() { return "number"; }
+      };
+
+      struct boolean
+      {
+        using value_type = bool;
+        static const char* name() { return "boolean"; }
+      };
+
+      struct list
+      {
+        using value_type = void;
+        static const char* name() { return "list"; }
+      };
+
+      struct dict
+      {
+        using value_type = void;
+        static const char* name() { return "dict"; }
+      };
+
+    } // namespace types
+
+    //! An integer literal
+    template<long long Value>
+    struct int_
+    {
+      using value_type = long long;
+      static long long value() { return Value; }
+      static std::string text_value() { return std::to_string(Value); }
+    };
+
+    //! A boolean literal
+    template<bool Value>
+    struct bool_
+    {
+      using value_type = bool;
+      static bool value() { return Value; }
+      static std::string text_value() { return Value ? "true" : "false"; }
+    };
+
+    //! A floating point literal given as a fraction
+    template<long long Numerator, long long Denominator = 1>
+    struct ratio
+    {
+      using value_type = long double;
+      static long double value() { return static_cast<long double>(Numerator) / static_cast<long double>(Denominator); }
+      static std::string text_value()
+      {
+        std::ostringstream out;
+        out << std::setprecision(std::numeric_limits<long double>::max_digits10) << value();
+        return out.str();
+      }
+    };
+
+    namespace impl {
+
+      //! Types that identify the rules, e.g. to detect whether a schema item has a rule
+      namespace tags {
+
+        struct allow_unknown;
+        struct allowed;
+        struct contains;
+        struct default_;
+        struct dependencies;
+        struct empty;
+        struct excludes;
+        struct forbidden;
+        struct items;
+        struct keysrules;
+        struct max;
+        struct maxlength;
+        struct meta;
+        struct min;
+        struct minlength;
+        struct nullable;
+        struct purge_unknown;
+        struct regex;
+        struct rename;
+        struct require_all;
+        struct required;
+        struct schema;
+        struct type;
+        struct valuesrules;
+
+      } // namespace tags
+
+      constexpr std::size_t priority(RulePriority p)
+      {
+        return static_cast<std::size_t>(p);
+      }
+
+      //! A literal converted to the type of a field, literals of other types are decoded like the validator decodes them
+      template<typename T, typename Literal>
+      const T& literal_as(std::true_type)
+      {
+        static const T value(Literal::value());
+        return value;
+      }
+
+      template<typename T, typename Literal>
+      const T& literal_as(std::false_type)
+      {
+        static const T value = []
+        {
+          T decoded{};
+          YAML::convert<T>::decode(YAML::Node(Literal::text_value()), decoded);
+          return decoded;
+        }();
+        return value;
+      }
+
+      template<typename T, typename Literal>
+      const T& literal_as()
+      {
+        using L = typename Literal::value_type;
+        return literal_as<T, Literal>(std::integral_constant<bool, std::is_same<T, L>::value ||
+                                                                   (std::is_floating_point<T>::value && std::is_integral<L>::value && !std::is_same<L, bool>::value)>{});
+      }
+
+      //! Whether a literal can be decoded as a given type
+      template<typename T, typename Literal>
+      bool literal_decodes()
+      {
+        static const bool decodes = []
+        {
+          T decoded;
+          return YAML::convert<T>::decode(YAML::Node(Literal::text_value()), decoded);
+        }();
+        return decodes;
+      }
+
+      template<typename... Literals>
+      YAML::Node literal_list()
+      {
+        YAML::Node list(YAML::NodeType::Sequence);
+        int expand[] = {0, (list.push_back(Literals::text_value()), 0)...};
+        static_cast<void>(expand);
+        return list;
+      }
+
+      //! The value type of the scalar type of a schema item, which rules like @c allowed compare with
+      template<typename... Rules>
+      struct scalar_type
+      {
+        using value_type = void;
+      };
+
+      template<typename First, typename... Rules>
+      struct scalar_type<First, Rules...>
+        : scalar_type<Rules...>
+      {};
+
+      //! Apply a rule if it executes with the given priority
+      template<typename Item, typename Rule, typename Document>
+      void apply_rule(Context<Document>& c, const Frame<Document>& f, std::true_type)
+      {
+        Rule::template apply<Item>(c, f);
+      }
+
+      template<typename Item, typename Rule, typename Document>
+      void apply_rule(Context<Document>&, const Frame<Document>&, std::false_type)
+      {}
+
+      template<std::size_t Priority, typename Item, typename... Rules, typename Document>
+      void apply_rules(Context<Document>& c, const Frame<Document>& f)
+      {
+        int expand[] = {0, (apply_rule<Item, Rules>(c, f, std::integral_constant<bool, Rules::priority == Priority>{}), 0)...};
+        static_cast<void>(expand);
+      }
+
+    } // namespace impl
+
+    /** @brief A schema item, i.e. the rules that apply to a value
+     *
+     * This is used where rules take subschemas, e.g. @c items, and to
+     * describe list elements with the @c schema rule.
+     */
+    template<typename... Rules>
+    struct rules
+    {
+      //! The C++ type that the item's scalar type decodes to (or void)
+      using value_type = typename impl::scalar_type<Rules...>::value_type;
+
+      /** @brief Validate a value against this schema item
+       *
+       * @tparam TopLevel Whether this is a field of the root schema, which the
+       *                  validator normalizes with the @c nullable default
+       */
+      template<bool TopLevel = false, typename Document>
+      static void validate(Context<Document>& c, const Frame<Document>& f)
+      {
+        // The policies are overriden by FIRST and restored by LAST rules
+        const bool allow_unknown = c.allow_unknown;
+        const bool require_all = c.require_all;
+
+        impl::apply_rules<impl::priority(RulePriority::FIRST), rules, Rules...>(c, f);
+        impl::apply_rules<impl::priority(RulePriority::VALIDATION), rules, Rules...>(c, f);
+        apply_defaults(c, f, std::integral_constant<bool, TopLevel && !has_rule<impl::tags::nullable>()>{});
+        if(!has_rule<impl::tags::required>() && c.require_all && (!document::is_defined(f.document)))
+          c.raiseError(f, "Required-Rule violated!");
+        impl::apply_rules<impl::priority(RulePriority::TYPECHECKING), rules, Rules...>(c, f);
+        impl::apply_rules<impl::priority(RulePriority::LAST), rules, Rules...>(c, f);
+
+        c.allow_unknown = allow_unknown;
+        c.require_all = require_all;
+      }
+
+      //! The equivalent YAML schema
+      static YAML::Node yaml()
+      {
+        YAML::Node schema(YAML::NodeType::Map);
+        int expand[] = {0, (Rules::yaml(schema), 0)...};
+        static_cast<void>(expand);
+        return schema;
+      }
+
+      template<typename Tag>
+      static constexpr bool has_rule()
+      {
+        bool found[] = {false, std::is_same<Tag, typename Rules::rule_tag>::value...};
+        for(bool f : found)
+          if(f)
+            return true;
+        return false;
+      }
+
+      private:
+      // The validator normalizes the fields of the root schema with the default of the nullable rule
+      template<typename Document>
+      static void apply_defaults(Context<Document>& c, const Frame<Document>& f, std::true_type)
+      {
+        if(document::is_null(f.document))
+          c.raiseError(f, "Nullable-Rule violated!");
+      }
+
+      template<typename Document>
+      static void apply_defaults(Context<Document>&, const Frame<Document>&, std::false_type)
+      {}
+    };
+
+    //! A field of a dictionary schema
+    template<typename Name, typename... Rules>
+    struct field
+    {
+      using name = Name;
+      using item = rules<Rules...>;
+    };
+
+    /** @brief A dictionary schema, the top-level schema of a document
+     *
+     * Use it with @c Validator to validate documents and with @c to_yaml to
+     * obtain the equivalent YAML schema.
+     */
+    template<typename... Fields>
+    struct dict
+    {
+      //! Validate the root document
+      template<typename Document>
+      static void validate(Context<Document>& c, const Frame<Document>& f)
+      {
+        validateDict<true>(c, f);
+      }
+
+      template<bool TopLevel, typename Document>
+      static void validateDict(Context<Document>& c, const Frame<Document>& f)
+      {
+        int expand[] = {0, (validateField<TopLevel, Fields>(c, f), 0)...};
+        static_cast<void>(expand);
+
+        // Renaming does not happen without normalization, so keys are known if they are fields
+        if(!c.allow_unknown)
+        {
+          document::for_each_item(f.document, [&c, &f](const Document& key, const Document&)
+          {
+            if((!document::is_scalar(key)) || (!known(document::scalar(key))))
+              c.raiseError(f, "Unknown item found in validator that does not accept unknown items: " + document::to_yaml(key).template as<std::string>());
+          });
+        }
+      }
+
+      //! The equivalent YAML schema
+      static YAML::Node yaml()
+      {
+        YAML::Node schema(YAML::NodeType::Map);
+        int expand[] = {0, (schema[Fields::name::value()] = Fields::item::yaml(), 0)...};
+        static_cast<void>(expand);
+        return schema;
+      }
+
+      private:
+      template<bool TopLevel, typename Field, typename Document>
+      static void validateField(Context<Document>& c, const Frame<Document>& f)
+      {
+        const std::string& name = Field::name::value();
+        const Frame<Document> field(f, name.data(), name.size(), document::lookup(f.document, name));
+        Field::item::template validate<TopLevel>(c, field);
+      }
+
+      static bool known(const std::string& key)
+      {
+        bool found[] = {false, (key == Fields::name::value())...};
+        for(bool f : found)
+          if(f)
+            return true;
+        return false;
+      }
+    };
+
+    //! A validator for a schema written with the DSL
+    template<typename Schema>
+    using Validator = generated::Validator<Schema>;
+
+    //! The YAML schema equivalent to a schema written with the DSL
+    template<typename Schema>
+    YAML::Node to_yaml()
+    {
+      return Schema::yaml();
+    }
+
+    // The rules, in the order of rules.hh
+
+    template<bool Value>
+    struct allow_unknown
+    {
+      using rule_tag = impl::tags::allow_unknown;
+      static constexpr std::size_t priority = impl::priority(RulePriority::FIRST);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>&)
+      {
+        c.allow_unknown = Value;
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["allow_unknown"] = Value;
+      }
+    };
+
+    template<typename... Literals>
+    struct allowed
+    {
+      using rule_tag = impl::tags::allowed;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        using T = typename Item::value_type;
+        static_assert(!std::is_void<T>::value, "The allowed rule requires a scalar type rule in the same schema");
+        T value;
+        if(!generated::decode(f.document, value))
+        {
+          c.raiseError(f, "Value disallowed by Allowed-Rule!");
+          return;
+        }
+        bool found[] = {false, (impl::literal_decodes<T, Literals>() && (value == impl::literal_as<T, Literals>()))...};
+        for(bool match : found)
+          if(match)
+            return;
+        c.raiseError(f, "Value disallowed by Allowed-Rule!");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["allowed"] = impl::literal_list<Literals...>();
+      }
+    };
+
+    template<typename... Literals>
+    struct contains
+    {
+      using rule_tag = impl::tags::contains;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      static_assert(sizeof...(Literals) > 0, "The contains rule requires at least one value");
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        static const std::string values[] = {Literals::text_value()...};
+        bool needed[sizeof...(Literals)];
+        std::fill(needed, needed + sizeof...(Literals), true);
+        document::for_each_element(f.document, [&needed](const Document& element)
+        {
+          const std::string value = generated::as_string(element);
+          for(std::size_t i = 0; i < sizeof...(Literals); ++i)
+            if(value == values[i])
+              needed[i] = false;
+        });
+        if(std::find(needed, needed + sizeof...(Literals), true) != needed + sizeof...(Literals))
+          c.raiseError(f, "Contains-Rule violated");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["contains"] = impl::literal_list<Literals...>();
+      }
+    };
+
+    template<typename Literal>
+    struct default_
+    {
+      using rule_tag = impl::tags::default_;
+      static constexpr std::size_t priority = impl::priority(RulePriority::NORMALIZATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>&, const Frame<Document>&)
+      {}
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["default"] = Literal::text_value();
+      }
+    };
+
+    //! A dependency on a field with one of the given values, for use with @c dependencies
+    template<typename Path, typename... Literals>
+    struct dependency
+    {
+      using path = Path;
+    };
+
+    namespace impl {
+
+      template<typename Dependency>
+      struct dependency_traits
+      {
+        static constexpr bool mapping = false;
+        using path = Dependency;
+
+        template<typename Document>
+        static void check(Context<Document>&, const Frame<Document>&, const Document&, const DocumentPath&)
+        {}
+
+        static void yaml(YAML::Node& schema)
+        {
+          schema.push_back(Dependency::text_value());
+        }
+      };
+
+      template<typename Path, typename... Literals>
+      struct dependency_traits<dependency<Path, Literals...>>
+      {
+        static constexpr bool mapping = true;
+        using path = Path;
+
+        template<typename Document>
+        static void check(Context<Document>& c, const Frame<Document>& f, const Document& lookup, const DocumentPath& dependency)
+        {
+          const std::string value = generated::as_string(lookup);
+          bool found[] = {false, (value == Literals::text_value())...};
+          for(bool match : found)
+            if(match)
+              return;
+
+          std::string options;
+          int expand[] = {0, (options += Literals::text_value() + ", ", 0)...};
+          static_cast<void>(expand);
+          c.raiseError(f, "dependencies-Rule violated: " + dependency.str() + " requires value out of [" + options + "]");
+        }
+
+        static void yaml(YAML::Node& schema)
+        {
+          schema[Path::value()] = literal_list<Literals...>();
+        }
+      };
+
+      //! The parsed document path of a string literal
+      template<typename Path>
+      const DocumentPath& document_path()
+      {
+        static const DocumentPath path(Path::value());
+        return path;
+      }
+
+    } // namespace impl
+
+    /** @brief The dependencies rule
+     *
+     * Dependencies are either paths given as string literals or values of
+     * fields given with @c dependency, which corresponds to the mapping
+     * form of the rule.
+     */
+    template<typename... Dependencies>
+    struct dependencies
+    {
+      using rule_tag = impl::tags::dependencies;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        if(!document::is_defined(f.document))
+          return;
+        int expand[] = {0, (check<Dependencies>(c, f), 0)...};
+        static_cast<void>(expand);
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        YAML::Node argument(mapping() ? YAML::NodeType::Map : YAML::NodeType::Sequence);
+        int expand[] = {0, (impl::dependency_traits<Dependencies>::yaml(argument), 0)...};
+        static_cast<void>(expand);
+        schema["dependencies"] = argument;
+      }
+
+      private:
+      static constexpr bool mapping()
+      {
+        bool mappings[] = {false, impl::dependency_traits<Dependencies>::mapping...};
+        bool any = false;
+        for(bool m : mappings)
+          any = any || m;
+        return any;
+      }
+
+      template<typename Dependency, typename Document>
+      static void check(Context<Document>& c, const Frame<Document>& f)
+      {
+        using traits = impl::dependency_traits<Dependency>;
+        static_assert(traits::mapping == mapping(), "Dependencies need to be all paths or all given with dependency<>");
+        const auto& path = impl::document_path<typename traits::path>();
+        const Document lookup = generated::lookup_path(f, 1, path);
+        if(!document::is_defined(lookup))
+          c.raiseError(f, "dependencies-Rule violated: " + path.str() + " required!");
+        traits::check(c, f, lookup, path);
+      }
+    };
+
+    template<bool Value>
+    struct empty
+    {
+      using rule_tag = impl::tags::empty;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        if((!Value) && document::is_sequence(f.document) && (document::size(f.document) == 0))
+          c.raiseError(f, "Empty-Rule violated for sequence");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["empty"] = Value;
+      }
+    };
+
+    template<typename... Paths>
+    struct excludes
+    {
+      using rule_tag = impl::tags::excludes;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        if(!document::is_defined(f.document))
+          return;
+        int expand[] = {0, (check<Paths>(c, f), 0)...};
+        static_cast<void>(expand);
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["excludes"] = impl::literal_list<Paths...>();
+      }
+
+      private:
+      template<typename Path, typename Document>
+      static void check(Context<Document>& c, const Frame<Document>& f)
+      {
+        const auto& path = impl::document_path<Path>();
+        if(document::is_defined(generated::lookup_path(f, 1, path)))
+          c.raiseError(f, "excludes-Rule violated: " + path.str() + " is not allowed!");
+      }
+    };
+
+    template<typename... Literals>
+    struct forbidden
+    {
+      using rule_tag = impl::tags::forbidden;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        using T = typename Item::value_type;
+        static_assert(!std::is_void<T>::value, "The forbidden rule requires a scalar type rule in the same schema");
+        T value;
+        if(!generated::decode(f.document, value))
+          return;
+        bool found = false;
+        int expand[] = {0, (check<Literals>(c, f, value, found), 0)...};
+        static_cast<void>(expand);
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["forbidden"] = impl::literal_list<Literals...>();
+      }
+
+      private:
+      template<typename Literal, typename T, typename Document>
+      static void check(Context<Document>& c, const Frame<Document>& f, const T& value, bool& found)
+      {
+        if((!found) && impl::literal_decodes<T, Literal>() && (value == impl::literal_as<T, Literal>()))
+        {
+          found = true;
+          c.raiseError(f, "Forbidden-Rule violated: " + Literal::text_value());
+        }
+      }
+    };
+
+    //! The items rule, which takes a @c rules<...> per list entry
+    template<typename... Items>
+    struct items
+    {
+      using rule_tag = impl::tags::items;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        std::size_t i = 0;
+        int expand[] = {0, (validateElement<Items>(c, f, i++), 0)...};
+        static_cast<void>(expand);
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        YAML::Node list(YAML::NodeType::Sequence);
+        int expand[] = {0, (list.push_back(Items::yaml()), 0)...};
+        static_cast<void>(expand);
+        schema["items"] = list;
+      }
+
+      private:
+      template<typename Subschema, typename Document>
+      static void validateElement(Context<Document>& c, const Frame<Document>& f, std::size_t i)
+      {
+        const Frame<Document> element(f, i, document::element(f.document, i));
+        Subschema::validate(c, element);
+      }
+    };
+
+    //! The keysrules rule, which takes the rules that apply to the keys of a mapping
+    template<typename... Rules>
+    struct keysrules
+    {
+      using rule_tag = impl::tags::keysrules;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        document::for_each_item(f.document, [&c, &f](const Document& key, const Document&)
+        {
+          const Frame<Document> detached(f, key);
+          rules<Rules...>::validate(c, detached);
+        });
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["keysrules"] = rules<Rules...>::yaml();
+      }
+    };
+
+    template<typename Literal>
+    struct max_rule
+    {
+      using rule_tag = impl::tags::max;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        using T = typename Item::value_type;
+        static_assert(!std::is_void<T>::value, "The max rule requires a scalar type rule in the same schema");
+        if(!document::is_defined(f.document))
+          return;
+        T value;
+        const auto& constant = impl::literal_as<T, Literal>();
+        // Like the comparison of a type with a constant, values that are not ordered (e.g. NaN) are neither greater nor equal
+        if(generated::decode(f.document, value) && (!(value < constant)) && ((constant < value) || (value == constant)))
+          c.raiseError(f, "Max-Rrule violated!");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["max"] = Literal::text_value();
+      }
+    };
+
+    //! The max rule with an integer argument
+    template<long long Value>
+    using max = max_rule<int_<Value>>;
+
+    //! The max rule with an argument of any literal type
+    template<typename Literal>
+    using max_value = max_rule<Literal>;
+
+    template<int Value>
+    struct maxlength
+    {
+      using rule_tag = impl::tags::maxlength;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        if(document::size(f.document) > static_cast<std::size_t>(Value))
+          c.raiseError(f, "Maxlength-Rule violated!");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["maxlength"] = Value;
+      }
+    };
+
+    //! A key-value pair of the meta rule
+    template<typename Key, typename Literal>
+    struct entry
+    {};
+
+    //! The meta rule, whose entries are given with @c entry
+    template<typename... Entries>
+    struct meta
+    {
+      using rule_tag = impl::tags::meta;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>&, const Frame<Document>&)
+      {}
+
+      static void yaml(YAML::Node& schema)
+      {
+        YAML::Node entries(YAML::NodeType::Map);
+        int expand[] = {0, (add(entries, Entries{}), 0)...};
+        static_cast<void>(expand);
+        schema["meta"] = entries;
+      }
+
+      private:
+      template<typename Key, typename Literal>
+      static void add(YAML::Node& entries, entry<Key, Literal>)
+      {
+        entries[Key::value()] = Literal::text_value();
+      }
+    };
+
+    template<typename Literal>
+    struct min_rule
+    {
+      using rule_tag = impl::tags::min;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        using T = typename Item::value_type;
+        static_assert(!std::is_void<T>::value, "The min rule requires a scalar type rule in the same schema");
+        if(!document::is_defined(f.document))
+          return;
+        T value;
+        const auto& constant = impl::literal_as<T, Literal>();
+        if(!(generated::decode(f.document, value) && (constant < value)))
+          c.raiseError(f, "Min-Rule violated!");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["min"] = Literal::text_value();
+      }
+    };
+
+    //! The min rule with an integer argument
+    template<long long Value>
+    using min = min_rule<int_<Value>>;
+
+    //! The min rule with an argument of any literal type
+    template<typename Literal>
+    using min_value = min_rule<Literal>;
+
+    template<int Value>
+    struct minlength
+    {
+      using rule_tag = impl::tags::minlength;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        if(document::size(f.document) < static_cast<std::size_t>(Value))
+          c.raiseError(f, "Minlength-Rule violated!");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["minlength"] = Value;
+      }
+    };
+
+    template<bool Value>
+    struct nullable
+    {
+      using rule_tag = impl::tags::nullable;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        if((!Value) && document::is_null(f.document))
+          c.raiseError(f, "Nullable-Rule violated!");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["nullable"] = Value;
+      }
+    };
+
+    template<bool Value>
+    struct purge_unknown
+    {
+      using rule_tag = impl::tags::purge_unknown;
+      static constexpr std::size_t priority = impl::priority(RulePriority::FIRST);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>&, const Frame<Document>&)
+      {}
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["purge_unknown"] = Value;
+      }
+    };
+
+    template<typename Pattern>
+    struct regex
+    {
+      using rule_tag = impl::tags::regex;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        static const std::regex pattern(Pattern::value());
+        if(!std::regex_match(document::to_yaml(f.document).template as<std::string>(), pattern))
+          c.raiseError(f, "Regex-Rule violated!");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["regex"] = Pattern::value();
+      }
+    };
+
+    template<typename Name>
+    struct rename
+    {
+      using rule_tag = impl::tags::rename;
+      static constexpr std::size_t priority = impl::priority(RulePriority::NORMALIZATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>&, const Frame<Document>&)
+      {}
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["rename"] = Name::value();
+      }
+    };
+
+    template<bool Value>
+    struct require_all
+    {
+      using rule_tag = impl::tags::require_all;
+      static constexpr std::size_t priority = impl::priority(RulePriority::FIRST);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>&)
+      {
+        c.require_all = Value;
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["require_all"] = Value;
+      }
+    };
+
+    template<bool Value>
+    struct required
+    {
+      using rule_tag = impl::tags::required;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        // The require all policy turns all required rules into required(true)
+        if((Value || c.require_all) && (!document::is_defined(f.document)))
+          c.raiseError(f, "Required-Rule violated!");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["required"] = Value;
+      }
+    };
+
+    /** @brief The schema rule
+     *
+     * The subschema is either a @c dict<...> for mappings or a @c rules<...>
+     * for the entries of lists. The same schema needs to give the type
+     * @c types::dict or @c types::list respectively.
+     */
+    template<typename Subschema>
+    struct schema;
+
+    template<typename... Fields>
+    struct schema<dict<Fields...>>
+    {
+      using rule_tag = impl::tags::schema;
+      using subschema_type = types::dict;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        dict<Fields...>::template validateDict<false>(c, f);
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["schema"] = dict<Fields...>::yaml();
+      }
+    };
+
+    template<typename... Rules>
+    struct schema<rules<Rules...>>
+    {
+      using rule_tag = impl::tags::schema;
+      using subschema_type = types::list;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        for(std::size_t i = 0, size = document::size(f.document); i < size; ++i)
+        {
+          const Frame<Document> element(f, i, document::element(f.document, i));
+          rules<Rules...>::validate(c, element);
+        }
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["schema"] = rules<Rules...>::yaml();
+      }
+    };
+
+    template<typename... Types>
+    struct type
+    {
+      using rule_tag = impl::tags::type;
+      static constexpr std::size_t priority = impl::priority(RulePriority::TYPECHECKING);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        const Document& doc = f.document;
+        if(document::is_null(doc) || (!document::is_defined(doc)))
+          return;
+        bool matches[] = {false, check(doc, Types{})...};
+        for(bool match : matches)
+          if(match)
+            return;
+        c.raiseError(f, "Type-Rule violated");
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        if(sizeof...(Types) == 1)
+        {
+          const char* names[] = {Types::name()...};
+          schema["type"] = names[0];
+          return;
+        }
+        YAML::Node list(YAML::NodeType::Sequence);
+        int expand[] = {0, (list.push_back(Types::name()), 0)...};
+        static_cast<void>(expand);
+        schema["type"] = list;
+      }
+
+      private:
+      template<typename Document>
+      static bool check(const Document& doc, types::list)
+      {
+        return document::is_sequence(doc);
+      }
+
+      template<typename Document>
+      static bool check(const Document& doc, types::dict)
+      {
+        return document::is_map(doc);
+      }
+
+      template<typename Document, typename Type>
+      static bool check(const Document& doc, Type)
+      {
+        return generated::is_convertible<typename Type::value_type>(doc);
+      }
+    };
+
+    namespace impl {
+
+      template<typename Type, typename... Rules>
+      struct scalar_type<type<Type>, Rules...>
+      {
+        using value_type = typename Type::value_type;
+      };
+
+    } // namespace impl
+
+    //! The valuesrules rule, which takes the rules that apply to the values of a mapping
+    template<typename... Rules>
+    struct valuesrules
+    {
+      using rule_tag = impl::tags::valuesrules;
+      static constexpr std::size_t priority = impl::priority(RulePriority::VALIDATION);
+
+      template<typename Item, typename Document>
+      static void apply(Context<Document>& c, const Frame<Document>& f)
+      {
+        std::vector<std::string> keys;
+        document::for_each_item(f.document, [&keys](const Document& key, const Document&)
+        {
+          keys.push_back(document::to_yaml(key).template as<std::string>());
+        });
+        for(const auto& key : keys)
+        {
+          const Frame<Document> value(f, key.data(), key.size(), document::lookup(f.document, key));
+          rules<Rules...>::validate(c, value);
+        }
+      }
+
+      static void yaml(YAML::Node& schema)
+      {
+        schema["valuesrules"] = rules<Rules...>::yaml();
+      }
+    };
+
+  } // namespace dsl
+
+} // namespace cerberus
+
+#endif
@@ -1,9 +1,11 @@
 #ifndef CERBERUS_CPP_ERROR_HH
 #define CERBERUS_CPP_ERROR_HH
 
+#include<cstddef>
 #include<exception>
 #include<sstream>
 #include<string>
+#include<utility>
 
 namespace cerberus {
 
@@ -12,30 +14,120 @@ namespace cerberus {
     : public std::exception
   {};
 
+  /** @brief A base class for exceptions thrown from Cerberus that carry a message
+   *
+   * Derived exceptions compose their message and pass it to the constructor.
+   */
+  class ErrorBase
+    : public CerberusError
+  {
+    public:
+    explicit ErrorBase(std::string message)
+      : message(std::move(message))
+    {}
+
+    const char* what() const noexcept override
+    {
+      return message.c_str();
+    }
+
+    private:
+    std::string message;
+  };
+
   /** @brief An exception indicating a faulty schema input
    * 
    * This exception is thrown when the schema given to the @c Validator
    * class was not correct.
    */
   class SchemaError
-    : public CerberusError
+    : public ErrorBase
   {
     public:
     template<typename V>
     explicit SchemaError(const V& v)
+      : ErrorBase(errorMessage(v))
+    {}
+
+    private:
+    template<typename V>
+    static std::string errorMessage(const V& v)
     {
       std::stringstream sstream;
       v.printErrors(sstream);
-      message = sstream.str().c_str();
+      return sstream.str();
     }
+  };
 
-    const char* what() const noexcept override
+  /** @brief An exception indicating a schema that cannot be validated from a stream
+   *
+   * This exception is thrown when constructing a @c StreamingValidator
+   * for a schema that needs the entire document, e.g. because it normalizes
+   * the document or cross-references other fields.
+   */
+  class StreamingError
+    : public ErrorBase
+  {
+    public:
+    using ErrorBase::ErrorBase;
+  };
+
+  /** @brief An exception indicating a schema that cannot be translated to C++
+   *
+   * This exception is thrown by the @c CodeGenerator for schemas that use
+   * rules unknown to it or that the interpreting validator would reject
+   * only while validating, e.g. an @c allowed rule without a scalar type.
+   */
+  class CodegenError
+    : public ErrorBase
+  {
+    public:
+    using ErrorBase::ErrorBase;
+  };
+
+  /** @brief An exception indicating malformed JSON input
+   *
+   * This exception is thrown by the @c JsonParser. It carries the location
+   * of the error in the input text.
+   */
+  class JsonError
+    : public ErrorBase
+  {
+    public:
+    JsonError(const std::string& message, std::size_t line, std::size_t column, std::size_t position)
+      : ErrorBase(errorMessage(message, line, column))
+      , line_(line), column_(column), position_(position)
+    {}
+
+    //! The line of the error, starting at 1
+    std::size_t line() const
     {
-      return message;
+      return line_;
+    }
+
+    //! The column of the error, starting at 1
+    std::size_t column() const
+    {
+      return column_;
+    }
+
+    //! The offset of the error in the input text in bytes
+    std::size_t position() const
+    {
+      return position_;
     }
 
     private:
-    const char* message;
+    static std::string errorMessage(const std::string& message, std::size_t line, std::size_t column)
+    {
+      std::stringstream sstream;
+      sstream << "JSON parse error at line " << line << ", column " << column << ": " << message;
+      return sstream.str();
+    }
+
+    std::size_t line_;
+    std::size_t column_;
+    std::size_t position_;
   };
 
   //! A struct representing an error during validation
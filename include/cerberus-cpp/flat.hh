@@ -0,0 +1,588 @@
+#ifndef CERBERUS_CPP_FLAT_HH
+#define CERBERUS_CPP_FLAT_HH
+
+#include<cerberus-cpp/document.hh>
+#include<cerberus-cpp/json.hh>
+#include<cerberus-cpp/validator.hh>
+
+#include<yaml-cpp/eventhandler.h>
+#include<yaml-cpp/yaml.h>
+
+#include<algorithm>
+#include<cstddef>
+#include<cstdint>
+#include<fstream>
+#include<istream>
+#include<memory>
+#include<sstream>
+#include<string>
+#include<unordered_map>
+#include<utility>
+#include<vector>
+
+namespace cerberus {
+
+  class FlatDocument;
+
+  /** @brief A handle to a node of a @c FlatDocument
+   *
+   * Handles are small, trivially copyable values that refer to the storage
+   * of their document. They stay valid as long as the document (or a copy
+   * or move of it) exists. A default constructed handle is undefined.
+   */
+  class FlatNode
+  {
+    public:
+    //! The kinds of nodes in a flat document
+    enum class Kind : std::uint8_t
+    {
+      NUL = 0,
+      SCALAR = 1,
+      SEQUENCE = 2,
+      MAP = 3
+    };
+
+    //! Construct an undefined node
+    FlatNode() = default;
+
+    //! Whether the node refers to a document
+    bool isDefined() const
+    {
+      return storage != nullptr;
+    }
+
+    bool isNull() const
+    {
+      return isDefined() && (entry().kind == Kind::NUL);
+    }
+
+    bool isScalar() const
+    {
+      return isDefined() && (entry().kind == Kind::SCALAR);
+    }
+
+    bool isSequence() const
+    {
+      return isDefined() && (entry().kind == Kind::SEQUENCE);
+    }
+
+    bool isMap() const
+    {
+      return isDefined() && (entry().kind == Kind::MAP);
+    }
+
+    //! The number of entries of a mapping or sequence, 0 for any other node
+    std::size_t size() const
+    {
+      return (isSequence() || isMap()) ? entry().size : 0;
+    }
+
+    /** @brief The text of a scalar
+     *
+     * This must only be called for scalars. Mapping keys are interned,
+     * such that equal keys share their text.
+     */
+    const std::string& scalar() const
+    {
+      return storage->strings[entry().first];
+    }
+
+    /** @brief Look up a key in a mapping
+     *
+     * Interned keys are identified by a single hash lookup, the entries of
+     * the mapping are then found by a binary search.
+     *
+     * @returns The value or an undefined node if the key does not exist
+     */
+    FlatNode operator[](const std::string& key) const
+    {
+      if(!isMap())
+        return FlatNode();
+      auto id = storage->key_ids.find(key);
+      if(id == storage->key_ids.end())
+        return FlatNode();
+      const auto begin = storage->index.begin() + entry().first;
+      const auto end = begin + entry().size;
+      auto found = std::lower_bound(begin, end, id->second, [](const Item& item, std::uint32_t key){ return item.key < key; });
+      if((found == end) || (found->key != id->second))
+        return FlatNode();
+      return FlatNode(storage, found->value);
+    }
+
+    /** @brief Access an entry of a sequence
+     *
+     * @returns The entry or an undefined node if it does not exist
+     */
+    FlatNode operator[](std::size_t i) const
+    {
+      if((!isSequence()) || (i >= entry().size))
+        return FlatNode();
+      return FlatNode(storage, storage->elements[entry().first + i]);
+    }
+
+    //! Call @c f(key, value) for the entries of a mapping in the order of the document
+    template<typename F>
+    void forEachItem(F&& f) const
+    {
+      if(!isMap())
+        return;
+      for(std::size_t i = entry().first; i < entry().first + entry().size; ++i)
+        f(FlatNode(storage, storage->items[i].key), FlatNode(storage, storage->items[i].value));
+    }
+
+    //! Call @c f(element) for the entries of a sequence
+    template<typename F>
+    void forEachElement(F&& f) const
+    {
+      if(!isSequence())
+        return;
+      for(std::size_t i = entry().first; i < entry().first + entry().size; ++i)
+        f(FlatNode(storage, storage->elements[i]));
+    }
+
+    /** @brief Convert the node to a YAML node
+     *
+     * The result is a new node that does not share any state with the
+     * document or with other results, containers are copied.
+     */
+    YAML::Node toYaml() const
+    {
+      return copy();
+    }
+
+    private:
+    friend class FlatDocument;
+
+    //! A node in the arena of a document
+    struct Entry
+    {
+      Kind kind;
+      //! The string id of a scalar or the offset of the entries of a container
+      std::uint32_t first;
+      std::uint32_t size;
+    };
+
+    //! An entry of a mapping, the key is a node in document order and a key id in the index
+    struct Item
+    {
+      std::uint32_t key;
+      std::uint32_t value;
+    };
+
+    //! The storage of a document, which is shared by all copies of a document
+    struct Storage
+    {
+      std::vector<Entry> entries;
+      //! The entries of all sequences, each sequence is a contiguous range
+      std::vector<std::uint32_t> elements;
+      //! The entries of all mappings in the order of the document
+      std::vector<Item> items;
+      //! The entries of all mappings sorted by key id, at the same offsets as in items
+      std::vector<Item> index;
+      std::vector<std::string> strings;
+      std::unordered_map<std::string, std::uint32_t> key_ids;
+      std::uint32_t root = 0;
+    };
+
+    FlatNode(const Storage* storage, std::uint32_t index)
+      : storage(storage)
+      , index(index)
+    {}
+
+    const Entry& entry() const
+    {
+      return storage->entries[index];
+    }
+
+    YAML::Node copy() const
+    {
+      if(isScalar())
+        return YAML::Node(scalar());
+      if(isSequence())
+      {
+        YAML::Node node(YAML::NodeType::Sequence);
+        forEachElement([&node](const FlatNode& element){ node.push_back(element.copy()); });
+        return node;
+      }
+      if(isMap())
+      {
+        YAML::Node node(YAML::NodeType::Map);
+        forEachItem([&node](const FlatNode& key, const FlatNode& value){ node.force_insert(key.copy(), value.copy()); });
+        return node;
+      }
+      return YAML::Node(isDefined() ? YAML::NodeType::Null : YAML::NodeType::Undefined);
+    }
+
+    const Storage* storage = nullptr;
+    std::uint32_t index = 0;
+  };
+
+  /** @brief A compact, read-only document model
+   *
+   * All nodes of the document are stored in a contiguous arena and refer to
+   * each other by index. Scalars are stored in a single string table, in which
+   * mapping keys are interned. The entries of each mapping are additionally
+   * sorted by key, so that lookups do not scan the mapping. Compared to
+   * @c YAML::Node, this needs much less memory, loads faster and does not
+   * involve any reference counting when traversing the document. Documents
+   * are validated with @c FlatValidator. They are read-only and therefore never
+   * normalized. Aliases refer to the node of their anchor without copying it.
+   */
+  class FlatDocument
+  {
+    public:
+    //! Construct an empty document, whose root is a null node
+    FlatDocument()
+      : storage(std::make_shared<FlatNode::Storage>())
+    {
+      storage->entries.push_back({FlatNode::Kind::NUL, 0, 0});
+    }
+
+    /** @brief Load the first document of a YAML (or JSON) string
+     *
+     * @throws YAML::ParserException if the text is not valid YAML
+     */
+    static FlatDocument load(const std::string& text)
+    {
+      std::stringstream stream(text);
+      return load(stream);
+    }
+
+    /** @brief Load the first document of a YAML (or JSON) stream
+     *
+     * The document is built from the events of the yaml-cpp parser directly,
+     * no @c YAML::Node is created.
+     *
+     * @throws YAML::ParserException if the stream is not valid YAML
+     */
+    static FlatDocument load(std::istream& stream)
+    {
+      FlatDocument document;
+      Builder builder(*document.storage);
+      YAML::Parser parser(stream);
+      parser.HandleNextDocument(builder);
+      return document;
+    }
+
+    /** @brief Load a JSON document with the fast @c JsonParser
+     *
+     * @throws JsonError if the text is not valid JSON
+     */
+    static FlatDocument loadJson(const std::string& json)
+    {
+      FlatDocument document;
+      Builder builder(*document.storage);
+      JsonParser(json).parse(builder);
+      return document;
+    }
+
+    /** @brief Load the first document of a YAML (or JSON) file
+     *
+     * @throws YAML::BadFile if the file cannot be opened
+     */
+    static FlatDocument loadFile(const std::string& filename)
+    {
+      std::ifstream stream(filename);
+      if(!stream)
+        throw YAML::BadFile(filename);
+      return load(stream);
+    }
+
+    //! Copy an existing YAML document into a flat document
+    static FlatDocument fromYaml(const YAML::Node& node)
+    {
+      FlatDocument document;
+      Builder builder(*document.storage);
+      builder.add(node);
+      return document;
+    }
+
+    //! The root node of the document
+    FlatNode root() const
+    {
+      return FlatNode(storage.get(), storage->root);
+    }
+
+    //! The number of nodes in the arena
+    std::size_t nodeCount() const
+    {
+      return storage->entries.size();
+    }
+
+    private:
+    //! Builds the arena from parser events or an existing YAML document
+    class Builder
+      : public YAML::EventHandler
+    {
+      public:
+      explicit Builder(FlatNode::Storage& storage)
+        : storage(storage)
+      {}
+
+      void OnDocumentStart(const YAML::Mark&) override
+      {
+        storage.entries.clear();
+        storage.entries.push_back({FlatNode::Kind::NUL, 0, 0});
+        storage.root = 0;
+      }
+
+      void OnDocumentEnd() override {}
+
+      void OnNull(const YAML::Mark&, YAML::anchor_t anchor) override
+      {
+        addEntry({FlatNode::Kind::NUL, 0, 0}, anchor);
+      }
+
+      void OnAlias(const YAML::Mark&, YAML::anchor_t anchor) override
+      {
+        auto anchored = anchors.find(anchor);
+        if(anchored == anchors.end())
+          addEntry({FlatNode::Kind::NUL, 0, 0}, YAML::NullAnchor);
+        else
+          addChild(anchored->second);
+      }
+
+      void OnScalar(const YAML::Mark&, const std::string&, YAML::anchor_t anchor, const std::string& value) override
+      {
+        addScalar(value, anchor);
+      }
+
+      void OnSequenceStart(const YAML::Mark&, const std::string&, YAML::anchor_t anchor, YAML::EmitterStyle::value) override
+      {
+        startContainer(FlatNode::Kind::SEQUENCE, anchor);
+      }
+
+      void OnSequenceEnd() override
+      {
+        endContainer();
+      }
+
+      void OnMapStart(const YAML::Mark&, const std::string&, YAML::anchor_t anchor, YAML::EmitterStyle::value) override
+      {
+        startContainer(FlatNode::Kind::MAP, anchor);
+      }
+
+      void OnMapEnd() override
+      {
+        endContainer();
+      }
+
+      //! Add a YAML document recursively
+      void add(const YAML::Node& node)
+      {
+        if(node.IsScalar())
+          addScalar(node.Scalar(), YAML::NullAnchor);
+        else if(node.IsSequence())
+        {
+          startContainer(FlatNode::Kind::SEQUENCE, YAML::NullAnchor);
+          for(const YAML::Node& element : node)
+            add(element);
+          endContainer();
+        }
+        else if(node.IsMap())
+        {
+          startContainer(FlatNode::Kind::MAP, YAML::NullAnchor);
+          for(auto item : node)
+          {
+            add(item.first);
+            add(item.second);
+          }
+          endContainer();
+        }
+        else
+          addEntry({FlatNode::Kind::NUL, 0, 0}, YAML::NullAnchor);
+      }
+
+      private:
+      //! A container whose children are still being parsed
+      struct Open
+      {
+        std::uint32_t entry;
+        std::size_t first_child;
+      };
+
+      bool expectsKey() const
+      {
+        return (!open.empty()) && (storage.entries[open.back().entry].kind == FlatNode::Kind::MAP) &&
+               ((children.size() - open.back().first_child) % 2 == 0);
+      }
+
+      void addScalar(const std::string& value, YAML::anchor_t anchor)
+      {
+        // Keys are interned, such that equal keys share a single node
+        if(expectsKey() && (anchor == YAML::NullAnchor))
+        {
+          auto key = key_nodes.find(value);
+          if(key != key_nodes.end())
+          {
+            addChild(key->second);
+            return;
+          }
+          const auto id = internKey(value);
+          addEntry({FlatNode::Kind::SCALAR, id, 0}, anchor);
+          key_nodes.emplace(value, static_cast<std::uint32_t>(storage.entries.size() - 1));
+          return;
+        }
+        storage.strings.push_back(value);
+        addEntry({FlatNode::Kind::SCALAR, static_cast<std::uint32_t>(storage.strings.size() - 1), 0}, anchor);
+      }
+
+      void addEntry(const FlatNode::Entry& entry, YAML::anchor_t anchor)
+      {
+        storage.entries.push_back(entry);
+        const auto index = static_cast<std::uint32_t>(storage.entries.size() - 1);
+        if(anchor != YAML::NullAnchor)
+          anchors[anchor] = index;
+        addChild(index);
+      }
+
+      void addChild(std::uint32_t index)
+      {
+        if(open.empty())
+          storage.root = index;
+        else
+          children.push_back(index);
+      }
+
+      void startContainer(FlatNode::Kind kind, YAML::anchor_t anchor)
+      {
+        addEntry({kind, 0, 0}, anchor);
+        open.push_back({static_cast<std::uint32_t>(storage.entries.size() - 1), children.size()});
+      }
+
+      void endContainer()
+      {
+        const auto container = open.back();
+        open.pop_back();
+        auto& entry = storage.entries[container.entry];
+        const auto begin = children.begin() + container.first_child;
+        if(entry.kind == FlatNode::Kind::SEQUENCE)
+        {
+          entry.first = static_cast<std::uint32_t>(storage.elements.size());
+          entry.size = static_cast<std::uint32_t>(children.end() - begin);
+          storage.elements.insert(storage.elements.end(), begin, children.end());
+        }
+        else
+        {
+          entry.first = static_cast<std::uint32_t>(storage.items.size());
+          entry.size = static_cast<std::uint32_t>((children.end() - begin) / 2);
+          for(auto child = begin; child + 1 < children.end(); child += 2)
+          {
+            storage.items.push_back({*child, *(child + 1)});
+            // Keys that are not scalars cannot be looked up and are sorted to the end of the index
+            const auto& key = storage.entries[*child];
+            std::uint32_t id = no_key;
+            if(key.kind == FlatNode::Kind::SCALAR)
+              id = internKey(storage.strings[key.first]);
+            storage.index.push_back({id, *(child + 1)});
+          }
+          // Keep the first of duplicate keys first, just like lookups in YAML::Node
+          std::stable_sort(storage.index.begin() + entry.first, storage.index.end(),
+                           [](const FlatNode::Item& a, const FlatNode::Item& b){ return a.key < b.key; });
+        }
+        children.erase(begin, children.end());
+      }
+
+      //! Get the string id of a mapping key, such that all equal keys share one string
+      std::uint32_t internKey(const std::string& key)
+      {
+        auto id = storage.key_ids.find(key);
+        if(id != storage.key_ids.end())
+          return id->second;
+        storage.strings.push_back(key);
+        const auto result = static_cast<std::uint32_t>(storage.strings.size() - 1);
+        storage.key_ids.emplace(key, result);
+        return result;
+      }
+
+      static constexpr std::uint32_t no_key = 0xffffffff;
+
+      FlatNode::Storage& storage;
+      std::vector<Open> open;
+      //! The children of all open containers, for mappings keys and values alternate
+      std::vector<std::uint32_t> children;
+      std::unordered_map<std::string, std::uint32_t> key_nodes;
+      std::unordered_map<YAML::anchor_t, std::uint32_t> anchors;
+    };
+
+    std::shared_ptr<FlatNode::Storage> storage;
+  };
+
+  //! The document traits of the flat document model
+  template<>
+  struct DocumentTraits<FlatNode>
+  {
+    static FlatNode undefined()
+    {
+      return FlatNode();
+    }
+
+    static bool is_defined(const FlatNode& node)
+    {
+      return node.isDefined();
+    }
+
+    static bool is_null(const FlatNode& node)
+    {
+      return node.isNull();
+    }
+
+    static bool is_scalar(const FlatNode& node)
+    {
+      return node.isScalar();
+    }
+
+    static bool is_sequence(const FlatNode& node)
+    {
+      return node.isSequence();
+    }
+
+    static bool is_map(const FlatNode& node)
+    {
+      return node.isMap();
+    }
+
+    static std::size_t size(const FlatNode& node)
+    {
+      return node.size();
+    }
+
+    static FlatNode lookup(const FlatNode& map, const std::string& key)
+    {
+      return map[key];
+    }
+
+    static FlatNode element(const FlatNode& sequence, std::size_t i)
+    {
+      return sequence[i];
+    }
+
+    template<typename F>
+    static void for_each_item(const FlatNode& map, F&& f)
+    {
+      map.forEachItem(std::forward<F>(f));
+    }
+
+    template<typename F>
+    static void for_each_element(const FlatNode& sequence, F&& f)
+    {
+      sequence.forEachElement(std::forward<F>(f));
+    }
+
+    static const std::string& scalar(const FlatNode& node)
+    {
+      return node.scalar();
+    }
+
+    static YAML::Node to_yaml(const FlatNode& node)
+    {
+      return node.toYaml();
+    }
+  };
+
+  //! The validator for flat documents
+  using FlatValidator = BasicValidator<FlatNode>;
+
+} // namespace cerberus
+
+#endif
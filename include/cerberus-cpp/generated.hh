@@ -0,0 +1,282 @@
+#ifndef CERBERUS_CPP_GENERATED_HH
+#define CERBERUS_CPP_GENERATED_HH
+
+#include<cerberus-cpp/document.hh>
+#include<cerberus-cpp/error.hh>
+#include<cerberus-cpp/stack.hh>
+
+#include<yaml-cpp/yaml.h>
+
+#include<cstddef>
+#include<initializer_list>
+#include<limits>
+#include<ostream>
+#include<regex>
+#include<string>
+#include<vector>
+
+namespace cerberus {
+
+  /** @brief Support code for validators generated by @c cerberus-codegen
+   *
+   * Generated validators consist of one function per schema item and
+   * dictionary schema, that apply the rules of the schema as straight-line
+   * code. This namespace provides the little state that they share at runtime.
+   * Schemas written with the compile-time DSL of @c cerberus-cpp/dsl.hh
+   * share it as well.
+   */
+  namespace generated {
+
+    /** @brief A subdocument together with how it was reached from the root
+     *
+     * Frames are linked to their parent frame on the call stack, so that
+     * error paths only need to be rendered when an error is raised.
+     */
+    template<typename Document>
+    struct Frame
+    {
+      enum Kind { DETACHED, ROOT, KEY, INDEX };
+
+      //! Construct the frame of the root document
+      explicit Frame(const Document& document)
+        : document(document), kind(ROOT)
+      {}
+
+      //! Construct the frame of a mapping entry
+      Frame(const Frame& parent, const char* key, std::size_t key_size, const Document& document)
+        : document(document), parent(&parent), kind(KEY), key(key), value(key_size)
+      {}
+
+      //! Construct the frame of a list entry
+      Frame(const Frame& parent, std::size_t index, const Document& document)
+        : document(document), parent(&parent), kind(INDEX), value(index)
+      {}
+
+      //! Construct the frame of a document that is not part of the path, e.g. a mapping key
+      Frame(const Frame& parent, const Document& document)
+        : document(document), parent(&parent), kind(DETACHED)
+      {}
+
+      //! The frame at a given level below this one, level 0 being this frame
+      const Frame* ancestor(std::size_t level) const
+      {
+        const Frame* frame = this;
+        for(; (frame != nullptr) && (level > 0); --level)
+          frame = frame->parent;
+        return frame;
+      }
+
+      //! The frame of the root document
+      const Frame& root() const
+      {
+        const Frame* frame = this;
+        while(frame->parent != nullptr)
+          frame = frame->parent;
+        return *frame;
+      }
+
+      //! Render the path of this frame just like the document stack does
+      std::string path() const
+      {
+        std::vector<const Frame*> frames;
+        for(const Frame* frame = this; frame != nullptr; frame = frame->parent)
+          frames.push_back(frame);
+
+        std::string result = "^";
+        for(auto it = frames.rbegin(); it != frames.rend(); ++it)
+        {
+          if((*it)->kind == KEY)
+          {
+            if(result.size() > 1)
+              result += '.';
+            result.append((*it)->key, (*it)->value);
+          }
+          if((*it)->kind == INDEX)
+          {
+            result += '[';
+            result += std::to_string((*it)->value);
+            result += ']';
+          }
+        }
+        return result;
+      }
+
+      Document document;
+      const Frame* parent = nullptr;
+      Kind kind;
+      const char* key = nullptr;
+      //! The length of the key for KEY, the list index for INDEX
+      std::size_t value = 0;
+    };
+
+    //! A step of a document path that was parsed by the generator
+    struct PathToken
+    {
+      bool is_index;
+      const char* key;
+      int index;
+    };
+
+    namespace impl {
+
+      template<typename Document, typename Tokens>
+      Document lookup_tokens(const Frame<Document>* start, const Tokens& tokens)
+      {
+        if(start == nullptr)
+          return document::undefined<Document>();
+        Document node = start->document;
+        for(const auto& token : tokens)
+        {
+          if((!document::is_defined(node)) || (token.is_index ? !document::is_sequence(node) : !document::is_map(node)))
+            return document::undefined<Document>();
+          Document next = token.is_index ? document::element(node, token.index) : document::lookup(node, std::string(token.key));
+          if(!document::is_defined(next))
+            return document::undefined<Document>();
+          cerberus::impl::rebind_document(node, next);
+        }
+        return node;
+      }
+
+    } // namespace impl
+
+    /** @brief Look up a document path relative to a frame
+     *
+     * This implements the lookups of @c BasicDocumentStack::pathLookup for paths
+     * that were parsed at generation time.
+     */
+    template<typename Document>
+    Document lookup_path(const Frame<Document>& frame, std::size_t level, bool absolute, std::initializer_list<PathToken> tokens)
+    {
+      return impl::lookup_tokens(absolute ? &frame.root() : frame.ancestor(level), tokens);
+    }
+
+    //! Look up a parsed document path relative to a frame
+    template<typename Document>
+    Document lookup_path(const Frame<Document>& frame, std::size_t level, const DocumentPath& path)
+    {
+      return impl::lookup_tokens(path.isAbsolute() ? &frame.root() : frame.ancestor(level), path.getTokens());
+    }
+
+    //! Decode a document with the conversion that the validator's types use
+    template<typename T, typename Document>
+    bool decode(const Document& node, T& value)
+    {
+      const auto& yaml = document::to_yaml(node);
+      return YAML::convert<T>::decode(yaml, value);
+    }
+
+    //! Whether a document converts to a type, which is how the @c type rule checks types
+    template<typename T, typename Document>
+    bool is_convertible(const Document& node)
+    {
+      T value;
+      return decode(node, value);
+    }
+
+    //! Decode a document as a string, which yields an empty string on failure just like @c TypeItem::equality
+    template<typename Document>
+    std::string as_string(const Document& node)
+    {
+      std::string value;
+      decode(node, value);
+      return value;
+    }
+
+    //! Compare a string against a literal, which may contain null characters
+    inline bool equals(const std::string& value, const char* literal, std::size_t size)
+    {
+      return (value.size() == size) && (value.compare(0, size, literal, size) == 0);
+    }
+
+    /** @brief The state of a single run of a generated validator
+     *
+     * This mirrors the policies and errors of the @c ValidationRuleInterface.
+     */
+    template<typename Document>
+    struct Context
+    {
+      void raiseError(const Frame<Document>& frame, const std::string& message)
+      {
+        errors.push_back({frame.path(), message});
+      }
+
+      bool allow_unknown = false;
+      bool require_all = false;
+      std::vector<ValidationErrorItem> errors;
+    };
+
+    /** @brief The interface of validators generated by @c cerberus-codegen
+     *
+     * Generated validators validate documents of any model with document
+     * traits just like a @c BasicValidator in @c ValidationMode::READ_ONLY
+     * does, i.e. normalization rules are not applied.
+     *
+     * @tparam Schema The generated class that implements the schema
+     */
+    template<typename Schema>
+    class Validator
+    {
+      public:
+      //! Set the policy regarding unknown values, see @c BasicValidator::setAllowUnknown
+      void setAllowUnknown(bool value)
+      {
+        allow_unknown = value;
+      }
+
+      //! Set the policy regarding missing values, see @c BasicValidator::setRequireAll
+      void setRequireAll(bool value)
+      {
+        require_all = value;
+      }
+
+      /** @brief Validate a document against the generated schema
+       *
+       * @param document The document to validate
+       * @returns Whether or not the validation process was successful
+       */
+      template<typename Document>
+      bool validate(const Document& document)
+      {
+        Context<Document> context;
+        context.allow_unknown = allow_unknown;
+        context.require_all = require_all;
+        Schema::validate(context, Frame<Document>(document));
+        errors = std::move(context.errors);
+        return errors.empty();
+      }
+
+      //! The errors found during the last validation
+      const std::vector<ValidationErrorItem>& getErrors() const
+      {
+        return errors;
+      }
+
+      //! Print errors to a stream in the format of the @c BasicValidator
+      template<typename Stream>
+      void printErrors(Stream& stream) const
+      {
+        for(const auto& error : errors)
+        {
+          stream << "Error validating data field " << error.path << "\n";
+          stream << "Message: " << error.message << "\n";
+        }
+      }
+
+      private:
+      bool allow_unknown = false;
+      bool require_all = false;
+      std::vector<ValidationErrorItem> errors;
+    };
+
+    template<typename Schema>
+    std::ostream& operator<<(std::ostream& stream, const Validator<Schema>& validator)
+    {
+      validator.printErrors(stream);
+      return stream;
+    }
+
+  } // namespace generated
+
+} // namespace cerberus
+
+#endif
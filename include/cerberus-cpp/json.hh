@@ -0,0 +1,390 @@
+#ifndef CERBERUS_CPP_JSON_HH
+#define CERBERUS_CPP_JSON_HH
+
+#include<cerberus-cpp/error.hh>
+
+#include<yaml-cpp/eventhandler.h>
+#include<yaml-cpp/yaml.h>
+
+#include<cstddef>
+#include<cstdint>
+#include<string>
+#include<vector>
+
+namespace cerberus {
+
+  /** @brief A fast parser for JSON text
+   *
+   * JSON is a subset of YAML, but the general YAML parser of yaml-cpp is slow
+   * on it. This self-contained parser only accepts strict JSON (RFC 8259) and
+   * reports the same events as @c YAML::Parser::HandleNextDocument, such that
+   * any @c YAML::EventHandler builds documents from it, e.g. the @c NodeBuilder
+   * or the builder of a @c FlatDocument. Strings are reported with the tag
+   * <tt>!</tt> and numbers and booleans with the tag <tt>?</tt>, just like quoted
+   * and plain scalars are reported by yaml-cpp. Numbers are passed on verbatim.
+   *
+   * The text is not copied, it needs to outlive the parser.
+   */
+  class JsonParser
+  {
+    public:
+    /** @brief Construct a parser for a piece of memory
+     *
+     * @param data The beginning of the text
+     * @param size The length of the text in bytes
+     */
+    JsonParser(const char* data, std::size_t size)
+      : begin(data), current(data), end(data + size), line_begin(data)
+    {}
+
+    //! Construct a parser for a string
+    explicit JsonParser(const std::string& text)
+      : JsonParser(text.data(), text.size())
+    {}
+
+    /** @brief Parse the text and pass its events to a handler
+     *
+     * The text needs to contain exactly one JSON value, surrounded by
+     * whitespace only.
+     *
+     * @throws JsonError if the text is not valid JSON
+     */
+    void parse(YAML::EventHandler& handler)
+    {
+      current = begin;
+      line = 1;
+      line_begin = begin;
+
+      skip_whitespace();
+      handler.OnDocumentStart(mark());
+
+      // The containers that are currently open, true for objects. Nesting is
+      // handled without recursion, so that deep documents cannot overflow the stack.
+      std::vector<bool> objects;
+      while(true)
+      {
+        // Parse a value, descending into containers until a leaf or an empty container is found
+        skip_whitespace();
+        if(current == end)
+          fail("Unexpected end of input, expected a value");
+        if(*current == '{')
+        {
+          handler.OnMapStart(mark(), "?", YAML::NullAnchor, YAML::EmitterStyle::Flow);
+          ++current;
+          skip_whitespace();
+          if((current == end) || (*current != '}'))
+          {
+            objects.push_back(true);
+            parse_key(handler);
+            continue;
+          }
+          ++current;
+          handler.OnMapEnd();
+        }
+        else if(*current == '[')
+        {
+          handler.OnSequenceStart(mark(), "?", YAML::NullAnchor, YAML::EmitterStyle::Flow);
+          ++current;
+          skip_whitespace();
+          if((current == end) || (*current != ']'))
+          {
+            objects.push_back(false);
+            continue;
+          }
+          ++current;
+          handler.OnSequenceEnd();
+        }
+        else
+          parse_leaf(handler);
+
+        // Close finished containers until the next value is expected
+        while(true)
+        {
+          skip_whitespace();
+          if(objects.empty())
+          {
+            if(current != end)
+              fail("Unexpected characters after the end of the document");
+            handler.OnDocumentEnd();
+            return;
+          }
+          const bool object = objects.back();
+          if(current == end)
+            fail(object ? "Unexpected end of input, expected ',' or '}'" : "Unexpected end of input, expected ',' or ']'");
+          if(*current == ',')
+          {
+            ++current;
+            if(object)
+              parse_key(handler);
+            break;
+          }
+          if(*current == (object ? '}' : ']'))
+          {
+            ++current;
+            if(object)
+              handler.OnMapEnd();
+            else
+              handler.OnSequenceEnd();
+            objects.pop_back();
+            continue;
+          }
+          fail(object ? "Expected ',' or '}'" : "Expected ',' or ']'");
+        }
+      }
+    }
+
+    private:
+    YAML::Mark mark() const
+    {
+      YAML::Mark m;
+      m.pos = static_cast<int>(current - begin);
+      m.line = static_cast<int>(line - 1);
+      m.column = static_cast<int>(current - line_begin);
+      return m;
+    }
+
+    [[noreturn]] void fail(const std::string& message) const
+    {
+      fail(message, current);
+    }
+
+    [[noreturn]] void fail(const std::string& message, const char* position) const
+    {
+      // Strings cannot contain line breaks, so the position is always on the current line
+      throw JsonError(message, line, static_cast<std::size_t>(position - line_begin) + 1, static_cast<std::size_t>(position - begin));
+    }
+
+    void skip_whitespace()
+    {
+      // Line breaks only occur in whitespace, so this is the only place that counts lines
+      while(current != end)
+      {
+        const char c = *current;
+        if(c == '\n')
+        {
+          ++line;
+          line_begin = current + 1;
+        }
+        else if((c != ' ') && (c != '\t') && (c != '\r'))
+          return;
+        ++current;
+      }
+    }
+
+    void parse_key(YAML::EventHandler& handler)
+    {
+      skip_whitespace();
+      if((current == end) || (*current != '"'))
+        fail("Expected a string as object key");
+      const auto key_mark = mark();
+      parse_string();
+      handler.OnScalar(key_mark, "!", YAML::NullAnchor, buffer);
+      skip_whitespace();
+      if((current == end) || (*current != ':'))
+        fail("Expected ':' after object key");
+      ++current;
+    }
+
+    void parse_leaf(YAML::EventHandler& handler)
+    {
+      const auto leaf_mark = mark();
+      switch(*current)
+      {
+        case '"':
+          parse_string();
+          handler.OnScalar(leaf_mark, "!", YAML::NullAnchor, buffer);
+          return;
+        case 't':
+          parse_literal("true");
+          handler.OnScalar(leaf_mark, "?", YAML::NullAnchor, buffer);
+          return;
+        case 'f':
+          parse_literal("false");
+          handler.OnScalar(leaf_mark, "?", YAML::NullAnchor, buffer);
+          return;
+        case 'n':
+          parse_literal("null");
+          handler.OnNull(leaf_mark, YAML::NullAnchor);
+          return;
+        default:
+          if((*current == '-') || is_digit(*current))
+          {
+            parse_number();
+            handler.OnScalar(leaf_mark, "?", YAML::NullAnchor, buffer);
+            return;
+          }
+          fail("Unexpected character, expected a value");
+      }
+    }
+
+    void parse_literal(const char* literal)
+    {
+      const char* start = current;
+      for(const char* c = literal; *c != '\0'; ++c, ++current)
+        if((current == end) || (*current != *c))
+          fail(std::string("Invalid literal, expected '") + literal + "'", start);
+      buffer.assign(start, current);
+    }
+
+    static bool is_digit(char c)
+    {
+      return (c >= '0') && (c <= '9');
+    }
+
+    void skip_digits()
+    {
+      if((current == end) || !is_digit(*current))
+        fail("Invalid number, expected a digit");
+      while((current != end) && is_digit(*current))
+        ++current;
+    }
+
+    void parse_number()
+    {
+      const char* start = current;
+      if(*current == '-')
+        ++current;
+      // Leading zeros are not allowed
+      if((current != end) && (*current == '0'))
+        ++current;
+      else
+        skip_digits();
+      if((current != end) && (*current == '.'))
+      {
+        ++current;
+        skip_digits();
+      }
+      if((current != end) && ((*current == 'e') || (*current == 'E')))
+      {
+        ++current;
+        if((current != end) && ((*current == '+') || (*current == '-')))
+          ++current;
+        skip_digits();
+      }
+      buffer.assign(start, current);
+    }
+
+    unsigned int parse_hex()
+    {
+      unsigned int value = 0;
+      for(int i = 0; i < 4; ++i, ++current)
+      {
+        if(current == end)
+          fail("Unexpected end of input in unicode escape");
+        const char c = *current;
+        value <<= 4;
+        if(is_digit(c))
+          value |= static_cast<unsigned int>(c - '0');
+        else if((c >= 'a') && (c <= 'f'))
+          value |= static_cast<unsigned int>(c - 'a' + 10);
+        else if((c >= 'A') && (c <= 'F'))
+          value |= static_cast<unsigned int>(c - 'A' + 10);
+        else
+          fail("Invalid unicode escape, expected a hexadecimal digit");
+      }
+      return value;
+    }
+
+    void append_utf8(std::uint32_t code)
+    {
+      if(code < 0x80)
+        buffer.push_back(static_cast<char>(code));
+      else if(code < 0x800)
+      {
+        buffer.push_back(static_cast<char>(0xC0 | (code >> 6)));
+        buffer.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+      }
+      else if(code < 0x10000)
+      {
+        buffer.push_back(static_cast<char>(0xE0 | (code >> 12)));
+        buffer.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        buffer.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+      }
+      else
+      {
+        buffer.push_back(static_cast<char>(0xF0 | (code >> 18)));
+        buffer.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+        buffer.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+        buffer.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+      }
+    }
+
+    void parse_escape()
+    {
+      const char* start = current;
+      ++current;
+      if(current == end)
+        fail("Unexpected end of input in escape sequence");
+      switch(*current++)
+      {
+        case '"': buffer.push_back('"'); return;
+        case '\\': buffer.push_back('\\'); return;
+        case '/': buffer.push_back('/'); return;
+        case 'b': buffer.push_back('\b'); return;
+        case 'f': buffer.push_back('\f'); return;
+        case 'n': buffer.push_back('\n'); return;
+        case 'r': buffer.push_back('\r'); return;
+        case 't': buffer.push_back('\t'); return;
+        case 'u':
+        {
+          std::uint32_t code = parse_hex();
+          if((code >= 0xDC00) && (code <= 0xDFFF))
+            fail("Invalid unicode escape, unexpected low surrogate", start);
+          if((code >= 0xD800) && (code <= 0xDBFF))
+          {
+            // Characters outside the basic multilingual plane are escaped as surrogate pairs
+            if((end - current < 2) || (current[0] != '\\') || (current[1] != 'u'))
+              fail("Invalid unicode escape, expected a low surrogate", start);
+            current += 2;
+            const std::uint32_t low = parse_hex();
+            if((low < 0xDC00) || (low > 0xDFFF))
+              fail("Invalid unicode escape, expected a low surrogate", start);
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+          }
+          append_utf8(code);
+          return;
+        }
+        default:
+          fail("Invalid escape sequence", start);
+      }
+    }
+
+    void parse_string()
+    {
+      // Skip the opening quote
+      ++current;
+      buffer.clear();
+      while(true)
+      {
+        // Copy runs of ordinary characters at once
+        const char* start = current;
+        while((current != end) && (*current != '"') && (*current != '\\') && (static_cast<unsigned char>(*current) >= 0x20))
+          ++current;
+        buffer.append(start, current);
+
+        if(current == end)
+          fail("Unexpected end of input in string");
+        if(*current == '"')
+        {
+          ++current;
+          return;
+        }
+        if(*current == '\\')
+          parse_escape();
+        else
+          fail("Unescaped control character in string");
+      }
+    }
+
+    const char* begin;
+    const char* current;
+    const char* end;
+    std::size_t line = 1;
+    const char* line_begin;
+    // Holds the text of the last scalar, reused to avoid allocations
+    std::string buffer;
+  };
+
+} // namespace cerberus
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef CERBERUS_CPP_PROFILE_HH
+#define CERBERUS_CPP_PROFILE_HH
+
+#include<cerberus-cpp/compiled.hh>
+#include<cerberus-cpp/rules.hh>
+
+#include<algorithm>
+#include<array>
+#include<chrono>
+#include<cstddef>
+#include<iomanip>
+#include<map>
+#include<ostream>
+#include<string>
+#include<vector>
+
+namespace cerberus {
+
+  //! The name of a rule priority as used in reports
+  inline const char* priorityName(RulePriority priority)
+  {
+    switch(priority)
+    {
+      case RulePriority::FIRST:
+        return "FIRST";
+      case RulePriority::NORMALIZATION:
+        return "NORMALIZATION";
+      case RulePriority::VALIDATION:
+        return "VALIDATION";
+      case RulePriority::TYPECHECKING:
+        return "TYPECHECKING";
+      case RulePriority::POST_NORMALIZATION:
+        return "POST_NORMALIZATION";
+      case RulePriority::LAST:
+        return "LAST";
+    }
+    return "UNKNOWN";
+  }
+
+  //! The timings of a single rule as recorded by a @c ValidationProfile
+  struct RuleProfile
+  {
+    //! The name of the rule
+    std::string rule;
+    //! The priority that the rule was registered with
+    RulePriority priority = RulePriority::VALIDATION;
+    //! The number of invocations of the rule
+    std::size_t count = 0;
+    //! The cumulative wall time of all invocations, including the validation of subdocuments
+    std::chrono::nanoseconds total{0};
+    //! The wall time of the slowest invocation
+    std::chrono::nanoseconds max{0};
+    //! The path of the document item of the slowest invocation, e.g. @c ^users[3].name
+    std::string slowest_path;
+    //! The location of the rule in the schema of the slowest invocation, e.g. @c ^users.schema.schema.name.regex
+    std::string slowest_schema_path;
+  };
+
+  /** @brief A report of the time spent in each rule during validation
+   *
+   * Profiles are recorded by validators if cerberus-cpp is compiled with
+   * @c CERBERUS_CPP_PROFILING defined and profiling is enabled with
+   * @c Validator::setProfiling. Without the definition, no profiling code
+   * is compiled into the validator at all and profiles stay empty. Rules
+   * are identified by their name and priority. Times are inclusive, i.e.
+   * the time of a @c schema rule includes the time of the rules that it
+   * applies to the subdocument.
+   */
+  class ValidationProfile
+  {
+    public:
+    /** @brief Record an invocation of a rule
+     *
+     * @param priority The priority of the rule
+     * @param rule The name of the rule
+     * @param duration The wall time of the invocation
+     * @param path A callable returning the document path of the invocation,
+     *             which is only called if the invocation is the slowest so far.
+     * @param schema_path A callable returning the location of the rule in the schema,
+     *                    which is only called if the invocation is the slowest so far.
+     */
+    template<typename Path, typename SchemaPath>
+    void record(RulePriority priority, const std::string& rule, std::chrono::nanoseconds duration, Path&& path, SchemaPath&& schema_path)
+    {
+      auto& bucket = rules[static_cast<std::size_t>(priority)];
+      auto entry = bucket.find(rule);
+      if(entry == bucket.end())
+      {
+        RuleProfile profile;
+        profile.rule = rule;
+        profile.priority = priority;
+        entry = bucket.emplace(rule, std::move(profile)).first;
+      }
+
+      auto& profile = entry->second;
+      ++profile.count;
+      profile.total += duration;
+      if((profile.count == 1) || (duration > profile.max))
+      {
+        profile.max = duration;
+        profile.slowest_path = path();
+        profile.slowest_schema_path = schema_path();
+      }
+    }
+
+    //! Add the invocations recorded in another profile to this one
+    void merge(const ValidationProfile& other)
+    {
+      for(std::size_t priority = 0; priority < RulePriorityCount; ++priority)
+        for(const auto& entry : other.rules[priority])
+        {
+          auto inserted = rules[priority].emplace(entry.first, entry.second);
+          if(inserted.second)
+            continue;
+          auto& profile = inserted.first->second;
+          profile.count += entry.second.count;
+          profile.total += entry.second.total;
+          if(entry.second.max > profile.max)
+          {
+            profile.max = entry.second.max;
+            profile.slowest_path = entry.second.slowest_path;
+            profile.slowest_schema_path = entry.second.slowest_schema_path;
+          }
+        }
+    }
+
+    //! Drop all recorded invocations
+    void clear()
+    {
+      for(auto& bucket : rules)
+        bucket.clear();
+    }
+
+    //! Whether no invocations were recorded
+    bool empty() const
+    {
+      return std::all_of(rules.begin(), rules.end(), [](const auto& bucket){ return bucket.empty(); });
+    }
+
+    //! The profiles of all invoked rules, the rule with the largest cumulative time first
+    std::vector<RuleProfile> entries() const
+    {
+      std::vector<RuleProfile> result;
+      for(const auto& bucket : rules)
+        for(const auto& entry : bucket)
+          result.push_back(entry.second);
+      std::stable_sort(result.begin(), result.end(), [](const auto& a, const auto& b){ return a.total > b.total; });
+      return result;
+    }
+
+    /** @brief Get the profile of a given rule
+     *
+     * @param rule The name of the rule
+     * @param priority The priority of the rule
+     * @returns A pointer to the profile or @c nullptr if the rule was not invoked
+     */
+    const RuleProfile* find(const std::string& rule, RulePriority priority = RulePriority::VALIDATION) const
+    {
+      const auto& bucket = rules[static_cast<std::size_t>(priority)];
+      auto entry = bucket.find(rule);
+      if(entry == bucket.end())
+        return nullptr;
+      return &(entry->second);
+    }
+
+    //! Print the profile as a table to a stream
+    void print(std::ostream& stream) const
+    {
+      stream << std::left << std::setw(16) << "rule" << std::setw(20) << "priority" << std::right
+             << std::setw(10) << "count" << std::setw(14) << "total [us]" << std::setw(14) << "max [us]"
+             << "  slowest path (document / schema)\n";
+      for(const auto& profile : entries())
+        stream << std::left << std::setw(16) << profile.rule << std::setw(20) << priorityName(profile.priority) << std::right
+               << std::setw(10) << profile.count
+               << std::setw(14) << std::chrono::duration<double, std::micro>(profile.total).count()
+               << std::setw(14) << std::chrono::duration<double, std::micro>(profile.max).count()
+               << "  " << profile.slowest_path << " / " << profile.slowest_schema_path << "\n";
+    }
+
+    private:
+    std::array<std::map<std::string, RuleProfile, std::less<>>, RulePriorityCount> rules;
+  };
+
+  //! Print a profile to a stream
+  inline std::ostream& operator<<(std::ostream& stream, const ValidationProfile& profile)
+  {
+    profile.print(stream);
+    return stream;
+  }
+
+} // namespace cerberus
+
+#endif
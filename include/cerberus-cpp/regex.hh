@@ -0,0 +1,148 @@
+#ifndef CERBERUS_CPP_REGEX_HH
+#define CERBERUS_CPP_REGEX_HH
+
+#include<deque>
+#include<memory>
+#include<mutex>
+#include<regex>
+#include<string>
+#include<unordered_map>
+
+namespace cerberus {
+
+  /** @brief A bounded cache of compiled regular expressions
+   *
+   * Constructing a @c std::regex is expensive. This cache makes sure that
+   * each pattern is only compiled once, even if it is used in many schemas.
+   * Each @c Validator instance holds such a cache, which is used when
+   * compiling the @c regex rule. All methods are safe to be called
+   * concurrently.
+   */
+  class RegexCache
+  {
+    public:
+    /** @brief Construct a regex cache
+     *
+     * @param capacity The maximum number of patterns kept in the cache
+     */
+    explicit RegexCache(std::size_t capacity = 128)
+      : capacity(capacity)
+    {}
+
+    //! Copy the cached regular expressions of another cache
+    RegexCache(const RegexCache& other)
+    {
+      std::lock_guard<std::mutex> lock(other.mutex);
+      capacity = other.capacity;
+      regexes = other.regexes;
+      order = other.order;
+      hit_count = other.hit_count;
+      miss_count = other.miss_count;
+    }
+
+    //! Copy the cached regular expressions of another cache
+    RegexCache& operator=(const RegexCache& other)
+    {
+      if(this != &other)
+      {
+        RegexCache copy(other);
+        std::lock_guard<std::mutex> lock(mutex);
+        capacity = copy.capacity;
+        regexes = std::move(copy.regexes);
+        order = std::move(copy.order);
+        hit_count = copy.hit_count;
+        miss_count = copy.miss_count;
+      }
+      return *this;
+    }
+
+    /** @brief Get the compiled regular expression for a given pattern
+     *
+     * @param pattern The pattern to compile
+     * @returns A shared pointer to the compiled regular expression, which
+     *          stays valid even if the pattern is dropped from the cache.
+     */
+    std::shared_ptr<const std::regex> get(const std::string& pattern)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      auto cached = regexes.find(pattern);
+      if(cached != regexes.end())
+      {
+        ++hit_count;
+        return cached->second;
+      }
+
+      ++miss_count;
+      auto regex = std::make_shared<const std::regex>(pattern);
+      while((!order.empty()) && (order.size() >= capacity))
+      {
+        regexes.erase(order.front());
+        order.pop_front();
+      }
+      if(capacity > 0)
+      {
+        order.push_back(pattern);
+        regexes.emplace(pattern, regex);
+      }
+      return regex;
+    }
+
+    //! The number of lookups that found a compiled regular expression in the cache
+    std::size_t hits() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return hit_count;
+    }
+
+    //! The number of lookups that needed to compile a regular expression
+    std::size_t misses() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return miss_count;
+    }
+
+    //! The number of patterns currently in the cache
+    std::size_t size() const
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      return regexes.size();
+    }
+
+    /** @brief Set the maximum number of patterns kept in the cache
+     *
+     * If the limit is exceeded, the oldest patterns are dropped.
+     */
+    void setCapacity(std::size_t value)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      capacity = value;
+      clearUnlocked();
+    }
+
+    //! Drop all patterns and reset the counters
+    void clear()
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      clearUnlocked();
+    }
+
+    private:
+    void clearUnlocked()
+    {
+      regexes.clear();
+      order.clear();
+      hit_count = 0;
+      miss_count = 0;
+    }
+
+    mutable std::mutex mutex;
+    std::size_t capacity;
+    std::unordered_map<std::string, std::shared_ptr<const std::regex>> regexes;
+    std::deque<std::string> order;
+    std::size_t hit_count = 0;
+    std::size_t miss_count = 0;
+  };
+
+} // namespace cerberus
+
+#endif
@@ -1,12 +1,18 @@
 #ifndef CERBERUS_CPP_RULES_HH
 #define CERBERUS_CPP_RULES_HH
 
+#include<cerberus-cpp/document.hh>
+#include<cerberus-cpp/stack.hh>
+#include<cerberus-cpp/types.hh>
+
 #include<yaml-cpp/yaml.h>
 
 #include<algorithm>
+#include<cstddef>
 #include<memory>
 #include<regex>
 #include<string>
+#include<type_traits>
 #include<vector>
 
 #include<iostream>
@@ -32,6 +38,10 @@ namespace cerberus {
 
   namespace impl {
 
+    //! The type of compiled subschemas that a rule interface or schema compiler deals with
+    template<typename V>
+    using Subschemas = typename std::decay_t<V>::CompiledSchema::Subschemas;
+
     //! A small helper that allows unified treatment of scalars and lists
     std::vector<YAML::Node> as_list(const YAML::Node& node)
     {
@@ -44,20 +54,93 @@ namespace cerberus {
       return result;
     }
 
+    /** @brief Decode the list argument of e.g. the @c allowed rule into a value set
+     *
+     * The set is built with the type given in the same schema. If that is not known
+     * at compile time or if the type does not support value sets, an empty pointer
+     * is returned.
+     */
+    template<typename Compiler>
+    std::shared_ptr<const ValueSetBase> prepare_value_set(Compiler& c)
+    {
+      const auto& type = c.getType(1);
+      if(!type)
+        return nullptr;
+      return type->make_value_set(as_list(c.getSchema()));
+    }
+
+    /** @brief Find the document in the list argument of e.g. the @c allowed rule
+     *
+     * @returns The index of the matching list entry or -1
+     */
+    template<typename V>
+    int find_value(V& v)
+    {
+      const auto& set = v.template getPreparedArgument<std::shared_ptr<const ValueSetBase>>();
+      const auto doc = v.getDocument();
+      const auto& value = document::to_yaml(doc);
+      if(set)
+        return set->find(value);
+
+      // Fall back to pairwise comparison for types that do not provide value sets
+      auto type = v.getType(1);
+      int index = 0;
+      for(const auto& item: v.getSchema())
+      {
+        if(type->equality(item, value))
+          return index;
+        ++index;
+      }
+      return -1;
+    }
+
+    /** @brief Decode the scalar argument of e.g. the @c min rule into a constant
+     *
+     * The constant is decoded with the type given in the same schema. If that is not
+     * known at compile time or if the type does not support constants, an empty pointer
+     * is returned.
+     */
+    template<typename Compiler>
+    std::shared_ptr<const ConstantBase> prepare_constant(Compiler& c)
+    {
+      const auto& type = c.getType(1);
+      if(!type)
+        return nullptr;
+      return type->decode_constant(c.getSchema());
+    }
+
+    //! Compare the document against the scalar argument of e.g. the @c min rule
+    template<typename V>
+    Ordering compare_constant(V& v)
+    {
+      auto type = v.getType(1);
+      const auto& constant = v.template getPreparedArgument<std::shared_ptr<const ConstantBase>>();
+      const auto doc = v.getDocument();
+      const auto& value = document::to_yaml(doc);
+      if(constant)
+        return type->compare(value, *constant);
+
+      // Fall back to comparisons that decode the schema for types that do not provide constants
+      if(type->less(value, v.getSchema()))
+        return Ordering::LESS;
+      if(type->less(v.getSchema(), value))
+        return Ordering::GREATER;
+      if(type->equality(value, v.getSchema()))
+        return Ordering::EQUAL;
+      return Ordering::UNORDERED;
+    }
+
     template<typename Validator>
     void allow_unknown_rule(Validator& validator)
     {
-      auto state = std::make_shared<std::vector<bool>>();
-
       validator.registerRule(
         YAML::Load(
           "allow_unknown:\n"
           " type: boolean"
         ),
-        [state](auto& v)
+        [](auto& v)
         {
-          state->push_back(v.getAllowUnknown());
-          v.setAllowUnknown(v.getSchema().template as<bool>());
+          v.pushAllowUnknown(v.getSchema().template as<bool>());
         },
         RulePriority::FIRST
       );
@@ -67,10 +150,9 @@ namespace cerberus {
           "allow_unknown:\n"
           " type: boolean"
         ),
-        [state](auto& v)
+        [](auto& v)
         {
-          v.setAllowUnknown(state->back());
-          state->pop_back();
+          v.popAllowUnknown();
         },
         RulePriority::LAST
       );
@@ -86,17 +168,15 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          // Extract type information from the larger schema
-          auto type = v.getType(1);
-          bool found = false;
-          for(const auto& item: v.getSchema())
-            if (type->equality(item, v.getDocument()))
-              found = true;
-          
-          if(!found)
+          if(find_value(v) < 0)
             v.raiseError("Value disallowed by Allowed-Rule!");
-        }
-      ); 
+        },
+        [](auto& c)
+        {
+          return prepare_value_set(c);
+        },
+        RulePriority::VALIDATION
+      );
     }
 
     template<typename Validator>
@@ -112,12 +192,15 @@ namespace cerberus {
         [](auto& v)
         {
           auto needed = as_list(v.getSchema());
-          for(const auto& item: v.getDocument())
+          document::for_each_element(v.getDocument(), [&v, &needed](const auto& element)
+          {
+            const auto& item = document::to_yaml(element);
             for(auto it = needed.begin(); it != needed.end();)
               if (v.getType("string")->equality(*it, item))
                 it = needed.erase(it);
               else
                 ++it;
+          });
 
           if(!needed.empty())
             v.raiseError("Contains-Rule violated");
@@ -133,13 +216,24 @@ namespace cerberus {
         YAML::Load("default: {}"),
         [](auto& v)
         {
-          if(!v.getDocument().IsDefined())
-            v.getDocument() = v.getSchema();
+          // Only request the document for writing, if it is actually altered
+          // The default is cloned, assigning it would tie the document's memory to the schema's
+          if(!document::is_defined(v.getDocumentStack().get()))
+            impl::assign_document(v.getWritableDocument(), YAML::Clone(v.getSchema()));
         },
         RulePriority::NORMALIZATION
       );
     }
 
+    //! The decoded argument of the dependencies rule
+    struct DependenciesRuleArgument
+    {
+      //! Whether the dependencies were given as a mapping of paths to values
+      bool mapping = false;
+      std::vector<DocumentPath> paths;
+      std::vector<std::vector<YAML::Node>> values;
+    };
+
     template<typename Validator>
     void dependencies_rule(Validator& validator)
     {
@@ -150,39 +244,53 @@ namespace cerberus {
         [](auto& v)
         {
           // If the field is not defined, the dependency is also not necessary!
-          if(!v.getDocument().IsDefined())
+          if(!document::is_defined(v.getDocument()))
             return;
 
-          if(v.getSchema().IsMap())
+          const auto& deps = v.template getPreparedArgument<DependenciesRuleArgument>();
+          for(std::size_t i = 0; i < deps.paths.size(); ++i)
           {
-            for(auto dep: v.getSchema())
+            const auto& dep = deps.paths[i];
+            auto lookup = v.getDocumentPath(dep, 1);
+            if(!document::is_defined(lookup))
+              v.raiseError("dependencies-Rule violated: " + dep.str() + " required!");
+
+            if(!deps.mapping)
+              continue;
+
+            const auto& possible = deps.values[i];
+            bool found = false;
+            for (auto val : possible)
+              if(v.getType("string")->equality(document::to_yaml(lookup), val))
+                found = true;
+
+            if(!found)
             {
-              auto lookup = v.getDocumentPath(dep.first.template as<std::string>(), 1);
-              if(!lookup.IsDefined())
-                v.raiseError("dependencies-Rule violated: " + dep.first.template as<std::string>() + " required!");
-
-              auto possible = as_list(dep.second);
-              bool found = false;
-              for (auto val : possible)
-                if(v.getType("string")->equality(lookup, val))
-                  found = true;
-
-              if(!found)
-              {
-                std::string options;
-                for(auto o: possible)
-                  options = options + o.template as<std::string>() + ", ";
-                v.raiseError("dependencies-Rule violated: " + dep.first.template as<std::string>() + " requires value out of [" + options + "]");
-              }
+              std::string options;
+              for(auto o: possible)
+                options = options + o.template as<std::string>() + ", ";
+              v.raiseError("dependencies-Rule violated: " + dep.str() + " requires value out of [" + options + "]");
             }
-            return;
           }
-          
-          auto deplist = as_list(v.getSchema());
-          for(auto dep: deplist)
-            if(!v.getDocumentPath(dep.template as<std::string>(), 1).IsDefined())
-              v.raiseError("dependencies-Rule violated: " + dep.template as<std::string>() + " required!");
-        }
+        },
+        [](auto& c)
+        {
+          DependenciesRuleArgument deps;
+          if(c.getSchema().IsMap())
+          {
+            deps.mapping = true;
+            for(auto dep: c.getSchema())
+            {
+              deps.paths.emplace_back(dep.first.template as<std::string>());
+              deps.values.push_back(as_list(dep.second));
+            }
+          }
+          else
+            for(auto dep: as_list(c.getSchema()))
+              deps.paths.emplace_back(dep.template as<std::string>());
+          return deps;
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -196,7 +304,7 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          if((v.getDocument().IsSequence()) && (!v.getSchema().template as<bool>()) && (v.getDocument().size() == 0))
+          if((document::is_sequence(v.getDocument())) && (!v.getSchema().template as<bool>()) && (document::size(v.getDocument()) == 0))
             v.raiseError("Empty-Rule violated for sequence");
         }
       );
@@ -215,14 +323,21 @@ namespace cerberus {
         [](auto& v)
         {
           // If the field is not defined, the exclusion is also not necessary!
-          if(!v.getDocument().IsDefined())
+          if(!document::is_defined(v.getDocument()))
             return;
 
-          auto exclist = as_list(v.getSchema());
-          for(auto exc: exclist)
-            if(v.getDocumentPath(exc.template as<std::string>(), 1).IsDefined())
-              v.raiseError("excludes-Rule violated: " + exc.template as<std::string>() + " is not allowed!");
-        }
+          for(const auto& exc: v.template getPreparedArgument<std::vector<DocumentPath>>())
+            if(document::is_defined(v.getDocumentPath(exc, 1)))
+              v.raiseError("excludes-Rule violated: " + exc.str() + " is not allowed!");
+        },
+        [](auto& c)
+        {
+          std::vector<DocumentPath> exclist;
+          for(auto exc: as_list(c.getSchema()))
+            exclist.emplace_back(exc.template as<std::string>());
+          return exclist;
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -236,10 +351,18 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          for(const auto& item: v.getSchema())
-            if (v.getType(1)->equality(item, v.getDocument()))
-              v.raiseError("Forbidden-Rule violated: " + item.template as<std::string>());
-        }
+          auto index = find_value(v);
+          if(index >= 0)
+          {
+            const YAML::Node schema = v.getSchema();
+            v.raiseError("Forbidden-Rule violated: " + schema[index].template as<std::string>());
+          }
+        },
+        [](auto& c)
+        {
+          return prepare_value_set(c);
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -253,17 +376,22 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          auto schemait = v.getSchema().begin();
-          auto datait = v.getDocument().begin();
-          while (schemait != v.getSchema().end())
+          const auto& subschemas = v.template getPreparedArgument<Subschemas<decltype(v)>>();
+          v.validateElements(subschemas.items.size(), [&subschemas](auto& context, std::size_t i)
           {
-            v.getDocumentStack().push_back(*(datait++));
-            v.getSchemaStack().push_back(*(schemait++));
-            v.validateItem(v.getSchema(0, true));
-            v.getSchemaStack().pop_back();
-            v.getDocumentStack().pop_back();
-          }
-        }
+            context.getDocumentStack().pushListItem(i);
+            context.validateItem(*subschemas.items[i]);
+            context.getDocumentStack().pop();
+          });
+        },
+        [](auto& c)
+        {
+          Subschemas<decltype(c)> subschemas;
+          for(auto item : c.getSchema())
+            subschemas.items.push_back(c.compileItem(item));
+          return subschemas;
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -277,13 +405,23 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          for(auto item: v.getDocument())
+          const auto& subschemas = v.template getPreparedArgument<Subschemas<decltype(v)>>();
+          document::for_each_item(v.getDocument(), [&v, &subschemas](const auto& key, const auto&)
           {
-            v.getDocumentStack().push_back(item.first);
-            v.validateItem(v.getSchema());
+            if(v.isAborted())
+              return;
+            v.getDocumentStack().push_back(key);
+            v.validateItem(*subschemas.items.front());
             v.getDocumentStack().pop_back();
-          }
-        }
+          });
+        },
+        [](auto& c)
+        {
+          Subschemas<decltype(c)> subschemas;
+          subschemas.items.push_back(c.compileItem(c.getSchema()));
+          return subschemas;
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -307,15 +445,18 @@ namespace cerberus {
         YAML::Load("max: {}"),
         [](auto& v)
         {
-          if(!v.getDocument().IsDefined())
+          if(!document::is_defined(v.getDocument()))
             return;
 
-          // Extract type information from the larger schema
-          auto type = v.getType(1);
-
-          if((type->less(v.getSchema(), v.getDocument())) || (type->equality(v.getDocument(), v.getSchema())))
+          auto order = compare_constant(v);
+          if((order == Ordering::GREATER) || (order == Ordering::EQUAL))
             v.raiseError("Max-Rrule violated!");
-        }
+        },
+        [](auto& c)
+        {
+          return prepare_constant(c);
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -326,15 +467,17 @@ namespace cerberus {
         YAML::Load("min: {}"),
         [](auto& v)
         {
-          if(!v.getDocument().IsDefined())
+          if(!document::is_defined(v.getDocument()))
             return;
 
-          // Extract type information from the larger schema
-          auto type = v.getType(1);
-
-          if(!(type->less(v.getSchema(), v.getDocument())))
+          if(compare_constant(v) != Ordering::GREATER)
             v.raiseError("Min-Rule violated!");
-        }
+        },
+        [](auto& c)
+        {
+          return prepare_constant(c);
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -353,12 +496,14 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          unsigned int count = 0;
-          for(auto item: v.getDocument())
-            ++count;
-          if(count > v.getSchema().template as<int>())
+          if(document::size(v.getDocument()) > v.template getPreparedArgument<std::size_t>())
             v.raiseError("Maxlength-Rule violated!");
-        }
+        },
+        [](auto& c)
+        {
+          return c.getSchema().template as<std::size_t>();
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -377,12 +522,14 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          unsigned int count = 0;
-          for(auto item: v.getDocument())
-            ++count;
-          if(count < v.getSchema().template as<int>())
+          if(document::size(v.getDocument()) < v.template getPreparedArgument<std::size_t>())
             v.raiseError("Minlength-Rule violated!");
-        }
+        },
+        [](auto& c)
+        {
+          return c.getSchema().template as<std::size_t>();
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -397,7 +544,7 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          if ((!v.getSchema().template as<bool>()) && (v.getDocument().IsNull()))
+          if ((!v.getSchema().template as<bool>()) && (document::is_null(v.getDocument())))
             v.raiseError("Nullable-Rule violated!");
         }
       );
@@ -406,17 +553,14 @@ namespace cerberus {
     template<typename Validator>
     void purge_unknown_rule(Validator& validator)
     {
-      auto state = std::make_shared<std::vector<bool>>();
-
       validator.registerRule(
         YAML::Load(
           "purge_unknown:\n"
           " type: boolean"
         ),
-        [state](auto& v)
+        [](auto& v)
         {
-          state->push_back(v.getPurgeUnknown());
-          v.setPurgeUnknown(v.getSchema().template as<bool>());
+          v.pushPurgeUnknown(v.getSchema().template as<bool>());
         },
         RulePriority::FIRST
       );
@@ -426,10 +570,9 @@ namespace cerberus {
           "purge_unknown:\n"
           " type: boolean"
         ),
-        [state](auto& v)
+        [](auto& v)
         {
-          v.setPurgeUnknown(state->back());
-          state->pop_back();
+          v.popPurgeUnknown();
         },
         RulePriority::LAST
       );
@@ -445,9 +588,15 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          if(!std::regex_match(v.getDocument().template as<std::string>(), std::regex(v.getSchema().template as<std::string>())))
+          const auto& regex = v.template getPreparedArgument<std::shared_ptr<const std::regex>>();
+          if(!std::regex_match(document::to_yaml(v.getDocument()).template as<std::string>(), *regex))
             v.raiseError("Regex-Rule violated!");
-        }
+        },
+        [](auto& c)
+        {
+          return c.getRegex(c.getSchema().template as<std::string>());
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -471,17 +620,14 @@ namespace cerberus {
     template<typename Validator>
     void require_all_rule(Validator& validator)
     {
-      auto state = std::make_shared<std::vector<bool>>();
-
       validator.registerRule(
         YAML::Load(
           "require_all:\n"
           " type: boolean"
         ),
-        [state](auto& v)
+        [](auto& v)
         {
-          state->push_back(v.getRequireAll());
-          v.setRequireAll(v.getSchema().template as<bool>());
+          v.pushRequireAll(v.getSchema().template as<bool>());
         },
         RulePriority::FIRST
       );
@@ -491,10 +637,9 @@ namespace cerberus {
           "require_all:\n"
           " type: boolean"
         ),
-        [state](auto& v)
+        [](auto& v)
         {
-          v.setRequireAll(state->back());
-          state->pop_back();
+          v.popRequireAll();
         },
         RulePriority::LAST
       );
@@ -510,7 +655,7 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          if((v.getSchema().template as<bool>()) && (!v.getDocument().IsDefined()))
+          if((v.getSchema().template as<bool>()) && (!document::is_defined(v.getDocument())))
             v.raiseError("Required-Rule violated!");
         }
       );
@@ -535,43 +680,69 @@ namespace cerberus {
           // Detect whether this is the schema(list) or schema(dict) rule by investigating
           // either the type information explicitly given or looking at the given data
           SchemaRuleType subrule = SchemaRuleType::UNSUPPORTED;
-          auto typenode = v.getSchema(1)["type"];
-          if(typenode)
+          const auto& subschemas = v.template getPreparedArgument<Subschemas<decltype(v)>>();
+          if(subschemas.dict && subschemas.items.empty())
+            subrule = SchemaRuleType::DICT;
+          else if(!subschemas.dict && !subschemas.items.empty())
+            subrule = SchemaRuleType::LIST;
+          else if(subschemas.dict)
           {
-            auto type = typenode.template as<std::string>();
-            if(type == "dict")
+            if(document::is_map(v.getDocument()))
               subrule = SchemaRuleType::DICT;
-            if(type == "list")
-              subrule = SchemaRuleType::LIST;
-          }
-          else
-          {
-            if(v.getDocument().IsMap())
-              subrule = SchemaRuleType::DICT;
-            if(v.getDocument().IsSequence())
+            if(document::is_sequence(v.getDocument()))
               subrule = SchemaRuleType::LIST;
           }
 
           if(subrule == SchemaRuleType::DICT)
           {
-            v.validateDict(v.getSchema(0, true));
+            v.validateDict(*subschemas.dict);
           }
           if(subrule == SchemaRuleType::LIST)
           {
-            for(std::size_t counter = 0; counter < v.getDocument().size(); ++counter)
+            v.validateElements(document::size(v.getDocument()), [&subschemas](auto& context, std::size_t i)
             {
-              v.getDocumentStack().pushListItem(counter);
-              v.validateItem(v.getSchema(0, true));
-              v.getDocumentStack().pop();
-            }
-
+              context.getDocumentStack().pushListItem(i);
+              context.validateItem(*subschemas.items.front());
+              context.getDocumentStack().pop();
+            });
           }
           if(subrule == SchemaRuleType::UNSUPPORTED)
             v.raiseError("Schema-Rule is only available for type=dict|list");
-        }
+        },
+        [](auto& c)
+        {
+          // Compile the subschema for the schema(list) and/or schema(dict) rule depending
+          // on the type information explicitly given. Without it, the decision is made
+          // when looking at the given data.
+          Subschemas<decltype(c)> subschemas;
+          auto typenode = c.getSchema(1)["type"];
+          if(typenode)
+          {
+            auto type = typenode.template as<std::string>();
+            if(type == "dict")
+              subschemas.dict = c.compileDict(c.getSchema());
+            if(type == "list")
+              subschemas.items.push_back(c.compileItem(c.getSchema()));
+          }
+          else
+          {
+            subschemas.dict = c.compileDict(c.getSchema());
+            subschemas.items.push_back(c.compileItem(c.getSchema()));
+          }
+          return subschemas;
+        },
+        RulePriority::VALIDATION
       );
     }
 
+    //! The decoded argument of the type rule
+    struct TypeRuleArgument
+    {
+      bool list = false;
+      bool dict = false;
+      std::vector<std::shared_ptr<TypeItemBase>> types;
+    };
+
     template<typename Validator>
     void type_rule(Validator& validator)
     {
@@ -584,29 +755,43 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          if((v.getDocument().IsNull()) || (!v.getDocument().IsDefined()))
+          const auto doc = v.getDocument();
+          if((document::is_null(doc)) || (!document::is_defined(doc)))
             return;
 
-          auto allowed_types = as_list(v.getSchema());
+          const auto& allowed_types = v.template getPreparedArgument<TypeRuleArgument>();
           // If a list is permitted and a list is given - we are good!
-          if((std::find_if(allowed_types.begin(), allowed_types.end(), [](auto t){ return t.template as<std::string>() == "list"; }) != allowed_types.end()) && (v.getDocument().IsSequence()))
+          if(allowed_types.list && (document::is_sequence(doc)))
             return;
 
           // If a dict is permitted and a dict is given - we are good!
-          if((std::find_if(allowed_types.begin(), allowed_types.end(), [](auto t){ return t.template as<std::string>() == "dict"; }) != allowed_types.end()) && (v.getDocument().IsMap()))
+          if(allowed_types.dict && (document::is_map(doc)))
             return;
 
+          const auto& value = document::to_yaml(doc);
           bool found_type = false;
-          for(auto t : allowed_types)
-          {
-            std::string tstr = t.template as<std::string>();
-            if((tstr != "list") && (tstr != "dict") && (v.getType(tstr)->is_convertible(v.getDocument())))
+          for(const auto& t : allowed_types.types)
+            if(t->is_convertible(value))
               found_type = true;
-          }
 
           if (!found_type)
             v.raiseError("Type-Rule violated");
         },
+        [](auto& c)
+        {
+          TypeRuleArgument allowed_types;
+          for(auto t : as_list(c.getSchema()))
+          {
+            std::string tstr = t.template as<std::string>();
+            if(tstr == "list")
+              allowed_types.list = true;
+            else if(tstr == "dict")
+              allowed_types.dict = true;
+            else if(auto type = c.getType(tstr))
+              allowed_types.types.push_back(type);
+          }
+          return allowed_types;
+        },
         RulePriority::TYPECHECKING
       );
     }
@@ -621,13 +806,41 @@ namespace cerberus {
         ),
         [](auto& v)
         {
-          for(auto item: v.getDocument())
+          const auto& subschemas = v.template getPreparedArgument<Subschemas<decltype(v)>>();
+          const auto doc = v.getDocument();
+          if(!v.validatesInParallel(document::size(doc)))
           {
-            v.getDocumentStack().push_back(item.second);;
-            v.validateItem(v.getSchema(0, true));
-            v.getDocumentStack().pop_back();
+            document::for_each_item(doc, [&v, &subschemas](const auto& key, const auto& value)
+            {
+              if(v.isAborted())
+                return;
+              v.getDocumentStack().pushDictItem(document::scalar(key), value);
+              v.validateItem(*subschemas.items.front());
+              v.getDocumentStack().pop();
+            });
+            return;
           }
-        }
+
+          // The parallel contexts look up the entries by key, so the keys are gathered up front
+          std::vector<std::string> keys;
+          document::for_each_item(doc, [&keys](const auto& key, const auto&)
+          {
+            keys.push_back(document::scalar(key));
+          });
+          v.validateElements(keys.size(), [&subschemas, &keys](auto& context, std::size_t i)
+          {
+            context.getDocumentStack().pushDictItem(keys[i]);
+            context.validateItem(*subschemas.items.front());
+            context.getDocumentStack().pop();
+          });
+        },
+        [](auto& c)
+        {
+          Subschemas<decltype(c)> subschemas;
+          subschemas.items.push_back(c.compileItem(c.getSchema()));
+          return subschemas;
+        },
+        RulePriority::VALIDATION
       );
     }
 
@@ -1,11 +1,17 @@
 #ifndef CERBERUS_CPP_STACK_HH
 #define CERBERUS_CPP_STACK_HH
 
+#include<cerberus-cpp/document.hh>
+
 #include<yaml-cpp/yaml.h>
 
-#include<memory>
-#include<regex>
+#include<algorithm>
+#include<cctype>
+#include<deque>
+#include<functional>
 #include<string>
+#include<type_traits>
+#include<unordered_map>
 #include<vector>
 
 #include<iostream>
@@ -13,72 +19,194 @@
 
 namespace cerberus {
 
-  class DocumentPathItem
+  /** @brief A path into a document as used by e.g. the @c dependencies rule
+   *
+   * Paths are given as strings like @c ^a.b[3].c, where a leading @c ^ anchors the
+   * path at the document root, dot-separated segments are mapping keys and
+   * bracketed numbers are list indices. Parsing the path once into a sequence
+   * of tokens allows to repeatedly look it up without any string processing.
+   */
+  class DocumentPath
   {
     public:
-    virtual std::string stringify(const std::string& prefix) const = 0;
-  };
-
-  class DictLookupItem
-    : public DocumentPathItem
-  {
-    public:
-    explicit DictLookupItem(const std::string& key)
-      : key(key)
-    {}
+    //! A single step of a document path
+    struct Token
+    {
+      //! Whether this token is a list index (or a mapping key otherwise)
+      bool is_index;
+      //! The mapping key (if not a list index)
+      std::string key;
+      //! The list index (if a list index)
+      int index;
+    };
 
-    std::string stringify(const std::string& prefix) const override
+    /** @brief Parse a document path from its string representation
+     *
+     * @param path The path string
+     */
+    explicit DocumentPath(const std::string& path)
+      : path(path)
     {
-      return prefix + ((prefix != "^") ? "." : "") + key;
+      std::size_t pos = 0;
+      if((!path.empty()) && (path[0] == '^'))
+      {
+        absolute = true;
+        pos = 1;
+      }
+
+      while(pos < path.size())
+      {
+        // Parse a list index
+        if(path[pos] == '[')
+        {
+          auto close = path.find(']', pos);
+          if((close != std::string::npos) && (close > pos + 1) &&
+             std::all_of(path.begin() + pos + 1, path.begin() + close, [](unsigned char c){ return std::isdigit(c); }))
+          {
+            tokens.push_back({true, "", std::stoi(path.substr(pos + 1, close - pos - 1))});
+            pos = close + 1;
+            if((pos < path.size()) && (path[pos] == '.'))
+              ++pos;
+            continue;
+          }
+        }
+
+        // Parse a mapping key - the last segment may contain any characters
+        auto end = path.find_first_of(".[", pos);
+        if((end == pos) || (end == std::string::npos))
+        {
+          tokens.push_back({false, path.substr(pos), 0});
+          break;
+        }
+        tokens.push_back({false, path.substr(pos, end - pos), 0});
+        pos = (path[end] == '.') ? end + 1 : end;
+      }
     }
 
-    private:
-    std::string key;
-  };
+    //! Whether the path is anchored at the document root
+    bool isAbsolute() const
+    {
+      return absolute;
+    }
 
-  class ListEntryItem
-    : public DocumentPathItem
-  {
-    public:
-    explicit ListEntryItem(std::size_t i)
-      : i(i)
-    {}
+    //! The tokens of the path, excluding the root anchor
+    const std::vector<Token>& getTokens() const
+    {
+      return tokens;
+    }
 
-    std::string stringify(const std::string& prefix) const override
+    //! The string representation of the path
+    const std::string& str() const
     {
-      return prefix + "[" + std::to_string(i) + "]";
+      return path;
     }
 
     private:
-    std::size_t i;
+    std::string path;
+    bool absolute = false;
+    std::vector<Token> tokens;
   };
 
-  /** @brief An object that represents a stack of nested YAML documents */
-  class DocumentStack
-    : public std::vector<YAML::Node>
+  //! Definition of the ways a document stack may access its root document
+  enum class DocumentAccess
+  {
+    //! The document is looked up and altered directly.
+    MUTABLE = 0,
+    //! The document is never altered.
+    READ_ONLY = 1,
+    //! Subtrees of the document are copied when they are about to be altered.
+    COPY_ON_WRITE = 2
+  };
+
+  /** @brief An object that represents a stack of nested documents
+   *
+   * The documents are accessed through their @c DocumentTraits. Only
+   * @c YAML::Node documents can be accessed for writing, documents of
+   * other models are always accessed read-only.
+   *
+   * @tparam Node The handle type of the document model
+   */
+  template<typename Node>
+  class BasicDocumentStack
+    : public std::vector<Node>
   {
     public:
     /** @brief reset the document stack to a new document
      *
-     * @param node The new YAML document. The stack will hold a deep copy
-     *             of this document.
+     * @param node The new document
+     * @param access_ How the document is accessed. Lookups never alter the
+     *                document and missing mapping entries are represented by
+     *                undefined nodes. With @c MUTABLE, these are bound to their
+     *                mapping, such that assigning to them inserts them. Otherwise,
+     *                they are only inserted into the document by @ref getWritable.
+     *                With @c COPY_ON_WRITE, @ref getWritable copies the path to a
+     *                subdocument before it is altered.
      */
-    void reset(const YAML::Node& node)
+    void reset(const Node& node, DocumentAccess access_ = DocumentAccess::MUTABLE)
     {
-      path.clear();
+      // Interned keys are kept to avoid allocations in subsequent validations, unless they pile up
+      if(keys.size() > max_interned_keys)
+      {
+        keys.clear();
+        key_ids.clear();
+      }
+      links.clear();
       this->clear();
-      this->push_back(node);
+      access = access_;
+      push_back(node);
+      links.back().kind = Link::ROOT;
+    }
+
+    /** @brief reset the document stack to a copy of another stack
+     *
+     * The copy refers to the same nodes as the given stack, but does not
+     * share any other state with it. The given stack is not altered, such
+     * that several threads may copy it at the same time.
+     *
+     * @param other The stack to copy
+     */
+    void reset(const BasicDocumentStack& other)
+    {
+      if(keys.size() > max_interned_keys)
+      {
+        keys.clear();
+        key_ids.clear();
+      }
+      links.clear();
+      this->clear();
+      access = other.access;
+      for(std::size_t i = 0; i < other.size(); ++i)
+      {
+        push_back(other[i]);
+        links.back() = other.links[i];
+        if(links.back().kind == Link::KEY)
+          links.back().value = internKey(other.keys[other.links[i].value]);
+      }
     }
 
     /** @brief Push a subdocument onto the stack according to a mapping key
      *
      * This will add an item onto the stack by looking up a key in the current
-     * top item dictionary.
+     * top item dictionary. Mappings that many keys are looked up from are
+     * indexed, such that lookups do not scan the mapping.
      */
     void pushDictItem(const std::string& key)
     {
-      path.push_back(std::make_shared<DictLookupItem>(key));
-      this->push_back(this->back()[key]);
+      push_back(lookupKey(this->size() - 1, key));
+      links.back().kind = Link::KEY;
+      links.back().value = internKey(key);
+    }
+
+    /** @brief Push an entry of the current top item dictionary onto the stack
+     *
+     * This works like the other overload, but takes the value that was found
+     * while iterating the dictionary instead of looking up the key.
+     */
+    void pushDictItem(const std::string& key, const Node& value)
+    {
+      push_back(value);
+      links.back().kind = Link::KEY;
+      links.back().value = internKey(key);
     }
 
     /** @brief Push a subdocument onto the stack according to a list index lookup
@@ -88,15 +216,37 @@ namespace cerberus {
      */
     void pushListItem(std::size_t i)
     {
-      path.push_back(std::make_shared<ListEntryItem>(i));
-      this->push_back(this->back()[i]);
+      push_back(document::element(this->back(), i));
+      links.back().kind = Link::INDEX;
+      links.back().value = i;
+    }
+
+    /** @brief Push a node onto the stack that is not looked up from the top item
+     *
+     * With copy-on-write access, such nodes are not linked to the document:
+     * Altering them through @ref getWritable alters a detached copy.
+     */
+    void push_back(const Node& node)
+    {
+      std::vector<Node>::push_back(node);
+      links.push_back(Link());
+      if(indices.size() < this->size())
+        indices.emplace_back();
+      indices[this->size() - 1].valid = false;
+      indices[this->size() - 1].lookups = 0;
+    }
+
+    //! Pops a node that was pushed with @c push_back
+    void pop_back()
+    {
+      std::vector<Node>::pop_back();
+      links.pop_back();
     }
 
     //! Pops the top item of the stack
     void pop()
     {
-      path.pop_back();
-      this->pop_back();
+      pop_back();
     }
 
     /** @brief Accesses an item of the stack
@@ -106,7 +256,7 @@ namespace cerberus {
      *
      * @param level The stack item index that we are interested in.
      */
-    YAML::Node get(std::size_t level = 0)
+    Node get(std::size_t level = 0)
     {
       return *(this->rbegin() + level);
     }
@@ -118,62 +268,336 @@ namespace cerberus {
      *
      * @param level The stack item index that we are interested in.
      */
-    YAML::Node get(std::size_t level = 0) const
+    Node get(std::size_t level = 0) const
     {
       return *(this->rbegin() + level);
     }
 
+    /** @brief Accesses an item of the stack with the intent of altering it
+     *
+     * With copy-on-write access, this copies the given item and all its
+     * ancestors, unless they already are copies. Copies are shallow: Their
+     * children are shared with the original document until they are altered
+     * themselves. With mutable access, missing items are inserted into
+     * their parents, such that assigning to them alters the document.
+     * With read-only access, this returns the item just like @ref get.
+     *
+     * @param level The stack item index that we are interested in.
+     */
+    Node getWritable(std::size_t level = 0)
+    {
+      if(access == DocumentAccess::READ_ONLY)
+        return get(level);
+      return makeWritable(level, std::is_same<Node, YAML::Node>{});
+    }
+
+    /** @brief Change the access to the document while it is traversed
+     *
+     * This may be used to switch from read-only to copy-on-write access,
+     * when it turns out that the document needs to be normalized. Items that
+     * are on the stack already are copied by @ref getWritable, because they
+     * were not accessed for writing yet.
+     */
+    void setAccess(DocumentAccess access_)
+    {
+      access = access_;
+    }
+
     /** @brief Extract a string describing the path from the root document through the stack
      *
      * This can be e.g. used to print information about the subdocument we
-     * are dealing with.
+     * are dealing with. The stack only keeps track of interned keys and
+     * indices, the string is rendered on request.
      */
     std::string stringPath() const
     {
-      std::string result = "^";
-      for (auto element: path)
-        result = element->stringify(result);
+      std::size_t length = 1;
+      for(const auto& link : links)
+      {
+        if(link.kind == Link::KEY)
+          length += keys[link.value].size() + 1;
+        if(link.kind == Link::INDEX)
+          length += 22;
+      }
+
+      std::string result;
+      result.reserve(length);
+      writePath(result);
       return result;
     }
 
+    /** @brief Write the string describing the path through the stack to a given string
+     *
+     * This works just like @ref stringPath, but reuses the storage of the given
+     * string, which is overwritten.
+     */
+    void writePath(std::string& result) const
+    {
+      result.assign(1, '^');
+      for(const auto& link : links)
+      {
+        if(link.kind == Link::KEY)
+        {
+          if(result.size() > 1)
+            result += '.';
+          result += keys[link.value];
+        }
+        if(link.kind == Link::INDEX)
+        {
+          result += '[';
+          result += std::to_string(link.value);
+          result += ']';
+        }
+      }
+    }
+
     //! Replaces the back node with a new one
-    void replaceBack(const YAML::Node& node)
+    void replaceBack(const Node& node)
+    {
+      std::vector<Node>::pop_back();
+      std::vector<Node>::push_back(node);
+      links.back().writable = false;
+      indices[this->size() - 1].valid = false;
+    }
+
+    /** @brief Lookup a part of the document according to a key string
+     *
+     * @param key The path to look up, see @c DocumentPath for the syntax
+     * @param level The stack item that relative paths start from
+     */
+    Node pathLookup(const std::string& key, std::size_t level = 0)
     {
-      this->pop_back();
-      this->push_back(node);
+      return pathLookup(DocumentPath(key), level);
     }
 
-    YAML::Node pathLookup(const std::string& key, std::size_t level = 0)
+    /** @brief Lookup a part of the document according to a parsed path
+     *
+     * @param path The path to look up
+     * @param level The stack item that relative paths start from
+     */
+    Node pathLookup(const DocumentPath& path, std::size_t level = 0)
     {
-      return pathLookup(key, get(level));
+      const std::size_t start = path.isAbsolute() ? 0 : this->size() - 1 - level;
+      Node node = (*this)[start];
+      bool first = true;
+      for(const auto& token : path.getTokens())
+      {
+        if((!document::is_defined(node)) || (token.is_index ? !document::is_sequence(node) : !document::is_map(node)))
+          return document::undefined<Node>();
+
+        // The first lookup starts from a stack item, which may be indexed
+        Node next = token.is_index ? document::element(node, token.index) :
+                    (first ? lookupKey(start, token.key) : document::lookup(node, token.key));
+        first = false;
+        if(!document::is_defined(next))
+          return document::undefined<Node>();
+        impl::rebind_document(node, next);
+      }
+      return node;
     }
 
     private:
-    YAML::Node pathLookup(const std::string& key, YAML::Node node)
+    //! Information about how a stack item relates to its predecessor
+    struct Link
     {
-      std::smatch match;
-      // Find out that we need to restart this from the document root
-      if(std::regex_match(key, match, std::regex{"^\\^(.*)$"}))
-        return pathLookup(match[1].str(), (*this)[0]);
+      enum Kind { DETACHED, ROOT, KEY, INDEX };
+      Kind kind = DETACHED;
+      //! The interned key id for KEY, the list index for INDEX
+      std::size_t value = 0;
+      bool writable = false;
+    };
 
-      // Recurse into dictionaries
-      if(std::regex_match(key, match, std::regex{"^([^\\.\\[]+)\\.(.*)$"}))
-        return pathLookup(match[2].str(), node[match[1].str()]);
+    //! Hashing of strings stored elsewhere, which avoids copying mapping keys into the index
+    struct KeyHash
+    {
+      std::size_t operator()(const std::string* key) const
+      {
+        return std::hash<std::string>()(*key);
+      }
+    };
 
-      // Recurse into lists
-      if(std::regex_match(key, match, std::regex{"^\\[([0-9]+])\\](.*)$"}))
-        return pathLookup(match[2].str(), node[std::stoi(match[1].str())]);
+    struct KeyEqual
+    {
+      bool operator()(const std::string* a, const std::string* b) const
+      {
+        return *a == *b;
+      }
+    };
 
-      // Stop recursion if the key prefix is empty
-      if(key == "")
-        return node;
+    //! An index of the keys of a mapping on the stack
+    struct KeyIndex
+    {
+      bool valid = false;
+      std::size_t lookups = 0;
+      std::unordered_map<const std::string*, Node, KeyHash, KeyEqual> entries;
+    };
 
-      return node[key];
+    //! Documents of other models are never altered
+    Node makeWritable(std::size_t level, std::false_type)
+    {
+      return get(level);
     }
 
-    std::vector<std::shared_ptr<DocumentPathItem>> path;
+    Node makeWritable(std::size_t level, std::true_type)
+    {
+      // Note that YAML::Node::reset is needed to rebind, assignment would alter the document
+      const std::size_t target = this->size() - 1 - level;
+      for(std::size_t i = 0; i <= target; ++i)
+      {
+        if(links[i].writable)
+          continue;
+
+        auto& node = (*this)[i];
+        const bool attached = (links[i].kind == Link::KEY) || (links[i].kind == Link::INDEX);
+        const bool defined = node.IsDefined();
+        if(access == DocumentAccess::COPY_ON_WRITE)
+        {
+          if(attached && defined)
+          {
+            if(links[i].kind == Link::KEY)
+              (*this)[i - 1][keys[links[i].value]] = shallowCopy(node);
+            else
+              (*this)[i - 1][links[i].value] = shallowCopy(node);
+          }
+          if(!attached)
+            node.reset(shallowCopy(node));
+          indices[i].valid = false;
+        }
+        if(attached && ((access == DocumentAccess::COPY_ON_WRITE) || (!defined)))
+        {
+          auto& parent = (*this)[i - 1];
+          node.reset(links[i].kind == Link::KEY ? parent[keys[links[i].value]] : parent[links[i].value]);
+          // Keep the index of the parent up to date with the inserted key
+          if((!defined) && (links[i].kind == Link::KEY) && indices[i - 1].valid)
+            indices[i - 1].entries[&keys[links[i].value]] = node;
+        }
+        links[i].writable = true;
+      }
+
+      // The caller may alter the mapping, so it needs to be indexed again
+      indices[target].valid = false;
+      return get(level);
+    }
+
+
+
+    //! Look up a key in the mapping at a given stack position
+    Node lookupKey(std::size_t position, const std::string& key)
+    {
+      return lookupKey(position, key, std::is_same<Node, YAML::Node>{});
+    }
+
+    //! Other document models are expected to provide efficient lookups themselves
+    Node lookupKey(std::size_t position, const std::string& key, std::false_type)
+    {
+      return document::lookup((*this)[position], key);
+    }
+
+    /** @brief Look up a key in a YAML mapping, which would otherwise scan the mapping
+     *
+     * A mapping is indexed once there were enough lookups on it. The index is
+     * built in a single pass and stays valid until the item is altered through
+     * @ref getWritable.
+     */
+    Node lookupKey(std::size_t position, const std::string& key, std::true_type)
+    {
+      const YAML::Node current = (*this)[position];
+      auto& index = indices[position];
+      if((!index.valid) && (++index.lookups >= index_threshold) && current.IsMap())
+      {
+        index.entries.clear();
+        index.entries.reserve(current.size());
+        for(auto item : current)
+          if(item.first.IsScalar())
+            index.entries.emplace(&item.first.Scalar(), item.second);
+        index.valid = true;
+      }
+
+      if(index.valid)
+      {
+        auto entry = index.entries.find(&key);
+        if((entry != index.entries.end()) && entry->second.IsDefined())
+          return entry->second;
+      }
+      else
+      {
+        const YAML::Node item = current[key];
+        if(item.IsDefined())
+          return item;
+      }
+
+      // With mutable access, missing keys are bound to the mapping, such that assigning to them inserts them
+      if((access == DocumentAccess::MUTABLE) && current.IsMap())
+      {
+        YAML::Node parent = (*this)[position];
+        return parent[key];
+      }
+      return YAML::Node(YAML::NodeType::Undefined);
+    }
+
+    //! Get the id of a mapping key, which only allocates the first time a key is seen
+    std::size_t internKey(const std::string& key)
+    {
+      auto id = key_ids.find(key);
+      if(id != key_ids.end())
+        return id->second;
+      keys.push_back(key);
+      key_ids.emplace(key, keys.size() - 1);
+      return keys.size() - 1;
+    }
+
+    //! Copy a node without copying its children
+    static YAML::Node shallowCopy(const YAML::Node& node)
+    {
+      // Children are assigned to new nodes, so that they can be replaced without altering the original.
+      // Keys of the original are distinct, so they are inserted without searching the copy. The new
+      // nodes are inserted before they are assigned, such that the memory of the original document
+      // is merged into the copy only once.
+      if(node.IsMap())
+      {
+        YAML::Node copy(YAML::NodeType::Map);
+        for(auto item : node)
+        {
+          YAML::Node child(YAML::NodeType::Null);
+          copy.force_insert(item.first, child);
+          share(child, item.second);
+        }
+        return copy;
+      }
+      if(node.IsSequence())
+      {
+        YAML::Node copy(YAML::NodeType::Sequence);
+        for(auto element : node)
+        {
+          YAML::Node child(YAML::NodeType::Null);
+          copy.push_back(child);
+          share(child, element);
+        }
+        return copy;
+      }
+      return YAML::Clone(node);
+    }
+
+    //! Let a node share the content of another one, assigning rebinds the handle, so it is taken by value
+    static void share(YAML::Node handle, const YAML::Node& content)
+    {
+      handle = content;
+    }
+
+    static constexpr std::size_t max_interned_keys = 65536;
+    static constexpr std::size_t index_threshold = 8;
+
+    std::vector<Link> links;
+    std::vector<KeyIndex> indices;
+    // A deque guarantees stable addresses of the interned keys, which are referenced from indices
+    std::deque<std::string> keys;
+    std::unordered_map<std::string, std::size_t> key_ids;
+    DocumentAccess access = DocumentAccess::MUTABLE;
   };
 
+  //! The stack of nested YAML documents, which is also used for schemas
+  using DocumentStack = BasicDocumentStack<YAML::Node>;
+
 } // namespace cerberus
 
 #endif
\ No newline at end of file
@@ -0,0 +1,641 @@
+#ifndef CERBERUS_CPP_STREAMING_HH
+#define CERBERUS_CPP_STREAMING_HH
+
+#include<cerberus-cpp/builder.hh>
+#include<cerberus-cpp/error.hh>
+#include<cerberus-cpp/stack.hh>
+#include<cerberus-cpp/validator.hh>
+
+#include<yaml-cpp/eventhandler.h>
+#include<yaml-cpp/yaml.h>
+
+#include<cstddef>
+#include<fstream>
+#include<istream>
+#include<string>
+#include<unordered_map>
+#include<vector>
+
+namespace cerberus {
+
+  /** @brief A validator that checks a document while it is being parsed
+   *
+   * The regular validation methods of the @c Validator class require the
+   * entire document to be loaded into memory. This class instead consumes
+   * the events of the yaml-cpp parser and validates the document as the
+   * events arrive. Mappings and lists are streamed through, as long as their
+   * schema only consists of structural rules (@c type, @c schema, @c items,
+   * @c keysrules, @c valuesrules, @c required, @c nullable, @c allow_unknown,
+   * @c require_all and @c meta). Other values, e.g. the records of a huge list,
+   * are loaded one at a time and validated with the regular algorithm. Memory
+   * usage is therefore bounded by the nesting depth and the largest such value
+   * instead of the size of the document.
+   *
+   * Schemas that normalize the document or cross-reference other fields
+   * (@c dependencies and @c excludes) are rejected with a @c StreamingError.
+   * Custom rules must only inspect the value they are applied to. Errors are
+   * reported in the order of the document, which may differ from the order of
+   * the regular validation. Aliases are only supported if their anchor is
+   * defined within the same loaded value.
+   */
+  class StreamingValidator
+    : private YAML::EventHandler
+  {
+    public:
+    //! The type of compiled schemas
+    using CompiledSchema = Validator::CompiledSchema;
+
+    /** @brief Construct a streaming validator
+     *
+     * @param validator The validator whose rules, types and policies are used.
+     *                  It needs to outlive this object.
+     * @param schema The compiled schema as returned by @c Validator::compile
+     */
+    StreamingValidator(const Validator& validator, const CompiledSchema& schema)
+      : validator(validator)
+      , schema(schema)
+      , context(validator)
+    {
+      if(schema.isNormalizing())
+        throw StreamingError("Schemas with normalization rules cannot be validated from a stream");
+      context.reset(YAML::Node(), DocumentAccess::READ_ONLY);
+      if(context.getPurgeUnknown())
+        throw StreamingError("The purge unknown policy normalizes the document and cannot be applied to a stream");
+      root_plan.dict = &schema.root();
+      root_plan.map = true;
+      planDict(root_plan);
+    }
+
+    /** @brief Validate the first document of a stream
+     *
+     * @param stream The input stream containing YAML
+     * @returns Whether or not the validation process was successful
+     */
+    bool validate(std::istream& stream)
+    {
+      errors.clear();
+      truncated = false;
+      frames.clear();
+      builder.clear();
+      skip_depth = 0;
+      skip_key = false;
+      context.reset(YAML::Node(), DocumentAccess::READ_ONLY);
+      allow_unknown = context.getAllowUnknown();
+      require_all = context.getRequireAll();
+
+      try
+      {
+        YAML::Parser parser(stream);
+        if(!parser.HandleNextDocument(*this))
+          validateRoot(YAML::Node());
+      }
+      catch(const Abort&)
+      {
+        truncated = true;
+      }
+      return errors.empty();
+    }
+
+    /** @brief Validate the first document of a file
+     *
+     * @param filename The name of the YAML file
+     * @returns Whether or not the validation process was successful
+     */
+    bool validateFile(const std::string& filename)
+    {
+      std::ifstream stream(filename);
+      if(!stream)
+        throw YAML::BadFile(filename);
+      return validate(stream);
+    }
+
+    //! The errors found during the last validation
+    const std::vector<ValidationErrorItem>& getErrors() const
+    {
+      return errors;
+    }
+
+    //! Whether the last validation stopped at the maximum number of errors
+    bool getErrorsTruncated() const
+    {
+      return truncated;
+    }
+
+    //! Print errors to a stream
+    template<typename Stream>
+    void printErrors(Stream& stream) const
+    {
+      for(const auto& error : errors)
+      {
+        stream << "Error validating data field " << error.path << "\n";
+        stream << "Message: " << error.message << "\n";
+      }
+    }
+
+    private:
+    using CompiledItem = CompiledSchema::Item;
+    using CompiledDict = CompiledSchema::Dict;
+    using Subschemas = CompiledSchema::Subschemas;
+
+    //! Thrown to stop parsing once the maximum number of errors is reached
+    struct Abort {};
+
+    //! How the values of a schema item are validated
+    struct Plan
+    {
+      //! The item without the rules that validate the children of a container
+      CompiledItem shell;
+      //! Whether mappings and lists are streamed through instead of being loaded
+      bool map = false;
+      bool sequence = false;
+      //! The subschemas of the schema, items, keysrules and valuesrules rules
+      const CompiledDict* dict = nullptr;
+      const CompiledItem* element = nullptr;
+      const CompiledItem* keys = nullptr;
+      const CompiledItem* values = nullptr;
+      std::vector<const CompiledItem*> items;
+      bool has_items = false;
+      //! The policies set by the item's rules (or -1 if inherited)
+      int allow_unknown = -1;
+      int require_all = -1;
+      //! The field indices of the dictionary schema
+      std::unordered_map<std::string, std::size_t> fields;
+    };
+
+    //! A mapping or list that is streamed through
+    struct Frame
+    {
+      const Plan* plan;
+      bool is_map;
+      bool allow_unknown;
+      bool require_all;
+      //! Whether the current child is the value of a key, and which items it is validated against
+      bool has_key = false;
+      std::string key;
+      bool ignored = false;
+      std::size_t index = 0;
+      const CompiledItem* targets[2] = {nullptr, nullptr};
+      std::vector<bool> seen;
+    };
+
+    void planDict(Plan& plan)
+    {
+      for(std::size_t i = 0; i < plan.dict->fields.size(); ++i)
+      {
+        plan.fields[plan.dict->fields[i].first] = i;
+        planItem(plan.dict->fields[i].second);
+      }
+    }
+
+    const Plan& planItem(const CompiledItem* item)
+    {
+      auto planned = plans.find(item);
+      if(planned != plans.end())
+        return planned->second;
+
+      // Note that references to elements of unordered maps stay valid when inserting
+      Plan& plan = plans[item];
+      plan.shell.schema = item->schema;
+      plan.shell.type = item->type;
+      plan.shell.require_all = item->require_all;
+      plan.shell.require_all_priority = item->require_all_priority;
+
+      bool streamable = true;
+      bool schema_rule = false;
+      for(std::size_t priority = 0; priority < RulePriorityCount; ++priority)
+        for(const auto& rule : item->rules[priority])
+        {
+          if((rule.name == "dependencies") || (rule.name == "excludes"))
+            throw StreamingError("The " + rule.name + " rule cross-references other fields and cannot be validated from a stream");
+
+          if((rule.name == "schema") || (rule.name == "items") || (rule.name == "keysrules") || (rule.name == "valuesrules"))
+          {
+            const auto& subschemas = static_cast<const PreparedArgument<Subschemas>&>(*(rule.prepared)).value;
+            if(rule.name == "schema")
+            {
+              schema_rule = true;
+              plan.dict = subschemas.dict;
+              if(!subschemas.items.empty())
+                plan.element = subschemas.items.front();
+            }
+            if(rule.name == "items")
+            {
+              plan.has_items = true;
+              plan.items = subschemas.items;
+            }
+            if(rule.name == "keysrules")
+              plan.keys = subschemas.items.front();
+            if(rule.name == "valuesrules")
+              plan.values = subschemas.items.front();
+            continue;
+          }
+
+          if((rule.name != "type") && (rule.name != "nullable") && (rule.name != "required") && (rule.name != "meta") &&
+             (rule.name != "allow_unknown") && (rule.name != "require_all"))
+            streamable = false;
+          if(rule.name == "required")
+            plan.shell.required_index = static_cast<int>(plan.shell.rules[priority].size());
+          if(rule.name == "allow_unknown")
+            plan.allow_unknown = rule.argument.as<bool>();
+          if(rule.name == "require_all")
+            plan.require_all = rule.argument.as<bool>();
+          plan.shell.rules[priority].push_back(rule);
+        }
+
+      // A container is loaded, if its schema contains rules that need all of it or that do not apply to its kind
+      plan.map = streamable && (!plan.has_items) && ((!schema_rule) || plan.dict);
+      plan.sequence = streamable && (!plan.keys) && (!plan.values) && ((!schema_rule) || plan.element);
+
+      // Subschemas are planned regardless, as loaded values may not cross-reference either
+      if(plan.dict)
+        planDict(plan);
+      for(auto sub : {plan.element, plan.keys, plan.values})
+        if(sub)
+          planItem(sub);
+      for(auto sub : plan.items)
+        planItem(sub);
+      return plan;
+    }
+
+    //! Render the path to the current child of the frame at the given depth
+    std::string path(std::size_t depth) const
+    {
+      std::string result = "^";
+      for(std::size_t i = 0; i < depth; ++i)
+      {
+        if(frames[i].has_key)
+        {
+          if(result.size() > 1)
+            result += '.';
+          result += frames[i].key;
+        }
+        else
+        {
+          result += '[';
+          result += std::to_string(frames[i].index);
+          result += ']';
+        }
+      }
+      return result;
+    }
+
+    void raiseError(const std::string& path, const std::string& message)
+    {
+      errors.push_back({path, message});
+      if((validator.getMaxErrors() > 0) && (errors.size() >= validator.getMaxErrors()))
+        throw Abort();
+    }
+
+    //! Report the errors of the context, whose paths are relative to the given path
+    void collectErrors(const std::string& prefix)
+    {
+      for(const auto& error : context.getErrors())
+      {
+        if(error.path.size() == 1)
+          raiseError(prefix, error.message);
+        else if(prefix.size() == 1)
+          raiseError(error.path, error.message);
+        else if(error.path[1] == '[')
+          raiseError(prefix + error.path.substr(1), error.message);
+        else
+          raiseError(prefix + "." + error.path.substr(1), error.message);
+      }
+    }
+
+    //! Validate a value against a schema item with the regular algorithm
+    void validateNode(const CompiledItem& item, const YAML::Node& node, const std::string& prefix, bool allow_unknown_, bool require_all_)
+    {
+      // The value gets an empty parent, as rules may inspect the parent of the validated item
+      context.reset(YAML::Node(YAML::NodeType::Map), DocumentAccess::READ_ONLY);
+      context.getDocumentStack().push_back(node);
+      context.setAllowUnknown(allow_unknown_);
+      context.setRequireAll(require_all_);
+      context.validateItem(item);
+      collectErrors(prefix);
+    }
+
+    //! Validate a document that is not a mapping with the regular algorithm
+    void validateRoot(const YAML::Node& document)
+    {
+      context.reset(document, DocumentAccess::READ_ONLY);
+      context.validateDict(schema.root());
+      collectErrors("^");
+    }
+
+    //! Decide which items the next child of the top frame is validated against
+    void beginChild()
+    {
+      auto& frame = frames.back();
+      frame.targets[0] = frame.targets[1] = nullptr;
+      if(frame.ignored)
+        return;
+      if(frame.has_key)
+      {
+        if(frame.plan->dict)
+        {
+          auto field = frame.plan->fields.find(frame.key);
+          if(field != frame.plan->fields.end())
+          {
+            frame.seen[field->second] = true;
+            frame.targets[0] = frame.plan->dict->fields[field->second].second;
+          }
+          else if(!frame.allow_unknown)
+            raiseError(path(frames.size() - 1), "Unknown item found in validator that does not accept unknown items: " + frame.key);
+        }
+        frame.targets[1] = frame.plan->values;
+      }
+      else
+      {
+        frame.targets[0] = frame.plan->element;
+        if(frame.index < frame.plan->items.size())
+          frame.targets[1] = frame.plan->items[frame.index];
+      }
+    }
+
+    //! Finish the current child of the top frame
+    void endChild()
+    {
+      if(frames.empty())
+        return;
+      auto& frame = frames.back();
+      if(frame.has_key)
+      {
+        frame.has_key = false;
+        frame.ignored = false;
+      }
+      else
+        ++frame.index;
+    }
+
+    //! Validate a completely known value that is the current child of the top frame
+    void validateValue(const YAML::Node& node)
+    {
+      if(frames.empty())
+      {
+        validateRoot(node);
+        return;
+      }
+      const auto& frame = frames.back();
+      const std::string prefix = path(frames.size());
+      for(auto target : frame.targets)
+        if(target)
+          validateNode(*target, node, prefix, frame.allow_unknown, frame.require_all);
+      endChild();
+    }
+
+    //! Whether the next event of the top frame is a key (as opposed to a value)
+    bool expectsKey() const
+    {
+      return (!frames.empty()) && frames.back().is_map && (!frames.back().has_key);
+    }
+
+    //! Accept a key that is never known to a schema, its value is skipped
+    void ignoreKey(const std::string& description)
+    {
+      auto& frame = frames.back();
+      if(frame.plan->dict && (!frame.allow_unknown))
+        raiseError(path(frames.size() - 1), "Unknown item found in validator that does not accept unknown items: " + description);
+      frame.key = description;
+      frame.has_key = true;
+      frame.ignored = true;
+    }
+
+    void onLeaf(const YAML::Node& node, YAML::anchor_t anchor)
+    {
+      if(skip_depth > 0)
+        return;
+      if(builder.building())
+      {
+        builder.addLeaf(node, anchor);
+        return;
+      }
+
+      if(expectsKey())
+      {
+        onKey(node);
+        return;
+      }
+      if(!frames.empty())
+        beginChild();
+      validateValue(node);
+    }
+
+    void onKey(const YAML::Node& node)
+    {
+      auto& frame = frames.back();
+      if(frame.plan->keys)
+        validateNode(*(frame.plan->keys), node, path(frames.size() - 1), frame.allow_unknown, frame.require_all);
+      frame.key = node.Scalar();
+      frame.has_key = true;
+    }
+
+    void onStart(bool map, const std::string& tag, YAML::anchor_t anchor)
+    {
+      if(skip_depth > 0)
+      {
+        ++skip_depth;
+        return;
+      }
+
+      if(builder.building())
+      {
+        builder.startContainer(map, tag, anchor);
+        return;
+      }
+
+      if(expectsKey())
+      {
+        ignoreKey("<complex key>");
+        skip_depth = 1;
+        skip_key = true;
+        return;
+      }
+
+      // The root mapping is streamed against the root dictionary
+      if(frames.empty())
+      {
+        if(map)
+        {
+          pushFrame(root_plan, true, allow_unknown, require_all);
+          return;
+        }
+        startBuilding(map, tag, anchor);
+        return;
+      }
+
+      beginChild();
+      auto& frame = frames.back();
+      const CompiledItem* target = nullptr;
+      std::size_t count = 0;
+      for(auto t : frame.targets)
+        if(t)
+        {
+          target = t;
+          ++count;
+        }
+
+      if(count == 0)
+      {
+        skip_depth = 1;
+        return;
+      }
+
+      // Stream the container if it is validated against a single item that allows it
+      if(count == 1)
+      {
+        const Plan& plan = planItem(target);
+        if(map ? plan.map : plan.sequence)
+        {
+          // The rules that are not about the children are checked against an empty container
+          const YAML::Node empty(map ? YAML::NodeType::Map : YAML::NodeType::Sequence);
+          validateNode(plan.shell, empty, path(frames.size()), frame.allow_unknown, frame.require_all);
+          pushFrame(plan, map,
+                    (plan.allow_unknown >= 0) ? (plan.allow_unknown == 1) : frame.allow_unknown,
+                    (plan.require_all >= 0) ? (plan.require_all == 1) : frame.require_all);
+          return;
+        }
+      }
+      startBuilding(map, tag, anchor);
+    }
+
+    void onEnd()
+    {
+      if(skip_depth > 0)
+      {
+        if(--skip_depth == 0)
+        {
+          if(skip_key)
+            skip_key = false;
+          else
+            endChild();
+        }
+        return;
+      }
+
+      if(builder.building())
+      {
+        if(builder.endContainer())
+          validateValue(builder.node());
+        return;
+      }
+
+      // Fields and items that did not occur in the document are validated as undefined values
+      auto& frame = frames.back();
+      if(frame.is_map && frame.plan->dict)
+        for(std::size_t i = 0; i < frame.seen.size(); ++i)
+          if(!frame.seen[i])
+          {
+            frame.key = frame.plan->dict->fields[i].first;
+            frame.has_key = true;
+            validateNode(*(frame.plan->dict->fields[i].second), YAML::Node(YAML::NodeType::Undefined), path(frames.size()), frame.allow_unknown, frame.require_all);
+            frame.has_key = false;
+          }
+      if((!frame.is_map) && frame.plan->has_items)
+        for(; frame.index < frame.plan->items.size(); ++frame.index)
+          validateNode(*(frame.plan->items[frame.index]), YAML::Node(YAML::NodeType::Undefined), path(frames.size()), frame.allow_unknown, frame.require_all);
+
+      frames.pop_back();
+      endChild();
+    }
+
+    void pushFrame(const Plan& plan, bool map, bool allow_unknown_, bool require_all_)
+    {
+      frames.emplace_back();
+      auto& frame = frames.back();
+      frame.plan = &plan;
+      frame.is_map = map;
+      frame.allow_unknown = allow_unknown_;
+      frame.require_all = require_all_;
+      if(map && plan.dict)
+        frame.seen.assign(plan.dict->fields.size(), false);
+    }
+
+    //! Start loading a value, anchors are only resolved within it
+    void startBuilding(bool map, const std::string& tag, YAML::anchor_t anchor)
+    {
+      builder.clear();
+      builder.startContainer(map, tag, anchor);
+    }
+
+    void OnDocumentStart(const YAML::Mark&) override {}
+
+    void OnDocumentEnd() override {}
+
+    void OnNull(const YAML::Mark&, YAML::anchor_t anchor) override
+    {
+      onLeaf(YAML::Node(YAML::NodeType::Null), anchor);
+    }
+
+    void OnAlias(const YAML::Mark&, YAML::anchor_t anchor) override
+    {
+      if(skip_depth > 0)
+        return;
+      if(builder.building())
+      {
+        if(!builder.addAlias(anchor))
+          raiseError(path(frames.size()), "Aliases to anchors outside of the validated value are not supported in streaming validation");
+        return;
+      }
+      if(expectsKey())
+      {
+        ignoreKey("<alias>");
+        return;
+      }
+
+      // Aliases are only a problem if their value is validated
+      beginChild();
+      if(frames.back().targets[0] || frames.back().targets[1])
+        raiseError(path(frames.size()), "Aliases to anchors outside of the validated value are not supported in streaming validation");
+      endChild();
+    }
+
+    void OnScalar(const YAML::Mark&, const std::string& tag, YAML::anchor_t anchor, const std::string& value) override
+    {
+      YAML::Node node(value);
+      node.SetTag(tag);
+      onLeaf(node, anchor);
+    }
+
+    void OnSequenceStart(const YAML::Mark&, const std::string& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value) override
+    {
+      onStart(false, tag, anchor);
+    }
+
+    void OnSequenceEnd() override
+    {
+      onEnd();
+    }
+
+    void OnMapStart(const YAML::Mark&, const std::string& tag, YAML::anchor_t anchor, YAML::EmitterStyle::value) override
+    {
+      onStart(true, tag, anchor);
+    }
+
+    void OnMapEnd() override
+    {
+      onEnd();
+    }
+
+    const Validator& validator;
+    CompiledSchema schema;
+    Validator::ValidationContext context;
+    Plan root_plan;
+    std::unordered_map<const CompiledItem*, Plan> plans;
+
+    std::vector<ValidationErrorItem> errors;
+    bool truncated = false;
+    bool allow_unknown = false;
+    bool require_all = false;
+
+    // The mappings and lists that are streamed through
+    std::vector<Frame> frames;
+    // The value that is currently loaded
+    NodeBuilder builder;
+    // The nesting depth of a value that is skipped, because no schema applies to it
+    std::size_t skip_depth = 0;
+    bool skip_key = false;
+  };
+
+} // namespace cerberus
+
+#endif
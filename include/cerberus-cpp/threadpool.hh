@@ -0,0 +1,250 @@
+#ifndef CERBERUS_CPP_THREADPOOL_HH
+#define CERBERUS_CPP_THREADPOOL_HH
+
+#include<algorithm>
+#include<condition_variable>
+#include<cstddef>
+#include<deque>
+#include<exception>
+#include<functional>
+#include<memory>
+#include<mutex>
+#include<thread>
+#include<utility>
+#include<vector>
+
+namespace cerberus {
+
+  /** @brief A work-stealing thread pool for data parallel loops
+   *
+   * The pool runs loops over index ranges that are split into chunks. Each
+   * worker has its own queue of chunks and steals chunks from the other
+   * queues once its own queue ran dry. The thread calling @ref parallelFor
+   * participates in the work. Loops issued from within a running loop are
+   * executed serially by the calling worker.
+   */
+  class ThreadPool
+  {
+    public:
+    /** @brief Construct a thread pool
+     *
+     * @param threads The number of threads working on a loop including the
+     *                calling thread. The default of 0 uses the number of
+     *                hardware threads.
+     */
+    explicit ThreadPool(std::size_t threads = 0)
+    {
+      if(threads == 0)
+        threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+      queues.reserve(threads);
+      for(std::size_t i = 0; i < threads; ++i)
+        queues.emplace_back(new Queue);
+      // The calling thread acts as the last worker
+      for(std::size_t i = 0; i + 1 < threads; ++i)
+        workers.emplace_back([this, i](){ work(i); });
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      wakeup.notify_all();
+      for(auto& worker : workers)
+        worker.join();
+    }
+
+    //! The number of threads working on a loop, including the calling thread
+    std::size_t size() const
+    {
+      return queues.size();
+    }
+
+    //! Whether the calling thread currently works on a loop of this pool
+    bool isWorkerThread() const
+    {
+      return current_worker() != nullptr;
+    }
+
+    /** @brief Run a loop over an index range in parallel
+     *
+     * This blocks until all chunks are processed. If a chunk throws, the
+     * first exception is rethrown after the remaining chunks finished.
+     *
+     * @param count The number of indices, the loop runs over [0, count)
+     * @param chunk The number of consecutive indices handed to a worker at once
+     * @param body A callable with the signature <tt>void(std::size_t worker, std::size_t begin, std::size_t end)</tt>,
+     *             where @c worker is in [0, size()) and unique among the threads
+     *             running concurrently.
+     */
+    template<typename Body>
+    void parallelFor(std::size_t count, std::size_t chunk, Body&& body)
+    {
+      if(count == 0)
+        return;
+      chunk = std::max<std::size_t>(chunk, 1);
+
+      // Nested loops and loops on a pool without workers run on the calling thread
+      if((current_worker() != nullptr) || workers.empty())
+      {
+        const std::size_t worker = (current_worker() != nullptr) ? current_worker()->index : size() - 1;
+        for(std::size_t begin = 0; begin < count; begin += chunk)
+          body(worker, begin, std::min(begin + chunk, count));
+        return;
+      }
+
+      std::lock_guard<std::mutex> serialize(loop_mutex);
+
+      // The job is published before any chunk, as workers may still be looking for chunks of the last loop
+      const std::size_t chunks = (count + chunk - 1) / chunk;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = std::ref(body);
+        remaining = chunks;
+        error = nullptr;
+      }
+
+      // Distribute the chunks round robin, so that stealing is only needed for imbalanced loads
+      for(std::size_t c = 0; c < chunks; ++c)
+      {
+        auto& queue = *queues[c % size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.chunks.emplace_back(c * chunk, std::min((c + 1) * chunk, count));
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++generation;
+      }
+      wakeup.notify_all();
+
+      process(size() - 1);
+
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.wait(lock, [this](){ return remaining == 0; });
+      job = nullptr;
+      if(error)
+        std::rethrow_exception(error);
+    }
+
+    private:
+    //! The chunks assigned to a worker
+    struct Queue
+    {
+      std::mutex mutex;
+      std::deque<std::pair<std::size_t, std::size_t>> chunks;
+    };
+
+    //! Identifies the worker that the current thread acts as
+    struct WorkerTag
+    {
+      const ThreadPool* pool;
+      std::size_t index;
+    };
+
+    const WorkerTag* current_worker() const
+    {
+      const WorkerTag* tag = worker_tag();
+      return ((tag != nullptr) && (tag->pool == this)) ? tag : nullptr;
+    }
+
+    static const WorkerTag*& worker_tag()
+    {
+      static thread_local const WorkerTag* tag = nullptr;
+      return tag;
+    }
+
+    bool take(std::size_t worker, std::pair<std::size_t, std::size_t>& range)
+    {
+      // Take from the back of the own queue and steal from the front of other queues
+      for(std::size_t i = 0; i < size(); ++i)
+      {
+        auto& queue = *queues[(worker + i) % size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if(queue.chunks.empty())
+          continue;
+        if(i == 0)
+        {
+          range = queue.chunks.back();
+          queue.chunks.pop_back();
+        }
+        else
+        {
+          range = queue.chunks.front();
+          queue.chunks.pop_front();
+        }
+        return true;
+      }
+      return false;
+    }
+
+    void process(std::size_t worker)
+    {
+      WorkerTag tag{this, worker};
+      const WorkerTag* parent = worker_tag();
+      worker_tag() = &tag;
+
+      std::pair<std::size_t, std::size_t> range;
+      std::size_t done = 0;
+      while(take(worker, range))
+      {
+        try
+        {
+          job(worker, range.first, range.second);
+        }
+        catch(...)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if(!error)
+            error = std::current_exception();
+        }
+        ++done;
+      }
+      worker_tag() = parent;
+
+      if(done > 0)
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        remaining -= done;
+        if(remaining == 0)
+          finished.notify_all();
+      }
+    }
+
+    void work(std::size_t worker)
+    {
+      std::size_t seen = 0;
+      while(true)
+      {
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          wakeup.wait(lock, [this, seen](){ return stopping || (generation != seen); });
+          if(stopping)
+            return;
+          seen = generation;
+        }
+        process(worker);
+      }
+    }
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex loop_mutex;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable finished;
+    std::function<void(std::size_t, std::size_t, std::size_t)> job;
+    std::size_t remaining = 0;
+    std::size_t generation = 0;
+    std::exception_ptr error;
+    bool stopping = false;
+  };
+
+} // namespace cerberus
+
+#endif
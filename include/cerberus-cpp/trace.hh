@@ -0,0 +1,170 @@
+#ifndef CERBERUS_CPP_TRACE_HH
+#define CERBERUS_CPP_TRACE_HH
+
+#include<chrono>
+#include<cstddef>
+#include<cstdio>
+#include<iomanip>
+#include<ostream>
+#include<string>
+#include<vector>
+
+namespace cerberus {
+
+  /** @brief A timeline of validation spans in a ring buffer of fixed size
+   *
+   * A trace buffer attached to a validator or a validation context with
+   * @c setTrace records a span for each @c validateDict, @c validateItem
+   * and rule invocation, annotated with the path of the validated document
+   * item. All storage is allocated when the buffer is constructed, so that
+   * recording does not allocate as long as names and paths fit into the
+   * reserved storage. If the buffer is full, the oldest spans are overwritten.
+   * The timeline is exported as Chrome trace-event JSON with @ref writeJson,
+   * which can be loaded into Perfetto or @c chrome://tracing. Buffers are not
+   * safe to be shared between threads.
+   */
+  class TraceBuffer
+  {
+    public:
+    //! The clock that spans are measured with
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Construct a trace buffer
+     *
+     * @param capacity The maximum number of spans kept in the buffer
+     * @param string_capacity The number of characters reserved for the name and the path of each span
+     */
+    explicit TraceBuffer(std::size_t capacity = 65536, std::size_t string_capacity = 64)
+      : spans(capacity)
+      , origin(Clock::now())
+    {
+      for(auto& span : spans)
+      {
+        span.name.reserve(string_capacity);
+        span.path.reserve(string_capacity);
+      }
+    }
+
+    /** @brief Record a span
+     *
+     * @param name The name of the span, e.g. the name of a rule
+     * @param start The start time of the span
+     * @param end The end time of the span
+     * @param path A callable that writes the document path of the span to a
+     *             given @c std::string&, e.g. @c DocumentStack::writePath.
+     */
+    template<typename Path>
+    void record(const std::string& name, Clock::time_point start, Clock::time_point end, Path&& path)
+    {
+      if(spans.empty())
+      {
+        ++dropped_count;
+        return;
+      }
+      auto& span = spans[next];
+      span.name.assign(name);
+      path(span.path);
+      span.start = start;
+      span.end = end;
+
+      next = (next + 1) % spans.size();
+      if(count < spans.size())
+        ++count;
+      else
+        ++dropped_count;
+    }
+
+    //! The maximum number of spans kept in the buffer
+    std::size_t capacity() const
+    {
+      return spans.size();
+    }
+
+    //! The number of spans in the buffer
+    std::size_t size() const
+    {
+      return count;
+    }
+
+    //! The number of spans that were overwritten or not recorded, because the buffer was full
+    std::size_t dropped() const
+    {
+      return dropped_count;
+    }
+
+    //! Drop all spans
+    void clear()
+    {
+      next = 0;
+      count = 0;
+      dropped_count = 0;
+    }
+
+    /** @brief Write the spans as Chrome trace-event JSON
+     *
+     * Each span is written as a complete event with the document path in
+     * its arguments. Timestamps are given in microseconds since the
+     * construction of the buffer.
+     */
+    void writeJson(std::ostream& stream) const
+    {
+      const auto flags = stream.flags();
+      const auto precision = stream.precision();
+      stream << std::fixed << std::setprecision(3);
+      stream << "{\"traceEvents\": [";
+      const std::size_t first = (count < spans.size()) ? 0 : next;
+      for(std::size_t i = 0; i < count; ++i)
+      {
+        const auto& span = spans[(first + i) % spans.size()];
+        stream << (i ? ",\n" : "\n") << "{\"name\": ";
+        write_string(stream, span.name);
+        stream << ", \"cat\": \"cerberus\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, \"ts\": "
+               << std::chrono::duration<double, std::micro>(span.start - origin).count()
+               << ", \"dur\": " << std::chrono::duration<double, std::micro>(span.end - span.start).count()
+               << ", \"args\": {\"path\": ";
+        write_string(stream, span.path);
+        stream << "}}";
+      }
+      stream << "\n], \"displayTimeUnit\": \"ns\"}\n";
+      stream.flags(flags);
+      stream.precision(precision);
+    }
+
+    private:
+    struct Span
+    {
+      std::string name;
+      std::string path;
+      Clock::time_point start;
+      Clock::time_point end;
+    };
+
+    static void write_string(std::ostream& stream, const std::string& value)
+    {
+      stream << '"';
+      for(char c : value)
+      {
+        if((c == '"') || (c == '\\'))
+          stream << '\\' << c;
+        else if(static_cast<unsigned char>(c) < 0x20)
+        {
+          char escaped[7];
+          std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+          stream << escaped;
+        }
+        else
+          stream << c;
+      }
+      stream << '"';
+    }
+
+    std::vector<Span> spans;
+    Clock::time_point origin;
+    std::size_t next = 0;
+    std::size_t count = 0;
+    std::size_t dropped_count = 0;
+  };
+
+} // namespace cerberus
+
+#endif
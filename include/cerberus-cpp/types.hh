@@ -2,10 +2,190 @@
 #define CERBERUS_CPP_TYPES_HH
 
 #include<yaml-cpp/yaml.h>
+
+#include<algorithm>
+#include<cstddef>
+#include<functional>
+#include<memory>
 #include<string>
+#include<type_traits>
+#include<unordered_map>
+#include<utility>
+#include<vector>
 
 namespace cerberus {
 
+  /** @brief Abstract base class for a set of values that were decoded once
+   *
+   * Value sets are used by rules like @c allowed and @c forbidden, that probe
+   * the document against a list of values from the schema. They are created
+   * through @c TypeItemBase::make_value_set when compiling a schema.
+   */
+  struct ValueSetBase
+  {
+    virtual ~ValueSetBase() = default;
+
+    /** @brief Find a value in the set
+     *
+     * @param node The node to look up
+     * @returns The index of a matching value in the list that the set was
+     *          built from or -1 if the node is not in the set.
+     */
+    virtual int find(const YAML::Node& node) const = 0;
+  };
+
+  /** @brief Abstract base class for a schema literal that was decoded once
+   *
+   * Constants are used by rules like @c min and @c max, that compare the
+   * document against a value from the schema. They are created through
+   * @c TypeItemBase::decode_constant when compiling a schema.
+   */
+  struct ConstantBase
+  {
+    virtual ~ConstantBase() = default;
+  };
+
+  /** @brief The result of comparing a document against a constant */
+  enum class Ordering
+  {
+    //! The document is less than the constant
+    LESS,
+    //! The document is equal to the constant
+    EQUAL,
+    //! The document is greater than the constant
+    GREATER,
+    //! The document could not be decoded or is not comparable (e.g. NaN)
+    UNORDERED
+  };
+
+  /** @brief A constant of a given C++ type
+   *
+   * @tparam T The C++ type of the constant
+   */
+  template<typename T>
+  struct Constant
+    : ConstantBase
+  {
+    explicit Constant(T value)
+      : value(std::move(value))
+    {}
+
+    T value;
+  };
+
+  namespace impl {
+
+    template<typename T, typename = void>
+    struct is_hashable : std::false_type
+    {};
+
+    template<typename T>
+    struct is_hashable<T, decltype(void(std::hash<T>{}(std::declval<const T&>())),
+                                   void(std::declval<const T&>() == std::declval<const T&>()))>
+      : std::true_type
+    {};
+
+    template<typename T, typename = void>
+    struct is_less_comparable : std::false_type
+    {};
+
+    template<typename T>
+    struct is_less_comparable<T, decltype(void(std::declval<const T&>() < std::declval<const T&>()))>
+      : std::true_type
+    {};
+
+    //! A value set implemented as a hash map
+    template<typename T>
+    struct HashedValueSet
+      : ValueSetBase
+    {
+      int find(const YAML::Node& node) const override
+      {
+        T value;
+        if(!YAML::convert<T>::decode(node, value))
+          return -1;
+        auto it = values.find(value);
+        return (it == values.end()) ? -1 : it->second;
+      }
+
+      void insert(T value, int index)
+      {
+        values.emplace(std::move(value), index);
+      }
+
+      void finalize()
+      {}
+
+      std::unordered_map<T, int> values;
+    };
+
+    //! A value set implemented as a sorted vector for types that are not hashable
+    template<typename T>
+    struct SortedValueSet
+      : ValueSetBase
+    {
+      int find(const YAML::Node& node) const override
+      {
+        T value;
+        if(!YAML::convert<T>::decode(node, value))
+          return -1;
+        auto it = std::lower_bound(values.begin(), values.end(), value,
+                                   [](const auto& entry, const T& v){ return entry.first < v; });
+        if((it == values.end()) || (value < it->first))
+          return -1;
+        return it->second;
+      }
+
+      void insert(T value, int index)
+      {
+        values.emplace_back(std::move(value), index);
+      }
+
+      void finalize()
+      {
+        // Stable sorting keeps the first occurence of equivalent values in front
+        std::stable_sort(values.begin(), values.end(),
+                         [](const auto& a, const auto& b){ return a.first < b.first; });
+      }
+
+      std::vector<std::pair<T, int>> values;
+    };
+
+    template<typename Set, typename T>
+    std::unique_ptr<const ValueSetBase> build_value_set(const std::vector<YAML::Node>& nodes)
+    {
+      auto set = std::make_unique<Set>();
+      for(std::size_t i = nodes.size(); i > 0; --i)
+      {
+        // Values are inserted back to front, such that the first occurence wins
+        T value;
+        if(YAML::convert<T>::decode(nodes[i - 1], value))
+          set->insert(std::move(value), static_cast<int>(i - 1));
+      }
+      set->finalize();
+      return set;
+    }
+
+    template<typename T, typename LessComparable>
+    std::unique_ptr<const ValueSetBase> make_value_set(const std::vector<YAML::Node>& nodes, std::true_type, LessComparable)
+    {
+      return build_value_set<HashedValueSet<T>, T>(nodes);
+    }
+
+    template<typename T>
+    std::unique_ptr<const ValueSetBase> make_value_set(const std::vector<YAML::Node>& nodes, std::false_type, std::true_type)
+    {
+      return build_value_set<SortedValueSet<T>, T>(nodes);
+    }
+
+    template<typename T>
+    std::unique_ptr<const ValueSetBase> make_value_set(const std::vector<YAML::Node>&, std::false_type, std::false_type)
+    {
+      return nullptr;
+    }
+
+  } // namespace impl
+
   /** @brief Abstract base class that represents a type in the validation process
    * 
    * This defines the interface that we expect from a type implementation.
@@ -18,6 +198,40 @@ namespace cerberus {
     virtual bool is_convertible(const YAML::Node&) const = 0;
     virtual bool equality(const YAML::Node&, const YAML::Node&) const = 0;
     virtual bool less(const YAML::Node&, const YAML::Node&) const = 0;
+
+    virtual ~TypeItemBase() = default;
+
+    /** @brief Decode a list of values into a set that allows fast lookup
+     *
+     * Type implementations that cannot provide this may return an empty
+     * pointer, in which case users are expected to fall back to comparing
+     * values with @c equality.
+     */
+    virtual std::unique_ptr<const ValueSetBase> make_value_set(const std::vector<YAML::Node>&) const
+    {
+      return nullptr;
+    }
+
+    /** @brief Decode a schema literal once for repeated comparisons
+     *
+     * Type implementations that cannot provide this may return an empty
+     * pointer, in which case users are expected to fall back to comparing
+     * values with @c less and @c equality.
+     */
+    virtual std::unique_ptr<const ConstantBase> decode_constant(const YAML::Node&) const
+    {
+      return nullptr;
+    }
+
+    /** @brief Compare a document node against a constant
+     *
+     * @param node The node to compare, it is decoded exactly once
+     * @param constant A constant as returned by @c decode_constant of this instance
+     */
+    virtual Ordering compare(const YAML::Node&, const ConstantBase&) const
+    {
+      return Ordering::UNORDERED;
+    }
   };
 
   /** @brief An implementation of the @c TypeItemBase interface that wraps a C++ type
@@ -55,6 +269,35 @@ namespace cerberus {
       YAML::convert<T>::decode(op2, cop2);
       return cop1 < cop2;
     }
+
+    std::unique_ptr<const ValueSetBase> make_value_set(const std::vector<YAML::Node>& nodes) const override
+    {
+      // Prefer hashing and fall back to a sorted vector for types that only provide operator<
+      return impl::make_value_set<T>(nodes, impl::is_hashable<T>{}, impl::is_less_comparable<T>{});
+    }
+
+    std::unique_ptr<const ConstantBase> decode_constant(const YAML::Node& node) const override
+    {
+      T value;
+      if(!YAML::convert<T>::decode(node, value))
+        return nullptr;
+      return std::make_unique<Constant<T>>(std::move(value));
+    }
+
+    Ordering compare(const YAML::Node& node, const ConstantBase& constant) const override
+    {
+      const auto& c = static_cast<const Constant<T>&>(constant).value;
+      T value;
+      if(!YAML::convert<T>::decode(node, value))
+        return Ordering::UNORDERED;
+      if(value < c)
+        return Ordering::LESS;
+      if(c < value)
+        return Ordering::GREATER;
+      if(value == c)
+        return Ordering::EQUAL;
+      return Ordering::UNORDERED;
+    }
   };
 
   /** @brief Register all the built-in types from cerberus 
@@ -1,29 +1,100 @@
 #ifndef CERBERUS_CPP_VALIDATOR_HH
 #define CERBERUS_CPP_VALIDATOR_HH
 
+#include<cerberus-cpp/batch.hh>
+#include<cerberus-cpp/builder.hh>
+#include<cerberus-cpp/compiled.hh>
+#include<cerberus-cpp/document.hh>
 #include<cerberus-cpp/error.hh>
+#include<cerberus-cpp/json.hh>
+#include<cerberus-cpp/profile.hh>
+#include<cerberus-cpp/regex.hh>
 #include<cerberus-cpp/rules.hh>
 #include<cerberus-cpp/stack.hh>
+#include<cerberus-cpp/threadpool.hh>
+#include<cerberus-cpp/trace.hh>
 #include<cerberus-cpp/types.hh>
 
 #include<yaml-cpp/yaml.h>
 
+#include<algorithm>
+#include<chrono>
+#include<condition_variable>
+#include<deque>
+#include<exception>
 #include<functional>
 #include<iostream>
+#include<istream>
+#include<iterator>
 #include<map>
 #include<memory>
+#include<mutex>
 #include<string>
+#include<thread>
 #include<tuple>
+#include<type_traits>
+#include<unordered_map>
+#include<utility>
 
 namespace cerberus {
 
+  //! Definition of the ways the validator can treat the validated document
+  enum class ValidationMode
+  {
+    //! Choose @c READ_ONLY for schemas without normalization rules or custom rules and @c COPY_ON_WRITE otherwise.
+    AUTOMATIC = 0,
+    //! Validate a deep copy of the document and apply normalization rules to it.
+    NORMALIZING = 1,
+    //! Validate the given document in place and skip all normalization.
+    READ_ONLY = 2,
+    //! Normalize the given document by copying only the parts that are altered.
+    COPY_ON_WRITE = 3
+  };
 
-  class Validator
+  /** @brief The validator for documents of a given document model
+   *
+   * Schemas are always given as YAML, while the validated documents may be
+   * of any document model that provides @c DocumentTraits. Most users want
+   * to use the @c Validator alias, which validates yaml-cpp documents.
+   *
+   * @tparam Document The handle type of the document model
+   */
+  template<typename Document = YAML::Node>
+  class BasicValidator
   {
+    class SchemaCompiler;
+
+    // Validators of other document models validate their schemas with a YAML validator
+    template<typename>
+    friend class BasicValidator;
+
     public:
+    class ValidationRuleInterface;
+
+    //! The type of the validated documents
+    using DocumentType = Document;
+
+    //! The result of validating a single document with @ref validateBatch
+    using ValidationResult = BasicValidationResult<Document>;
+
+    /** @brief The state of a single validation run
+     *
+     * Instances hold everything that is altered during validation, e.g. the
+     * document and schema stacks, the current policies and the errors found.
+     * Use one instance per thread together with the @c const overload of
+     * @ref validate to validate documents concurrently with a single validator.
+     */
+    using ValidationContext = ValidationRuleInterface;
+
+    //! The type of the callables that implement validation rules
+    using RuleFunction = std::function<void(ValidationRuleInterface&)>;
+
+    //! The type of compiled schemas produced by @ref compile
+    using CompiledSchema = cerberus::CompiledSchema<RuleFunction>;
+
     //! Default construct a validator instance
-    Validator()
-      : Validator(YAML::Node())
+    BasicValidator()
+      : BasicValidator(YAML::Node())
     {}
 
     /** @brief Construct a validator with a given schema
@@ -31,12 +102,14 @@ namespace cerberus {
      * @param schema The schema that this validator should be
      *               validating against.
      */
-    explicit Validator(const YAML::Node& schema)
+    explicit BasicValidator(const YAML::Node& schema)
       : schema_(schema)
-      , state(*this, YAML::Node())
+      , state(*this)
     {
       registerBuiltinRules(*this);
       registerBuiltinTypes(*this);
+      for(auto& rule : rulemapping)
+        rule.second.custom = false;
     }
 
     /** @brief Register a type for use in schemas
@@ -57,6 +130,7 @@ namespace cerberus {
     void registerType(const std::string& name)
     {
       typesmapping[name] = std::make_shared<TypeItem<T>>();
+      clearSchemaCache();
     }
 
     /** @brief Register a custom validation rule
@@ -76,7 +150,37 @@ namespace cerberus {
     void registerRule(YAML::Node schema, Rule&& rule, RulePriority priority = RulePriority::VALIDATION)
     {
       schema_schema[schema.begin()->first] = schema.begin()->second;
-      rulemapping[std::make_pair(priority, schema.begin()->first.as<std::string>())] = std::forward<Rule>(rule);
+      rulemapping[std::make_pair(priority, schema.begin()->first.as<std::string>())] = RuleImplementation{std::forward<Rule>(rule), nullptr};
+      schema_validator.reset();
+      clearSchemaCache();
+    }
+
+    /** @brief Register a custom validation rule with a preparation step
+     *
+     * This works just like the other overload of @c registerRule, but additionally
+     * registers a callable that decodes the rule's argument once when the schema
+     * is compiled. The preparation callable is given a reference to an object that
+     * provides the @c getSchema and @c getType methods known from the rule interface
+     * (where @c level=0 is the rule's argument), as well as @c compileItem and
+     * @c compileDict to compile subschemas. Its return value is stored in the compiled
+     * schema and can be accessed from the rule with @c getPreparedArgument.
+     *
+     * @param schema A YAML mapping that gives a schema that describes how the rule
+     *               is used.
+     * @param rule The callable that implements the rule.
+     * @param preparation The callable that decodes the rule's argument.
+     * @param priority specifies when in the validation process this rule is executed.
+     */
+    template<typename Rule, typename Preparation>
+    void registerRule(YAML::Node schema, Rule&& rule, Preparation&& preparation, RulePriority priority)
+    {
+      registerRule(schema, std::forward<Rule>(rule), priority);
+      rulemapping[std::make_pair(priority, schema.begin()->first.as<std::string>())].preparation =
+        [preparation = std::forward<Preparation>(preparation)](SchemaCompiler& c) -> std::shared_ptr<const PreparedArgumentBase>
+        {
+          using Argument = std::decay_t<decltype(preparation(c))>;
+          return std::make_shared<PreparedArgument<Argument>>(preparation(c));
+        };
     }
 
     /** @brief Register a schema to reference within larger schema
@@ -92,6 +196,7 @@ namespace cerberus {
     void registerSchema(const std::string& name, const YAML::Node& schema)
     {
       schema_registry[name] = YAML::Clone(schema);
+      clearSchemaCache();
     }
 
     /** @brief Set the validators policy regarding unknown values.
@@ -105,7 +210,7 @@ namespace cerberus {
      */
     void setAllowUnknown(bool value)
     {
-      state.setAllowUnknown(value);
+      allow_unknown = value;
     }
 
     /** @brief Set the validators policy regarding purging unknown values.
@@ -119,7 +224,7 @@ namespace cerberus {
      */
     void setPurgeUnknown(bool value)
     {
-      state.setPurgeUnknown(value);
+      purge_unknown = value;
     }
 
     /** @brief Set the validators policy regarding requiring all keys
@@ -131,7 +236,148 @@ namespace cerberus {
      */
     void setRequireAll(bool value)
     {
-      state.setRequireAll(value);
+      require_all = value;
+    }
+
+    /** @brief Set the maximum number of errors reported before validation stops
+     *
+     * By default, the validator traverses the entire document and reports all
+     * errors. If a limit is set, validation stops as soon as that many errors
+     * were found. Use a limit of 1 if you are only interested in whether a
+     * document is valid. Whether validation stopped early can be queried with
+     * @ref getErrorsTruncated.
+     *
+     * @param value The maximum number of errors or 0 for no limit
+     */
+    void setMaxErrors(std::size_t value)
+    {
+      max_errors = value;
+    }
+
+    //! Get the maximum number of errors reported before validation stops (0 for no limit)
+    std::size_t getMaxErrors() const
+    {
+      return max_errors;
+    }
+
+    /** @brief Set the thread pool used for validating large lists in parallel
+     *
+     * By default, lists are validated serially. With a thread pool, the
+     * elements of lists with at least as many elements as given by
+     * @ref setParallelThreshold are split into chunks that are validated
+     * concurrently. This applies to the @c schema rule for lists as well as
+     * the @c items and @c valuesrules rules. Errors are reported in the same
+     * order as with serial validation. Lists are only validated in parallel,
+     * if the document is not normalized (see @ref setValidationMode), as
+     * normalization alters the shared document.
+     *
+     * @param pool The thread pool, which may be shared with other validators
+     *             and @ref validateBatch. An empty pointer disables parallel
+     *             validation of lists.
+     */
+    void setThreadPool(std::shared_ptr<ThreadPool> pool)
+    {
+      thread_pool = std::move(pool);
+    }
+
+    /** @brief Set the number of threads used for validating large lists in parallel
+     *
+     * This creates a thread pool for the validator, see @ref setThreadPool.
+     *
+     * @param threads The number of threads (0 for the number of hardware threads).
+     *                A value of 1 disables parallel validation of lists.
+     */
+    void setParallelThreads(std::size_t threads)
+    {
+      if(threads == 1)
+        thread_pool = nullptr;
+      else
+        thread_pool = std::make_shared<ThreadPool>(threads);
+    }
+
+    /** @brief Set the minimum number of elements of lists that are validated in parallel
+     *
+     * Smaller lists are validated serially, as distributing them over
+     * threads costs more than it gains. The default is 4096.
+     *
+     * @param value The minimum number of elements
+     */
+    void setParallelThreshold(std::size_t value)
+    {
+      parallel_threshold = value;
+    }
+
+    /** @brief Enable recording the time spent in each rule
+     *
+     * Profiling needs to be compiled in by defining @c CERBERUS_CPP_PROFILING
+     * before including cerberus-cpp, e.g. with the CMake option of the same
+     * name. Otherwise, this has no effect and validation does not contain
+     * any profiling code. The profile of the last validation is available
+     * from @ref getProfile.
+     *
+     * @param value Whether rule invocations should be timed
+     */
+    void setProfiling(bool value)
+    {
+#ifdef CERBERUS_CPP_PROFILING
+      profiling = value;
+#else
+      static_cast<void>(value);
+#endif
+    }
+
+    /** @brief The profile of the last validation
+     *
+     * This is empty unless profiling is enabled with @ref setProfiling.
+     */
+    const ValidationProfile& getProfile() const
+    {
+      return state.getProfile();
+    }
+
+    /** @brief Record a timeline of the validations of this validator
+     *
+     * This attaches a trace buffer to the validation state of the validator,
+     * see @c ValidationRuleInterface::setTrace. Contexts used with the
+     * @c const overload of @ref validate have their own trace buffer.
+     *
+     * @param trace The trace buffer, which needs to outlive its use by the
+     *              validator, or @c nullptr to stop recording.
+     */
+    void setTrace(TraceBuffer* trace)
+    {
+      state.setTrace(trace);
+    }
+
+    /** @brief Whether the last validation stopped at the maximum number of errors
+     *
+     * If this is true, the reported errors may be incomplete and the document
+     * may only be partially normalized.
+     */
+    bool getErrorsTruncated() const
+    {
+      return state.isAborted();
+    }
+
+    /** @brief Set the validator's treatment of the validated document
+     *
+     * By default, the validator never alters the given document. For schemas
+     * that do not contain any normalization rules or custom rules and if the
+     * purge unknown policy is disabled, the validator validates the given
+     * document in place. Otherwise, it copies those parts of the document that
+     * normalization rules alter or that custom rules access with @c getDocument. The normalized document, which shares all unaltered
+     * parts with the given document, can be retrieved with @ref getDocument.
+     * Requesting @c ValidationMode::READ_ONLY explicitly skips all normalization,
+     * so that e.g. @c default values are not considered during validation.
+     * Requesting @c ValidationMode::NORMALIZING makes the validator work on a
+     * deep copy of the document, which is required for custom rules that alter
+     * the document without being executed with a normalization priority.
+     *
+     * @param mode The new validation mode
+     */
+    void setValidationMode(ValidationMode mode)
+    {
+      validation_mode = mode;
     }
 
     /** @brief Validate a given document
@@ -143,9 +389,11 @@ namespace cerberus {
      * @param document The document to validate
      * @returns Whether or not the validation process was successful
      */
-    bool validate(const YAML::Node& document)
+    bool validate(const Document& document)
     {
-      return validate(document, schema_);
+      if(!compiled_schema_)
+        compiled_schema_ = compile(schema_);
+      return validate(document, compiled_schema_);
     }
 
     /** @brief Validate a given document against a given schema
@@ -156,26 +404,362 @@ namespace cerberus {
      * @param schema The schema to validate against
      * @returns Whether or not the validation process was successful
      */
-    bool validate(const YAML::Node& document, const YAML::Node& schema)
+    bool validate(const Document& document, const YAML::Node& schema)
     {
-      YAML::Node validated_schema;
-      if(validate_schema)
+      return validate(document, prepare(schema));
+    }
+
+    /** @brief Validate a given document against a compiled schema
+     *
+     * This is the fastest of the end user entrypoints to perform validation,
+     * as the schema does not need to be interpreted again.
+     *
+     * @param document The document to validate
+     * @param schema The compiled schema as returned by @ref compile
+     * @returns Whether or not the validation process was successful
+     */
+    bool validate(const Document& document, const CompiledSchema& schema)
+    {
+      return validate(document, schema, state);
+    }
+
+    /** @brief Validate a given document against a compiled schema using a given context
+     *
+     * This entrypoint does not alter the validator, so that it can be called
+     * concurrently from multiple threads as long as each thread uses its own
+     * context and no rules, types or schemas are registered meanwhile. Errors
+     * and the normalized document are retrieved from the context instead of the
+     * validator. Note that with @c ValidationMode::COPY_ON_WRITE, the same document
+     * must not be validated concurrently, as its nodes are shared with the result.
+     *
+     * @param document The document to validate
+     * @param schema The compiled schema as returned by @ref compile
+     * @param context The state of this validation run, which may be reused
+     * @returns Whether or not the validation process was successful
+     */
+    bool validate(const Document& document, const CompiledSchema& schema, ValidationContext& context) const
+    {
+      auto access = DocumentAccess::MUTABLE;
+      if(validation_mode == ValidationMode::READ_ONLY)
+        access = DocumentAccess::READ_ONLY;
+      if(validation_mode == ValidationMode::COPY_ON_WRITE)
+        access = DocumentAccess::COPY_ON_WRITE;
+      if(validation_mode == ValidationMode::AUTOMATIC)
       {
-        Validator schema_validator(schema_schema);
-        schema_validator.validate_schema = false;
-        for(auto entries: schema)
+        if(schema.isNormalizing() || schema.hasCustomRules() || purge_unknown)
+          access = DocumentAccess::COPY_ON_WRITE;
+        else
+          access = DocumentAccess::READ_ONLY;
+      }
+      context.reset(document, access);
+      context.validateDict(schema.root());
+      return context.success();
+    }
+
+    /** @brief Validate a JSON document against the schema passed to the constructor
+     *
+     * @param json The JSON text of the document
+     * @returns Whether or not the validation process was successful
+     * @throws JsonError if the text is not valid JSON
+     */
+    bool validateJson(const std::string& json)
+    {
+      if(!compiled_schema_)
+        compiled_schema_ = compile(schema_);
+      return validateJson(json, compiled_schema_);
+    }
+
+    /** @brief Validate a JSON document against a given schema
+     *
+     * @param json The JSON text of the document
+     * @param schema The schema to validate against
+     * @returns Whether or not the validation process was successful
+     * @throws JsonError if the text is not valid JSON
+     */
+    bool validateJson(const std::string& json, const YAML::Node& schema)
+    {
+      return validateJson(json, prepare(schema));
+    }
+
+    /** @brief Validate a JSON document against a compiled schema
+     *
+     * The text is parsed with the @c JsonParser, which is much faster than
+     * loading JSON with yaml-cpp, and built into a document directly. The
+     * parsed document is available from @ref getDocument afterwards. This
+     * is only available for @c YAML::Node documents, documents of other
+     * models are parsed into the model first, e.g. with @c FlatDocument::loadJson.
+     *
+     * @param json The JSON text of the document
+     * @param schema The compiled schema as returned by @ref compile
+     * @returns Whether or not the validation process was successful
+     * @throws JsonError if the text is not valid JSON
+     */
+    bool validateJson(const std::string& json, const CompiledSchema& schema)
+    {
+      return validateJson(json, schema, state);
+    }
+
+    /** @brief Validate a JSON document against a compiled schema using a given context
+     *
+     * The restrictions of the @c const overload of @ref validate apply.
+     *
+     * @param json The JSON text of the document
+     * @param schema The compiled schema as returned by @ref compile
+     * @param context The state of this validation run, which may be reused
+     * @returns Whether or not the validation process was successful
+     * @throws JsonError if the text is not valid JSON
+     */
+    bool validateJson(const std::string& json, const CompiledSchema& schema, ValidationContext& context) const
+    {
+      NodeBuilder builder;
+      JsonParser(json).parse(builder);
+      return validate(builder.node(), schema, context);
+    }
+
+    /** @brief Validate many documents against a compiled schema in parallel
+     *
+     * The documents are distributed over the threads of a work-stealing
+     * thread pool, all of which share the compiled schema. Each thread
+     * validates with its own @c ValidationContext, so the restrictions
+     * of the @c const overload of @ref validate apply: Rules, types and
+     * schemas must not be registered meanwhile. If the schema normalizes,
+     * each document is cloned before validation, as the normalized document
+     * would otherwise share memory with documents validated on other threads.
+     * The given documents are therefore never modified, regardless of the
+     * validation mode, and the normalized documents are part of the results.
+     *
+     * @param documents A range of documents, e.g. a @c std::vector or a
+     *                  @c YAML::Node sequence
+     * @param schema The compiled schema as returned by @ref compile
+     * @param options The threading options
+     * @returns The results in the order of the given documents
+     */
+    template<typename Range>
+    std::vector<ValidationResult> validateBatch(const Range& documents, const CompiledSchema& schema, const BatchOptions& options = BatchOptions()) const
+    {
+      std::vector<Document> nodes;
+      for(const auto& document : documents)
+        nodes.push_back(document);
+      std::vector<ValidationResult> results(nodes.size());
+
+      std::unique_ptr<ThreadPool> batch_pool;
+      ThreadPool* pool = options.pool;
+      if(pool == nullptr)
+      {
+        batch_pool = std::make_unique<ThreadPool>(options.threads);
+        pool = batch_pool.get();
+      }
+
+      // Small documents are cheap to validate, so chunks should be large enough to hide the scheduling
+      std::size_t chunk = options.chunk_size;
+      if(chunk == 0)
+        chunk = std::min<std::size_t>(std::max<std::size_t>(nodes.size() / (16 * pool->size()), 1), 256);
+
+      std::vector<std::unique_ptr<ValidationContext>> contexts(pool->size());
+      const bool clone = schema.isNormalizing() || purge_unknown;
+      pool->parallelFor(nodes.size(), chunk, [this, clone, &nodes, &results, &schema, &contexts](std::size_t worker, std::size_t begin, std::size_t end)
+      {
+        auto& context = contexts[worker];
+        if(!context)
+          context = std::make_unique<ValidationContext>(*this);
+        for(std::size_t i = begin; i < end; ++i)
+        {
+          auto& result = results[i];
+          result.success = validate(clone ? impl::clone_document(nodes[i]) : nodes[i], schema, *context);
+          result.truncated = context->isAborted();
+          result.errors = context->getErrors();
+          impl::rebind_document(result.document, context->getDocument());
+        }
+      });
+      return results;
+    }
+
+    /** @brief Validate many documents against a given schema in parallel
+     *
+     * This works just like the overload accepting a compiled schema.
+     *
+     * @param documents A range of documents
+     * @param schema The schema to validate against
+     * @param options The threading options
+     */
+    template<typename Range>
+    std::vector<ValidationResult> validateBatch(const Range& documents, const YAML::Node& schema, const BatchOptions& options = BatchOptions())
+    {
+      return validateBatch(documents, prepare(schema), options);
+    }
+
+    /** @brief Validate many documents against the schema passed to the constructor in parallel
+     *
+     * @param documents A range of documents
+     * @param options The threading options
+     */
+    template<typename Range>
+    std::vector<ValidationResult> validateBatch(const Range& documents, const BatchOptions& options = BatchOptions())
+    {
+      if(!compiled_schema_)
+        compiled_schema_ = compile(schema_);
+      return validateBatch(documents, compiled_schema_, options);
+    }
+
+    /** @brief Validate a stream of documents in a pipeline
+     *
+     * The documents of a YAML stream, separated by @c ---, are parsed one
+     * at a time on a separate thread and validated on the threads of a thread
+     * pool. As at most @c options.queue_size documents are held in memory at
+     * once, memory usage does not grow with the length of the stream. The
+     * restrictions of @ref validateBatch apply.
+     *
+     * @param stream The input stream
+     * @param schema The compiled schema as returned by @ref compile
+     * @param callback A callable with the signature <tt>void(std::size_t index, ValidationResult&& result)</tt>.
+     *                 It is called with the results in the order of the documents.
+     *                 Calls happen on the validating threads, but never concurrently.
+     * @param options The threading options
+     * @returns The number of documents in the stream
+     */
+    template<typename Callback>
+    std::size_t validateStream(std::istream& stream, const CompiledSchema& schema, Callback&& callback, const BatchOptions& options = BatchOptions()) const
+    {
+      std::unique_ptr<ThreadPool> stream_pool;
+      ThreadPool* pool = options.pool;
+      if(pool == nullptr)
+      {
+        stream_pool = std::make_unique<ThreadPool>(options.threads);
+        pool = stream_pool.get();
+      }
+      const std::size_t capacity = (options.queue_size > 0) ? options.queue_size : 4 * pool->size();
+
+      // The state shared by the parsing thread and the validating threads
+      std::mutex mutex;
+      std::condition_variable changed;
+      std::deque<std::pair<std::size_t, YAML::Node>> queue;
+      std::map<std::size_t, ValidationResult> finished;
+      std::size_t parsed = 0;
+      std::size_t delivered = 0;
+      bool parsing = true;
+      bool delivering = false;
+      bool cancelled = false;
+      std::exception_ptr parse_error;
+
+      std::thread producer([&]()
+      {
+        try
         {
-          if(!schema_validator.validate(entries.second))
-            throw SchemaError(schema_validator);
-          validated_schema[entries.first] = schema_validator.getDocument();
+          YAML::Parser parser(stream);
+          NodeBuilder builder;
+          while(true)
+          {
+            // Documents are only parsed if there is room for them in the pipeline
+            {
+              std::unique_lock<std::mutex> lock(mutex);
+              changed.wait(lock, [&](){ return cancelled || (parsed < delivered + capacity); });
+              if(cancelled)
+                break;
+            }
+            if(!parser.HandleNextDocument(builder))
+              break;
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.emplace_back(parsed++, builder.node());
+            changed.notify_all();
+          }
+        }
+        catch(...)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          parse_error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        parsing = false;
+        changed.notify_all();
+      });
+
+      std::vector<std::unique_ptr<ValidationContext>> contexts(pool->size());
+      auto consume = [&](std::size_t worker, std::size_t, std::size_t)
+      {
+        auto& context = contexts[worker];
+        if(!context)
+          context = std::make_unique<ValidationContext>(*this);
+        try
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          while(true)
+          {
+            changed.wait(lock, [&](){ return cancelled || (!queue.empty()) || (!parsing); });
+            if(cancelled || queue.empty())
+              return;
+            const std::size_t index = queue.front().first;
+            const YAML::Node document(queue.front().second);
+            queue.pop_front();
+            lock.unlock();
+
+            ValidationResult result;
+            result.success = validate(document, schema, *context);
+            result.truncated = context->isAborted();
+            result.errors = context->getErrors();
+            result.document.reset(context->getDocument());
+
+            // Whichever thread finds the next result in order delivers it
+            lock.lock();
+            finished.emplace(index, std::move(result));
+            while((!delivering) && (!finished.empty()) && (finished.begin()->first == delivered))
+            {
+              delivering = true;
+              auto next = finished.begin();
+              ValidationResult ready(std::move(next->second));
+              finished.erase(next);
+              lock.unlock();
+              callback(delivered, std::move(ready));
+              lock.lock();
+              delivering = false;
+              ++delivered;
+              changed.notify_all();
+            }
+          }
         }
+        catch(...)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          cancelled = true;
+          changed.notify_all();
+          throw;
+        }
+      };
+
+      try
+      {
+        pool->parallelFor(pool->size(), 1, consume);
       }
-      else
-        validated_schema = schema;
+      catch(...)
+      {
+        producer.join();
+        throw;
+      }
+      producer.join();
+      if(parse_error)
+        std::rethrow_exception(parse_error);
+      return parsed;
+    }
+
+    /** @brief Validate a stream of documents against a given schema in a pipeline
+     *
+     * This works just like the overload accepting a compiled schema.
+     */
+    template<typename Callback>
+    std::size_t validateStream(std::istream& stream, const YAML::Node& schema, Callback&& callback, const BatchOptions& options = BatchOptions())
+    {
+      return validateStream(stream, prepare(schema), std::forward<Callback>(callback), options);
+    }
 
-      state.reset(document);
-      state.validateDict(validated_schema);
-      return state.success();
+    /** @brief Validate a stream of documents against the schema passed to the constructor in a pipeline
+     *
+     * This works just like the overload accepting a compiled schema.
+     */
+    template<typename Callback>
+    std::size_t validateStream(std::istream& stream, Callback&& callback, const BatchOptions& options = BatchOptions())
+    {
+      if(!compiled_schema_)
+        compiled_schema_ = compile(schema_);
+      return validateStream(stream, compiled_schema_, std::forward<Callback>(callback), options);
     }
 
     /** @brief Validate a given document against a registered schema
@@ -186,18 +770,195 @@ namespace cerberus {
      * @param schema The schema to validate against
      * @returns Whether or not the validation process was successful
      */
-    bool validate(const YAML::Node& document, const std::string& schema)
+    bool validate(const Document& document, const std::string& schema)
+    {
+      return validate(document, prepare(schema));
+    }
+
+    /** @brief Compile a schema for repeated validation
+     *
+     * The schema is validated against the rules registered with this validator
+     * and then translated into an immutable representation that applies rules
+     * without looking them up by name. Use this whenever many documents are
+     * validated against the same schema. Rules, types and schemas registered
+     * after compilation do not affect the compiled schema.
+     *
+     * @param schema The schema to compile
+     * @returns The compiled schema
+     * @throws SchemaError if the given schema is not valid
+     */
+    CompiledSchema compile(const YAML::Node& schema)
+    {
+      YAML::Node validated_schema;
+      if(validate_schema)
+      {
+        if(!schema_validator)
+        {
+          schema_validator = std::make_shared<BasicValidator<YAML::Node>>(schema_schema);
+          schema_validator->validate_schema = false;
+          schema_validator->setValidationMode(ValidationMode::NORMALIZING);
+        }
+        for(auto entries: schema)
+        {
+          if(!schema_validator->validate(entries.second))
+            throw SchemaError(*schema_validator);
+          // Keys of the schema are unique, so inserting them does not need to scan the mapping
+          validated_schema.force_insert(entries.first, schema_validator->getDocument());
+        }
+      }
+      else
+        validated_schema = schema;
+
+      auto storage = std::make_shared<typename CompiledSchema::Storage>();
+      SchemaCompiler compiler(*this, *storage);
+      storage->root = compiler.compileDict(validated_schema);
+      return CompiledSchema(storage);
+    }
+
+    /** @brief Compile a registered schema for repeated validation
+     *
+     * @param schema The name of the registered schema
+     * @returns The compiled schema
+     * @throws SchemaError if the given schema is not valid
+     */
+    CompiledSchema compile(const std::string& schema)
     {
-      return validate(document, schema_registry[schema]);
+      return compile(schema_registry[schema]);
+    }
+
+    /** @brief Compile a schema or retrieve it from the validator's schema cache
+     *
+     * This works just like @ref compile, but remembers the compiled schema
+     * by its content, so that validating and compiling happens only once
+     * per schema. All validation entrypoints that accept a schema as
+     * @c YAML::Node use this method. The cache is cleared whenever a rule,
+     * type or schema is registered.
+     *
+     * Schema nodes that were prepared before are recognized by their identity
+     * and compared with a copy of their content, which is cheaper than
+     * serializing them. Schemas altered in place are therefore compiled again.
+     * Otherwise, the content of the schema is serialized to look it up.
+     * Validating many documents against a compiled schema avoids both lookups.
+     *
+     * @param schema The schema to compile
+     * @returns The compiled schema
+     * @throws SchemaError if the given schema is not valid
+     */
+    CompiledSchema prepare(const YAML::Node& schema)
+    {
+      for(auto entry = schema_identities.begin(); entry != schema_identities.end(); ++entry)
+        if(entry->schema.is(schema))
+        {
+          if(sameContent(schema, entry->content))
+            return entry->compiled;
+          // The schema was altered in place, so it is looked up by its content again
+          schema_identities.erase(entry);
+          break;
+        }
+
+      auto key = YAML::Dump(schema);
+      auto cached = schema_cache.find(key);
+      if(cached != schema_cache.end())
+      {
+        rememberIdentity(schema, cached->second);
+        return cached->second;
+      }
+
+      auto compiled = compile(schema);
+      while((!schema_cache_order.empty()) && (schema_cache_order.size() >= schema_cache_size))
+      {
+        schema_cache.erase(schema_cache_order.front());
+        schema_cache_order.pop_front();
+      }
+      if(schema_cache_size > 0)
+      {
+        schema_cache_order.push_back(key);
+        schema_cache.emplace(std::move(key), compiled);
+        rememberIdentity(schema, compiled);
+      }
+      return compiled;
+    }
+
+    /** @brief Compile a registered schema or retrieve it from the validator's schema cache
+     *
+     * Compiled registered schemas are cached by name with the same limit as
+     * schemas given as @c YAML::Node, see @ref setSchemaCacheSize.
+     *
+     * @param schema The name of the registered schema
+     * @returns The compiled schema
+     * @throws SchemaError if the given schema is not valid
+     */
+    CompiledSchema prepare(const std::string& schema)
+    {
+      auto cached = registry_cache.find(schema);
+      if(cached != registry_cache.end())
+        return cached->second;
+
+      auto compiled = compile(schema);
+      while((!registry_cache_order.empty()) && (registry_cache_order.size() >= schema_cache_size))
+      {
+        registry_cache.erase(registry_cache_order.front());
+        registry_cache_order.pop_front();
+      }
+      if(schema_cache_size > 0)
+      {
+        registry_cache_order.push_back(schema);
+        registry_cache.emplace(schema, compiled);
+      }
+      return compiled;
+    }
+
+    /** @brief Set the maximum number of schemas in the validator's schema cache
+     *
+     * The schema cache is used by @ref prepare. If the limit is exceeded,
+     * the oldest entries are dropped. The limit applies separately to schemas
+     * given as @c YAML::Node and to registered schemas given by name. A value
+     * of 0 disables caching. The default is 64.
+     *
+     * @param size The new maximum number of cached schemas
+     */
+    void setSchemaCacheSize(std::size_t size)
+    {
+      schema_cache_size = size;
+      clearSchemaCache();
+    }
+
+    //! Drop all compiled schemas from the validator's schema cache
+    void clearSchemaCache()
+    {
+      ++schema_generation;
+      compiled_schema_ = CompiledSchema();
+      schema_cache.clear();
+      schema_cache_order.clear();
+      schema_identities.clear();
+      registry_cache.clear();
+      registry_cache_order.clear();
+    }
+
+    /** @brief Access the validator's cache of compiled regular expressions
+     *
+     * This can be used to inspect its hit and miss counters or to adjust its capacity.
+     */
+    RegexCache& getRegexCache()
+    {
+      return regex_cache;
+    }
+
+    //! Access the validator's cache of compiled regular expressions
+    const RegexCache& getRegexCache() const
+    {
+      return regex_cache;
     }
 
     /** @brief Retrieves the normalized document after validation
      *
-     * This is only valid after @ref validate has been called.
+     * This is only valid after @ref validate has been called. If validation
+     * happened in read-only mode (see @ref setValidationMode), this is the
+     * given document itself.
      *
      * @returns the validated and normalized document
      */
-    YAML::Node getDocument()
+    Document getDocument()
     {
       return state.getDocument();
     }
@@ -211,29 +972,46 @@ namespace cerberus {
       return state.printErrors(stream);
     }
 
-    private:
     /** @brief The interface that validation rules can use
      *
      * This class does the actual recursive validation of data.
      * A reference to an instance of this class is handed to the
      * validation rules. If you implement a custom rule, you should
      * have a very close look at this interface, otherwise you
-     * can consider it an implementation detail.
+     * can consider it an implementation detail. Instances also serve
+     * as @c ValidationContext for concurrent validation.
      */
     class ValidationRuleInterface
     {
       public:
+      //! The type of compiled schemas
+      using CompiledSchema = BasicValidator::CompiledSchema;
+      //! The type of compiled schema items
+      using CompiledItem = typename CompiledSchema::Item;
+      //! The type of compiled dictionary schemas
+      using CompiledDict = typename CompiledSchema::Dict;
+      //! The type of resolved rules within compiled schemas
+      using CompiledRule = typename CompiledSchema::Rule;
+
       /** @brief Construct the rule interface
        *
        * @param validator the Validator instance
        * @param document The document to validate
        */
-      ValidationRuleInterface(Validator& validator, const YAML::Node& document)
+      ValidationRuleInterface(const BasicValidator& validator, const Document& document)
         : validator(validator)
       {
-        document_stack.reset(YAML::Clone(document));
+        reset(document);
       }
 
+      /** @brief Construct a context for validation with a given validator
+       *
+       * @param validator the Validator instance
+       */
+      explicit ValidationRuleInterface(const BasicValidator& validator)
+        : ValidationRuleInterface(validator, Document())
+      {}
+
       /** @brief Report an error from the validation process
        *
        * Validation errors in cerberus-cpp do not throw exceptions or
@@ -247,46 +1025,91 @@ namespace cerberus {
        */
       void raiseError(const std::string& error)
       {
+        if(aborted)
+          return;
         errors.push_back({document_stack.stringPath(), error});
+        if((max_errors > 0) && (errors.size() >= max_errors))
+          aborted = true;
+      }
+
+      /** @brief Whether validation stops, because the maximum number of errors was reached
+       *
+       * Custom rules that iterate over subdocuments should check this and
+       * stop iterating if it is true.
+       */
+      bool isAborted() const
+      {
+        return aborted;
       }
 
       /** @brief Validates a document item
        *
        * This is the main algorithm that actually applies validation rules.
        * A custom validation rule should call this to validate the top item
-       * of the document stack against the given schema.
+       * of the document stack against the given schema. If the schema is
+       * available in compiled form, prefer the overload accepting a compiled item.
+       *
+       * The schema is compiled once per context and recognized by its identity
+       * afterwards, so it must not be altered in place in between validations.
        *
        * @param schema Will go away in favor of the schema already being pushed on the stack
        */
       void validateItem(YAML::Node schema)
       {
-        schema_stack.push_back(schema);
+        // The copy keeps the compiled schema alive, even if nested validations evict it from the cache
+        const auto subschema = compileSubschema(schema, false);
+        enableNormalization(*subschema.storage);
+        validateItem(*subschema.item);
+      }
+
+      /** @brief Validates a document item against a compiled schema item
+       *
+       * This applies the pre-resolved rules of the given item in order of
+       * their priority to the top item of the document stack.
+       *
+       * @param item The compiled schema item, e.g. from a rule's prepared argument
+       */
+      void validateItem(const CompiledItem& item)
+      {
+        const auto trace_start = trace ? TraceBuffer::Clock::now() : TraceBuffer::Clock::time_point();
+        schema_stack.push_back(item.schema);
+        const CompiledItem* parent_item = current_item;
+        current_item = &item;
 
         // Apply validation rules
-        for(const auto priority : { RulePriority::FIRST,
-                                    RulePriority::NORMALIZATION,
-                                    RulePriority::VALIDATION,
-                                    RulePriority::TYPECHECKING,
-                                    RulePriority::POST_NORMALIZATION,
-                                    RulePriority::LAST })
+        bool apply_require_all = false;
+        for(std::size_t priority = 0; priority < RulePriorityCount; ++priority)
         {
           // Implement the require all policy of the validator
-          if((priority == RulePriority::NORMALIZATION) && require_all)
-            schema["required"] = "true";
+          if((priority == static_cast<std::size_t>(RulePriority::NORMALIZATION)) && require_all)
+            apply_require_all = !item.require_all.empty();
+
+          // Skip normalization if the document must not be altered
+          const bool normalization = (priority == static_cast<std::size_t>(RulePriority::NORMALIZATION)) ||
+                                     (priority == static_cast<std::size_t>(RulePriority::POST_NORMALIZATION));
+          if(normalization && isReadOnly())
+            continue;
+          const bool parent_normalizing = normalizing;
+          normalizing = normalization;
 
-          for(auto ruleval : schema)
+          const auto& rules = item.rules[priority];
+          const bool replace_required = apply_require_all && (priority == item.require_all_priority);
+          for(std::size_t i = 0; (i < rules.size()) && (!aborted); ++i)
           {
-            auto rule = validator.rulemapping.find(std::make_pair(priority, ruleval.first.as<std::string>()));
-            if(rule != validator.rulemapping.end())
-            {
-              schema_stack.push_back(ruleval.second);
-              rule->second(*this);
-              schema_stack.pop_back();
-            }
+            if(replace_required && (static_cast<int>(i) == item.required_index))
+              applyRule(item.require_all.front(), priority);
+            else
+              applyRule(rules[i], priority);
           }
+          if(replace_required && (item.required_index < 0) && (!aborted))
+            applyRule(item.require_all.front(), priority);
+          normalizing = parent_normalizing;
         }
 
+        current_item = parent_item;
         schema_stack.pop_back();
+        if(trace)
+          recordSpan(traceNames().item, trace_start);
       }
 
       /** @brief Validates a document dictionary
@@ -295,54 +1118,96 @@ namespace cerberus {
        * and applies the main validation algorithm to each such pair.
        * A custom validation rule should call this to validate the top item
        * of the document stack against the given schema - if that item is a
-       * dictionary like e.g. the top-level document.
+       * dictionary like e.g. the top-level document. If the schema is
+       * available in compiled form, prefer the overload accepting a compiled dictionary.
+       * The schema is cached just like in @ref validateItem.
+       *
+       * @param schema Will go away in favor of the schema already being pushed on the stack
+       */
+      bool validateDict(const YAML::Node& schema)
+      {
+        // The copy keeps the compiled schema alive, even if nested validations evict it from the cache
+        const auto subschema = compileSubschema(schema, true);
+        enableNormalization(*subschema.storage);
+        return validateDict(*subschema.dict);
+      }
+
+      /** @brief Validates a document dictionary against a compiled schema
        *
-       * @param schema Will go away in favor of the schema already being pushed on the stack
+       * @param dict The compiled dictionary schema, e.g. from a rule's prepared argument
        */
-      bool validateDict(const YAML::Node& schema)
+      bool validateDict(const CompiledDict& dict)
       {
+        const auto trace_start = trace ? TraceBuffer::Clock::now() : TraceBuffer::Clock::time_point();
+
         // Store the schema in validation state to have it accessible in rules
-        schema_stack.push_back(schema);
+        schema_stack.push_back(dict.schema);
 
         // Perform validation
-        std::vector<std::string> found;
-        for(auto fieldrules : schema)
+        std::vector<std::string> renamed;
+        for(const auto& field : dict.fields)
         {
-          pushCurrentField(fieldrules.first.as<std::string>());
-          const auto& rules = fieldrules.second;
-          document_stack.pushDictItem(getCurrentField());
-          std::string oldCurrentField = getCurrentField();
-          validateItem(rules);
-          if (oldCurrentField != getCurrentField())
+          if(aborted)
+          {
+            schema_stack.pop_back();
+            if(trace)
+              recordSpan(traceNames().dict, trace_start);
+            return false;
+          }
+          pushCurrentField(field.first);
+          document_stack.pushDictItem(field.first);
+          validateItem(*field.second);
+          if (field.first != getCurrentField())
           {
-            getDocument(1).remove(oldCurrentField);
-            getDocument(1)[getCurrentField()] = getDocument();
+            if (!isReadOnly())
+              renameField(field.first, Normalizable{});
+            renamed.push_back(getCurrentField());
           }
-          found.push_back(getCurrentField());
           document_stack.pop();
           popCurrentField();
         }
 
-        if(purge_unknown && (found.size() != getDocument().size()))
+        // A document key is known if it is a field of the schema or the target of a rename
+        auto known = [&dict, &renamed](const Document& key)
         {
-          YAML::Node newnode;
-          for(auto item : getDocument())
-            if(std::find(found.begin(), found.end(), item.first.as<std::string>()) != found.end())
-              newnode[item.first] = item.second;
-          document_stack.replaceBack(newnode);
-        }
+          if(!document::is_scalar(key))
+            return false;
+          const auto& name = document::scalar(key);
+          return (dict.keys.count(name) > 0) ||
+                 (std::find(renamed.begin(), renamed.end(), name) != renamed.end());
+        };
+
+        if(purge_unknown && (!isReadOnly()) && (!aborted))
+          purgeUnknown(known, Normalizable{});
         if(!allow_unknown)
         {
-          for(auto item: getDocument())
-            if(std::find(found.begin(), found.end(), item.first.as<std::string>()) == found.end())
-              raiseError("Unknown item found in validator that does not accept unknown items: " + item.first.as<std::string>());
+          document::for_each_item(getDocument(), [this, &known](const Document& key, const Document&)
+          {
+            if((!known(key)) && (!aborted))
+              raiseError("Unknown item found in validator that does not accept unknown items: " + document::to_yaml(key).template as<std::string>());
+          });
         }
 
         schema_stack.pop_back();
+        if(trace)
+          recordSpan(traceNames().dict, trace_start);
 
         return errors.empty();
       }
 
+      /** @brief Access the argument of the current rule as decoded by its preparation
+       *
+       * This is only valid for rules that were registered with a preparation
+       * callable, which needs to return an object of type @c T.
+       *
+       * @tparam T The return type of the rule's preparation callable
+       */
+      template<typename T>
+      const T& getPreparedArgument() const
+      {
+        return static_cast<const PreparedArgument<T>&>(*(current_rule->prepared)).value;
+      }
+
       //! Print errors to a stream
       template<typename Stream>
       void printErrors(Stream& stream) const
@@ -365,9 +1230,13 @@ namespace cerberus {
        * @param name The name of the type in the @c Validator s type registry.
        * @returns an @c std::shared_ptr to the @c TypeItemBase instance
        */
-      const std::shared_ptr<TypeItemBase>& getType(const std::string& name)
+      const std::shared_ptr<TypeItemBase>& getType(const std::string& name) const
       {
-        return validator.typesmapping[name];
+        static const std::shared_ptr<TypeItemBase> unknown;
+        auto type = validator.typesmapping.find(name);
+        if(type == validator.typesmapping.end())
+          return unknown;
+        return type->second;
       }
 
       /** @brief extract a type implementation from the schema
@@ -382,8 +1251,13 @@ namespace cerberus {
        */
       const std::shared_ptr<TypeItemBase>& getType(std::size_t level = 1)
       {
-        auto type = getSchema(level)["type"].as<std::string>();
-        return validator.typesmapping[type];
+        // Use the type information resolved at compile time when asked from a rule
+        if((level == 1) && current_rule && current_item->type && (schema_stack.size() == rule_depth))
+          return current_item->type;
+
+        // Lookups on const nodes do not alter the schema, which may be shared between threads
+        const YAML::Node schema = getSchema(level);
+        return getType(schema["type"].as<std::string>());
       }
 
       /** @brief Get the YAML::Node of the schema we are currently validating against.
@@ -409,12 +1283,17 @@ namespace cerberus {
       {
         YAML::Node schema = schema_stack.get(level);
         if(is_full_schema && (schema.IsScalar()))
-          return validator.schema_registry[schema.as<std::string>()];
+        {
+          auto registered = validator.schema_registry.find(schema.Scalar());
+          if(registered == validator.schema_registry.end())
+            return YAML::Node();
+          return registered->second;
+        }
         else
           return schema;
       }
 
-      /** @brief Get the YAML::Node of the currently validated document
+      /** @brief Get the node of the currently validated document
        *
        * This is the method of choice to retrieve the document from a validation
        * rule implementation. The recursive algorithm implemented by @c ValidationRuleInterface
@@ -429,11 +1308,30 @@ namespace cerberus {
        *          needs to be validated. If @c level was given, a document
        *          further down the stack will be returned.
        */
-      YAML::Node getDocument(std::size_t level = 0)
+      Document getDocument(std::size_t level = 0)
       {
+        // Rules with normalization priority and custom rules may alter the document
+        if(normalizing || (current_rule && current_rule->custom && (rule_depth == schema_stack.size())))
+          return document_stack.getWritable(level);
         return document_stack.get(level);
       }
 
+      /** @brief Get the node of the currently validated document with the intent of altering it
+       *
+       * Validation may happen on the given document, only copying parts of it
+       * that are actually altered by normalization (see @c ValidationMode).
+       * Rules that alter the document need to use this method instead of
+       * @c getDocument to trigger this copy. For custom rules and for rules
+       * registered with @c NORMALIZATION or @c POST_NORMALIZATION priority,
+       * @c getDocument does this automatically.
+       *
+       * @param level The level of the document stack just as in the @c getDocument method.
+       */
+      Document getWritableDocument(std::size_t level = 0)
+      {
+        return document_stack.getWritable(level);
+      }
+
       /** @brief Lookup a part of the document according to a key string
        *
        * This method can be used to access subdocuments for rules that cross-reference
@@ -442,11 +1340,23 @@ namespace cerberus {
        * @param key The key to look up
        * @param level The subdocument level just as used in the @c getDocument method.
        */
-      YAML::Node getDocumentPath(const std::string& key, std::size_t level = 0)
+      Document getDocumentPath(const std::string& key, std::size_t level = 0)
       {
         return document_stack.pathLookup(key, level);
       }
 
+      /** @brief Lookup a part of the document according to a pre-parsed path
+       *
+       * This is the preferred overload, if the path was parsed in a rule's preparation.
+       *
+       * @param path The path to look up
+       * @param level The subdocument level just as used in the @c getDocument method.
+       */
+      Document getDocumentPath(const DocumentPath& path, std::size_t level = 0)
+      {
+        return document_stack.pathLookup(path, level);
+      }
+
       //! Get the validators current policy about accepting unknown values
       bool getAllowUnknown() const
       {
@@ -465,6 +1375,24 @@ namespace cerberus {
         allow_unknown = value;
       }
 
+      /** @brief Override the accepting unknown values policy for a subdocument
+       *
+       * The current value is saved, such that it can be restored by @ref popAllowUnknown.
+       * This is used by the FIRST priority part of the @c allow_unknown rule.
+       */
+      void pushAllowUnknown(bool value)
+      {
+        allow_unknown_stack.push_back(allow_unknown);
+        allow_unknown = value;
+      }
+
+      //! Restore the policy saved by @ref pushAllowUnknown
+      void popAllowUnknown()
+      {
+        allow_unknown = allow_unknown_stack.back();
+        allow_unknown_stack.pop_back();
+      }
+
       //! Get the validators current policy about purging unknown values
       bool getPurgeUnknown() const
       {
@@ -483,6 +1411,24 @@ namespace cerberus {
         purge_unknown = value;
       }
 
+      /** @brief Override the purging unknown values policy for a subdocument
+       *
+       * The current value is saved, such that it can be restored by @ref popPurgeUnknown.
+       * This is used by the FIRST priority part of the @c purge_unknown rule.
+       */
+      void pushPurgeUnknown(bool value)
+      {
+        purge_unknown_stack.push_back(purge_unknown);
+        purge_unknown = value;
+      }
+
+      //! Restore the policy saved by @ref pushPurgeUnknown
+      void popPurgeUnknown()
+      {
+        purge_unknown = purge_unknown_stack.back();
+        purge_unknown_stack.pop_back();
+      }
+
       //! Get the validator's policy about requiring all unknown values
       bool getRequireAll() const
       {
@@ -501,17 +1447,116 @@ namespace cerberus {
         require_all = value;
       }
 
+      /** @brief Override the requiring all keys policy for a subdocument
+       *
+       * The current value is saved, such that it can be restored by @ref popRequireAll.
+       * This is used by the FIRST priority part of the @c require_all rule.
+       */
+      void pushRequireAll(bool value)
+      {
+        require_all_stack.push_back(require_all);
+        require_all = value;
+      }
+
+      //! Restore the policy saved by @ref pushRequireAll
+      void popRequireAll()
+      {
+        require_all = require_all_stack.back();
+        require_all_stack.pop_back();
+      }
+
       //! Whether or not the validation process was successful
       bool success() const
       {
         return errors.empty();
       }
 
-      //! Reset the internal state to a new root document
-      void reset(const YAML::Node& document)
+      //! The errors found during the validation process
+      const std::vector<ValidationErrorItem>& getErrors() const
+      {
+        return errors;
+      }
+
+      //! The time spent in each rule during the validation process, see @c BasicValidator::setProfiling
+      const ValidationProfile& getProfile() const
+      {
+#ifdef CERBERUS_CPP_PROFILING
+        return profile;
+#else
+        // Without profiling compiled in, contexts do not hold a profile of their own
+        static const ValidationProfile empty;
+        return empty;
+#endif
+      }
+
+      /** @brief Record a timeline of the validations with this context
+       *
+       * Each @c validateDict, @c validateItem and rule invocation is recorded
+       * as a span in the given trace buffer. The buffer is kept across
+       * validations, such that it may e.g. only be attached for a sample of
+       * the validated documents. Lists are validated serially while tracing.
+       *
+       * @param trace_ The trace buffer, which needs to outlive its use by this
+       *               context, or @c nullptr to stop recording.
+       */
+      void setTrace(TraceBuffer* trace_)
+      {
+        trace = trace_;
+      }
+
+      //! The trace buffer that validations are recorded into (may be @c nullptr)
+      TraceBuffer* getTrace() const
+      {
+        return trace;
+      }
+
+      /** @brief Reset the internal state to a new root document
+       *
+       * @param document The new root document
+       * @param access_ How the document is accessed: With @c MUTABLE, a deep copy of
+       *                the document is normalized. With @c READ_ONLY, the document is
+       *                validated in place without normalization. With @c COPY_ON_WRITE,
+       *                the parts of the document that are normalized are copied.
+       */
+      void reset(const Document& document, DocumentAccess access_ = DocumentAccess::MUTABLE)
       {
         errors.clear();
-        document_stack.reset(YAML::Clone(document));
+        aborted = false;
+        max_errors = validator.max_errors;
+        allow_unknown = validator.allow_unknown;
+        purge_unknown = validator.purge_unknown;
+        require_all = validator.require_all;
+        allow_unknown_stack.clear();
+        purge_unknown_stack.clear();
+        require_all_stack.clear();
+        normalizing = false;
+        current_item = nullptr;
+        current_rule = nullptr;
+        rule_depth = 0;
+        field_depth = 0;
+        pool = validator.thread_pool.get();
+        parallel_threshold = validator.parallel_threshold;
+#ifdef CERBERUS_CPP_PROFILING
+        profiling = validator.profiling;
+        profile.clear();
+#endif
+        access = Normalizable::value ? access_ : DocumentAccess::READ_ONLY;
+        upgradable = Normalizable::value && (access == DocumentAccess::READ_ONLY) && (validator.validation_mode == ValidationMode::AUTOMATIC);
+        if(subschema_generation != validator.schema_generation)
+        {
+          subschemas.clear();
+          subschema_generation = validator.schema_generation;
+        }
+        document_stack.reset((access == DocumentAccess::MUTABLE) ? impl::clone_document(document) : document, access);
+      }
+
+      /** @brief Whether the document is validated without normalization
+       *
+       * Custom rules that alter the document should check this.
+       */
+      bool isReadOnly() const
+      {
+        return access == DocumentAccess::READ_ONLY;
       }
 
       /** @brief Record information that we are currently validating a given dictionary field
@@ -522,8 +1567,12 @@ namespace cerberus {
        */
       void pushCurrentField(const std::string& field_)
       {
-        field.push_back(field_);
-
+        // Strings in the field stack are reused to avoid allocations
+        if(field_depth == field.size())
+          field.push_back(field_);
+        else
+          field[field_depth] = field_;
+        ++field_depth;
       }
       /** @brief Record information that we are done validating a given dictionary field
        *
@@ -533,17 +1582,17 @@ namespace cerberus {
        */
       void popCurrentField()
       {
-        field.pop_back();
+        --field_depth;
       }
 
       //! Get the currently validated dictionary field
       const std::string& getCurrentField()
       {
-        return field.back();
+        return field[field_depth - 1];
       }
 
       //! Access the document stack object
-      DocumentStack& getDocumentStack()
+      BasicDocumentStack<Document>& getDocumentStack()
       {
         return document_stack;
       }
@@ -554,32 +1603,603 @@ namespace cerberus {
         return schema_stack;
       }
 
+      /** @brief Whether @ref validateElements validates a list of the given size in parallel
+       *
+       * Rules can check this to only gather what the parallel validation needs,
+       * e.g. the keys of a mapping, if it is actually going to happen.
+       */
+      bool validatesInParallel(std::size_t count) const
+      {
+        return (pool != nullptr) && (count >= std::max<std::size_t>(parallel_threshold, 2)) && isReadOnly() && (!pool->isWorkerThread()) && (!trace);
+      }
+
+      /** @brief Validate the elements of a list, possibly in parallel
+       *
+       * Rules that validate all elements of a list should use this instead
+       * of iterating themselves. If the validator has a thread pool and the
+       * list is large enough, the elements are split into chunks, each of
+       * which is validated with a separate context that is a copy of this
+       * one. The errors are merged in the order of the elements.
+       *
+       * @param count The number of elements
+       * @param body A callable with the signature <tt>void(ValidationRuleInterface& context, std::size_t i)</tt>
+       *             that validates the @c i th element with the given context, e.g.
+       *             by pushing it onto the document stack and calling @ref validateItem.
+       */
+      template<typename Body>
+      void validateElements(std::size_t count, Body&& body)
+      {
+        if(!validatesInParallel(count))
+        {
+          for(std::size_t i = 0; (i < count) && (!aborted); ++i)
+            body(*this, i);
+          return;
+        }
+        if(aborted)
+          return;
+
+        // Each chunk is limited to the errors left, so that merging them yields the errors of serial validation
+        const std::size_t chunk = std::max<std::size_t>(count / (8 * pool->size()), 1);
+        const std::size_t budget = (max_errors > 0) ? max_errors - errors.size() : 0;
+        std::vector<std::vector<ValidationErrorItem>> chunk_errors((count + chunk - 1) / chunk);
+        std::vector<std::unique_ptr<ValidationRuleInterface>> contexts(pool->size());
+        pool->parallelFor(count, chunk, [this, &body, &contexts, &chunk_errors, chunk, budget](std::size_t worker, std::size_t begin, std::size_t end)
+        {
+          auto& context = contexts[worker];
+          if(!context)
+          {
+            context = std::make_unique<ValidationRuleInterface>(validator);
+            context->seed(*this);
+          }
+          context->errors.clear();
+          context->aborted = false;
+          context->max_errors = budget;
+          for(std::size_t i = begin; (i < end) && (!context->aborted); ++i)
+            body(*context, i);
+          chunk_errors[begin / chunk].swap(context->errors);
+        });
+
+#ifdef CERBERUS_CPP_PROFILING
+        for(const auto& context : contexts)
+          if(context)
+            profile.merge(context->profile);
+#endif
+
+        for(auto& chunk_error : chunk_errors)
+          for(auto& error : chunk_error)
+          {
+            if(aborted)
+              return;
+            errors.push_back(std::move(error));
+            if((max_errors > 0) && (errors.size() >= max_errors))
+              aborted = true;
+          }
+      }
+
       private:
+      //! Copy the state of another context, such that validation can continue from its current position
+      void seed(const ValidationRuleInterface& parent)
+      {
+        document_stack.reset(parent.document_stack);
+        schema_stack.reset(parent.schema_stack);
+        access = parent.access;
+        // Workers can not switch to copy-on-write, as their copies would not reach the parent's document
+        upgradable = false;
+        normalizing = parent.normalizing;
+        allow_unknown = parent.allow_unknown;
+        purge_unknown = parent.purge_unknown;
+        require_all = parent.require_all;
+        field.assign(parent.field.begin(), parent.field.begin() + parent.field_depth);
+        field_depth = parent.field_depth;
+        current_item = parent.current_item;
+        current_rule = parent.current_rule;
+        rule_depth = parent.rule_depth;
+        // Lists within the chunk are validated serially by this context
+        pool = nullptr;
+      }
+
+      //! A schema node given to the uncompiled overloads of validateItem and validateDict
+      struct Subschema
+      {
+        YAML::Node schema;
+        YAML::Node content;
+        std::shared_ptr<typename CompiledSchema::Storage> storage;
+        const CompiledItem* item = nullptr;
+        const CompiledDict* dict = nullptr;
+      };
+
+      //! Find the compiled form of a schema node by its identity and content or compile it
+      Subschema compileSubschema(const YAML::Node& schema, bool dict)
+      {
+        auto cached = std::find_if(subschemas.begin(), subschemas.end(), [&schema](const auto& subschema){ return subschema.schema.is(schema); });
+        if((cached != subschemas.end()) && (!sameContent(schema, cached->content)))
+        {
+          // The schema was altered in place since it was compiled
+          subschemas.erase(cached);
+          cached = subschemas.end();
+        }
+        if(cached == subschemas.end())
+        {
+          while((!subschemas.empty()) && (subschemas.size() >= std::max<std::size_t>(validator.schema_cache_size, 1)))
+            subschemas.pop_front();
+          subschemas.push_back(Subschema{schema, YAML::Clone(schema), std::make_shared<typename CompiledSchema::Storage>()});
+          cached = std::prev(subschemas.end());
+        }
+
+        if(dict ? (cached->dict == nullptr) : (cached->item == nullptr))
+        {
+          SchemaCompiler compiler(validator, *cached->storage);
+          if(dict)
+            cached->dict = compiler.compileDict(schema);
+          else
+            cached->item = compiler.compileItem(schema);
+        }
+        return *cached;
+      }
+
+      //! Switch an automatically chosen read-only validation to copy-on-write, if a subschema may alter the document
+      void enableNormalization(const typename CompiledSchema::Storage& storage)
+      {
+        if(((!storage.normalizing) && (!storage.custom)) || (!upgradable) || (!isReadOnly()))
+          return;
+        access = DocumentAccess::COPY_ON_WRITE;
+        document_stack.setAccess(access);
+      }
+
+      //! Move a renamed field to its new key
+      void renameField(const std::string& name, std::true_type)
+      {
+        auto parent = getWritableDocument(1);
+        parent.remove(name);
+        parent[getCurrentField()] = getDocument();
+      }
+
+      //! Documents of other models are never normalized
+      void renameField(const std::string&, std::false_type)
+      {}
+
+      //! Remove the keys of the current mapping that are not known to the schema
+      template<typename Known>
+      void purgeUnknown(const Known& known, std::true_type)
+      {
+        std::vector<YAML::Node> unknown;
+        for(auto item : getDocument())
+          if(!known(item.first))
+            unknown.push_back(item.first);
+        if(!unknown.empty())
+        {
+          auto document = getWritableDocument();
+          for(const auto& key : unknown)
+            document.remove(key);
+        }
+      }
+
+      template<typename Known>
+      void purgeUnknown(const Known&, std::false_type)
+      {}
+
+      void applyRule(const CompiledRule& rule, std::size_t priority)
+      {
+        schema_stack.push_back(rule.argument);
+        const CompiledRule* parent_rule = current_rule;
+        const std::size_t parent_depth = rule_depth;
+        current_rule = &rule;
+        rule_depth = schema_stack.size();
+        const auto trace_start = trace ? TraceBuffer::Clock::now() : TraceBuffer::Clock::time_point();
+#ifdef CERBERUS_CPP_PROFILING
+        if(profiling)
+        {
+          const auto start = std::chrono::steady_clock::now();
+          rule.function(*this);
+          profile.record(static_cast<RulePriority>(priority), rule.name, std::chrono::steady_clock::now() - start,
+                         [this](){ return document_stack.stringPath(); },
+                         [this, &rule](){ return schemaPath(rule); });
+        }
+        else
+#else
+        static_cast<void>(priority);
+#endif
+        rule.function(*this);
+        if(trace)
+          recordSpan(rule.name, trace_start);
+        current_rule = parent_rule;
+        rule_depth = parent_depth;
+        schema_stack.pop_back();
+      }
+
+      //! The location of a rule of the current item in the schema, e.g. @c ^users.schema.name.regex
+      std::string schemaPath(const CompiledRule& rule) const
+      {
+        std::string path = current_item ? current_item->path : std::string("^");
+        if(path != "^")
+          path += '.';
+        return path + rule.name;
+      }
+
+      //! The names of the spans recorded for the validation algorithms
+      struct TraceNames
+      {
+        std::string dict = "validateDict";
+        std::string item = "validateItem";
+      };
+
+      static const TraceNames& traceNames()
+      {
+        static const TraceNames names;
+        return names;
+      }
+
+      //! Record a span that ends now for the current document item
+      void recordSpan(const std::string& name, TraceBuffer::Clock::time_point start)
+      {
+        trace->record(name, start, TraceBuffer::Clock::now(), [this](std::string& path){ document_stack.writePath(path); });
+      }
+
       DocumentStack schema_stack;
-      DocumentStack document_stack;
-      Validator& validator;
+      BasicDocumentStack<Document> document_stack;
+      const BasicValidator& validator;
       std::vector<ValidationErrorItem> errors;
+      std::size_t max_errors = 0;
+      bool aborted = false;
       bool allow_unknown = false;
       bool purge_unknown = false;
       bool require_all = false;
+      std::vector<bool> allow_unknown_stack;
+      std::vector<bool> purge_unknown_stack;
+      std::vector<bool> require_all_stack;
+      DocumentAccess access = DocumentAccess::MUTABLE;
+      bool upgradable = false;
+      std::deque<Subschema> subschemas;
+      std::size_t subschema_generation = 0;
+      bool normalizing = false;
       std::vector<std::string> field;
+      std::size_t field_depth = 0;
+      const CompiledItem* current_item = nullptr;
+      const CompiledRule* current_rule = nullptr;
+      std::size_t rule_depth = 0;
+      ThreadPool* pool = nullptr;
+      std::size_t parallel_threshold = 0;
+#ifdef CERBERUS_CPP_PROFILING
+      bool profiling = false;
+      ValidationProfile profile;
+#endif
+      TraceBuffer* trace = nullptr;
+    };
+
+    private:
+    //! Only YAML documents can be normalized, documents of other models are validated read-only
+    using Normalizable = std::is_same<Document, YAML::Node>;
+
+    //! A schema node that was prepared before together with a copy of its content at that time
+    struct SchemaIdentity
+    {
+      YAML::Node schema;
+      YAML::Node content;
+      CompiledSchema compiled;
+    };
+
+    //! Remember the compiled schema of a schema node, such that @ref prepare finds it without serializing the node
+    void rememberIdentity(const YAML::Node& schema, const CompiledSchema& compiled)
+    {
+      while((!schema_identities.empty()) && (schema_identities.size() >= schema_cache_size))
+        schema_identities.pop_front();
+      if(schema_cache_size > 0)
+        schema_identities.push_back(SchemaIdentity{schema, YAML::Clone(schema), compiled});
+    }
+
+    //! Whether two YAML nodes have the same content, which YAML::Node::operator== does not compare
+    static bool sameContent(const YAML::Node& a, const YAML::Node& b)
+    {
+      if((a.Type() != b.Type()) || (a.Tag() != b.Tag()))
+        return false;
+      if(a.IsScalar())
+        return a.Scalar() == b.Scalar();
+      if((!a.IsSequence()) && (!a.IsMap()))
+        return true;
+      if(a.size() != b.size())
+        return false;
+
+      auto other = b.begin();
+      for(auto i = a.begin(); i != a.end(); ++i, ++other)
+      {
+        const bool same = a.IsMap() ? (sameContent(i->first, other->first) && sameContent(i->second, other->second))
+                                    : sameContent(*i, *other);
+        if(!same)
+          return false;
+      }
+      return true;
+    }
+
+    //! The implementation of a rule as given to registerRule
+    struct RuleImplementation
+    {
+      RuleFunction function;
+      std::function<std::shared_ptr<const PreparedArgumentBase>(SchemaCompiler&)> preparation;
+      //! Built-in rules only alter the document with normalization priorities
+      bool custom = true;
+    };
+
+    /** @brief The translation of schemas into their compiled representation
+     *
+     * An instance of this class is also handed to the preparation callables
+     * of rules, which can use it to decode their arguments and compile subschemas.
+     */
+    class SchemaCompiler
+    {
+      public:
+      //! The type of compiled schemas
+      using CompiledSchema = BasicValidator::CompiledSchema;
+      //! The type of compiled schema items
+      using CompiledItem = typename CompiledSchema::Item;
+      //! The type of compiled dictionary schemas
+      using CompiledDict = typename CompiledSchema::Dict;
+      //! The type of resolved rules within compiled schemas
+      using CompiledRule = typename CompiledSchema::Rule;
+
+      /** @brief Construct a compiler
+       *
+       * @param validator The validator whose rules, types and schemas are used
+       * @param storage The storage that compiled items are added to
+       */
+      SchemaCompiler(const BasicValidator& validator, typename CompiledSchema::Storage& storage)
+        : validator(validator)
+        , storage(storage)
+      {}
+
+      /** @brief Compile a schema item, i.e. the rules that apply to a field
+       *
+       * @param schema The rules mapping or the name of a registered schema
+       */
+      const CompiledItem* compileItem(const YAML::Node& schema)
+      {
+        if(schema.IsScalar())
+        {
+          auto registered = registered_items.find(schema.Scalar());
+          if(registered != registered_items.end())
+            return registered->second;
+          storage.items.emplace_back();
+          auto& compiled = storage.items.back();
+          registered_items[schema.Scalar()] = &compiled;
+          // Registered schemas are compiled once, so they are located by their name
+          std::string parent_path;
+          parent_path.swap(path);
+          path = schema.Scalar();
+          fillItem(compiled, lookupSchema(schema.Scalar()));
+          path.swap(parent_path);
+          return &compiled;
+        }
+
+        storage.items.emplace_back();
+        auto& compiled = storage.items.back();
+        fillItem(compiled, schema);
+        return &compiled;
+      }
+
+      /** @brief Compile a dictionary schema, i.e. a mapping of field names to rules
+       *
+       * @param schema The dictionary schema or the name of a registered schema
+       */
+      const CompiledDict* compileDict(const YAML::Node& schema)
+      {
+        if(schema.IsScalar())
+        {
+          auto registered = registered_dicts.find(schema.Scalar());
+          if(registered != registered_dicts.end())
+            return registered->second;
+          storage.dicts.emplace_back();
+          auto& compiled = storage.dicts.back();
+          registered_dicts[schema.Scalar()] = &compiled;
+          // Registered schemas are compiled once, so they are located by their name
+          std::string parent_path;
+          parent_path.swap(path);
+          path = schema.Scalar();
+          fillDict(compiled, lookupSchema(schema.Scalar()));
+          path.swap(parent_path);
+          return &compiled;
+        }
+
+        storage.dicts.emplace_back();
+        auto& compiled = storage.dicts.back();
+        fillDict(compiled, schema);
+        return &compiled;
+      }
+
+      /** @brief Get the schema snippet of the rule currently prepared
+       *
+       * @param level @c level=0 delivers the rule's argument, @c level=1 the
+       *              rules mapping of the item that the rule belongs to.
+       * @param is_full_schema Whether a registered schema should be looked
+       *                       up if the snippet is a scalar.
+       */
+      YAML::Node getSchema(std::size_t level = 0, bool is_full_schema = false) const
+      {
+        YAML::Node schema = (level == 0) ? argument : item->schema;
+        if(is_full_schema && schema.IsScalar())
+          return lookupSchema(schema.Scalar());
+        return schema;
+      }
+
+      /** @brief Get the type implementation of the item that the rule belongs to
+       *
+       * This may return an empty pointer, if no type (or a list of types) is given.
+       */
+      const std::shared_ptr<TypeItemBase>& getType(std::size_t = 1) const
+      {
+        return item->type;
+      }
+
+      /** @brief Get a type implementation for an explicitly known type
+       *
+       * This returns an empty pointer for unknown types.
+       */
+      std::shared_ptr<TypeItemBase> getType(const std::string& name) const
+      {
+        auto type = validator.typesmapping.find(name);
+        if(type == validator.typesmapping.end())
+          return nullptr;
+        return type->second;
+      }
+
+      /** @brief Get a compiled regular expression from the validator's cache
+       *
+       * @param pattern The regular expression pattern
+       */
+      std::shared_ptr<const std::regex> getRegex(const std::string& pattern)
+      {
+        return validator.regex_cache.get(pattern);
+      }
+
+      private:
+      YAML::Node lookupSchema(const std::string& name) const
+      {
+        auto schema = validator.schema_registry.find(name);
+        if(schema == validator.schema_registry.end())
+          return YAML::Node();
+        return schema->second;
+      }
+
+      void fillItem(CompiledItem& compiled, const YAML::Node& schema)
+      {
+        compiled.schema = schema;
+        compiled.path = path;
+        if(!schema.IsMap())
+          return;
+
+        auto typenode = schema["type"];
+        if(typenode && typenode.IsScalar())
+          compiled.type = getType(typenode.Scalar());
+
+        for(auto ruleval : schema)
+        {
+          auto name = ruleval.first.as<std::string>();
+          for(std::size_t priority = 0; priority < RulePriorityCount; ++priority)
+          {
+            auto rule = validator.rulemapping.find(std::make_pair(static_cast<RulePriority>(priority), name));
+            if(rule != validator.rulemapping.end())
+            {
+              if((priority == static_cast<std::size_t>(RulePriority::NORMALIZATION)) ||
+                 (priority == static_cast<std::size_t>(RulePriority::POST_NORMALIZATION)) ||
+                 (name == "purge_unknown"))
+                storage.normalizing = true;
+              else if(rule->second.custom)
+                storage.custom = true;
+              if(name == "required")
+                compiled.required_index = static_cast<int>(compiled.rules[priority].size());
+              compiled.rules[priority].push_back(compileRule(compiled, name, rule->second, ruleval.second));
+            }
+          }
+        }
+
+        // Prepare the rule that implements the require all policy
+        for(std::size_t priority = 0; priority < RulePriorityCount; ++priority)
+        {
+          auto rule = validator.rulemapping.find(std::make_pair(static_cast<RulePriority>(priority), std::string("required")));
+          if(rule != validator.rulemapping.end())
+          {
+            compiled.require_all.push_back(compileRule(compiled, "required", rule->second, YAML::Node("true")));
+            compiled.require_all_priority = priority;
+            break;
+          }
+        }
+      }
+
+      void fillDict(CompiledDict& compiled, const YAML::Node& schema)
+      {
+        compiled.schema = schema;
+        for(auto fieldrules : schema)
+        {
+          const auto name = fieldrules.first.as<std::string>();
+          const std::size_t parent_length = pushPath(name);
+          compiled.fields.emplace_back(name, compileItem(fieldrules.second));
+          compiled.keys.insert(compiled.fields.back().first);
+          path.resize(parent_length);
+        }
+      }
+
+      CompiledRule compileRule(const CompiledItem& compiled, const std::string& name, const RuleImplementation& implementation, const YAML::Node& arg)
+      {
+        CompiledRule rule{name, implementation.function, arg, nullptr, implementation.custom};
+        if(implementation.preparation)
+        {
+          // Note that YAML::Node::reset is needed to rebind, assignment would alter the schema
+          const CompiledItem* parent_item = item;
+          YAML::Node parent_argument = argument;
+          item = &compiled;
+          argument.reset(arg);
+          const std::size_t parent_length = pushPath(name);
+          rule.prepared = implementation.preparation(*this);
+          path.resize(parent_length);
+          item = parent_item;
+          argument.reset(parent_argument);
+        }
+        return rule;
+      }
+
+      //! Append a segment to the location in the schema and return the previous length of the location
+      std::size_t pushPath(const std::string& segment)
+      {
+        const std::size_t length = path.size();
+        if(path != "^")
+          path += '.';
+        path += segment;
+        return length;
+      }
+
+      const BasicValidator& validator;
+      typename CompiledSchema::Storage& storage;
+      std::map<std::string, const CompiledItem*> registered_items;
+      std::map<std::string, const CompiledDict*> registered_dicts;
+      const CompiledItem* item = nullptr;
+      YAML::Node argument;
+      // The location in the schema of what is currently compiled
+      std::string path = "^";
     };
 
     YAML::Node schema_;
     ValidationRuleInterface state;
 
-    std::map<std::pair<RulePriority, std::string>, std::function<void(ValidationRuleInterface&)>> rulemapping;
+    std::map<std::pair<RulePriority, std::string>, RuleImplementation> rulemapping;
     std::map<std::string, std::shared_ptr<TypeItemBase>, std::less<>> typesmapping;
     std::map<std::string, YAML::Node, std::less<>> schema_registry;
 
     // The schema that is used to validate user provided schemas.
     // This is update with snippets as rules are registered
     YAML::Node schema_schema;
+    std::shared_ptr<BasicValidator<YAML::Node>> schema_validator;
     bool validate_schema = true;
+
+    // The cache of compiled schemas, see the prepare method
+    CompiledSchema compiled_schema_;
+    std::unordered_map<std::string, CompiledSchema> schema_cache;
+    std::deque<std::string> schema_cache_order;
+    std::deque<SchemaIdentity> schema_identities;
+    std::map<std::string, CompiledSchema, std::less<>> registry_cache;
+    std::deque<std::string> registry_cache_order;
+    std::size_t schema_cache_size = 64;
+    // Contexts drop the subschemas they compiled themselves if this changes
+    std::size_t schema_generation = 0;
+
+    ValidationMode validation_mode = ValidationMode::AUTOMATIC;
+    bool allow_unknown = false;
+    bool purge_unknown = false;
+    bool require_all = false;
+    std::size_t max_errors = 0;
+    std::shared_ptr<ThreadPool> thread_pool;
+    std::size_t parallel_threshold = 4096;
+#ifdef CERBERUS_CPP_PROFILING
+    bool profiling = false;
+#endif
+
+    // The regex cache is used when compiling schemas, which may happen during const validation
+    mutable RegexCache regex_cache;
   };
 
+  //! The validator for YAML documents
+  using Validator = BasicValidator<>;
+
   //! overload stream operator for easy printing of errors
-  std::ostream& operator<<(std::ostream& stream, const Validator& v)
+  template<typename Document>
+  std::ostream& operator<<(std::ostream& stream, const BasicValidator<Document>& v)
   {
     v.printErrors(stream);
     return stream;
@@ -0,0 +1,106 @@
+#include<cerberus-cpp/codegen.hh>
+#include<yaml-cpp/yaml.h>
+
+#include<fstream>
+#include<iostream>
+#include<sstream>
+#include<string>
+#include<vector>
+
+// Generates validators for all read-only test cases of testdata.yml, such that
+// the tests can compare them against the interpreting validator.
+// Usage: generatevalidators testdata.yml output.hh
+
+int main(int argc, char** argv)
+{
+  if(argc != 3)
+  {
+    std::cerr << "Usage: " << argv[0] << " testdata.yml output.hh" << std::endl;
+    return 2;
+  }
+
+  std::ostringstream code, table;
+  std::size_t count = 0;
+  for(auto testcase : YAML::LoadFile(argv[1]))
+  {
+    const auto name = testcase.first.as<std::string>();
+    auto spec = testcase.second;
+    if(spec["purge_unknown"].as<bool>(false))
+      continue;
+
+    cerberus::Validator validator;
+    cerberus::CodeGenerator generator;
+    for(auto schema : spec["registry"])
+    {
+      validator.registerSchema(schema.first.as<std::string>(), schema.second);
+      generator.registerSchema(schema.first.as<std::string>(), schema.second);
+    }
+
+    // Generated validators do not normalize
+    if(validator.compile(spec["schema"]).isNormalizing())
+      continue;
+
+    const std::string validator_name = "Case" + std::to_string(count++);
+    try
+    {
+      code << generator.generate(spec["schema"], validator_name) << "\n";
+    }
+    catch(const cerberus::CodegenError& e)
+    {
+      std::cerr << "Skipping " << name << ": " << e.what() << std::endl;
+      --count;
+      continue;
+    }
+    table << "    {\"" << name << "\", {&run<" << validator_name << ", YAML::Node>, &run<" << validator_name << ", cerberus::FlatNode>}},\n";
+  }
+
+  std::ofstream out(argv[2]);
+  out << "// This file was generated by generatevalidators, do not edit\n"
+      << "#ifndef CERBERUS_CPP_TEST_VALIDATORS_HH\n"
+      << "#define CERBERUS_CPP_TEST_VALIDATORS_HH\n"
+      << "\n"
+      << "#include<cerberus-cpp/flat.hh>\n"
+      << "#include<cerberus-cpp/generated.hh>\n"
+      << "#include<yaml-cpp/yaml.h>\n"
+      << "\n"
+      << "#include<cstddef>\n"
+      << "#include<map>\n"
+      << "#include<ostream>\n"
+      << "#include<regex>\n"
+      << "#include<string>\n"
+      << "#include<vector>\n"
+      << "\n"
+      << "namespace testvalidators {\n"
+      << "\n"
+      << code.str()
+      << "template<typename Validator, typename Document>\n"
+      << "bool run(const Document& document, bool allow_unknown, bool require_all, std::ostream& errors)\n"
+      << "{\n"
+      << "  Validator validator;\n"
+      << "  validator.setAllowUnknown(allow_unknown);\n"
+      << "  validator.setRequireAll(require_all);\n"
+      << "  const bool valid = validator.validate(document);\n"
+      << "  validator.printErrors(errors);\n"
+      << "  return valid;\n"
+      << "}\n"
+      << "\n"
+      << "struct Entry\n"
+      << "{\n"
+      << "  bool (*yaml)(const YAML::Node&, bool, bool, std::ostream&);\n"
+      << "  bool (*flat)(const cerberus::FlatNode&, bool, bool, std::ostream&);\n"
+      << "};\n"
+      << "\n"
+      << "//! The generated validators by test case name\n"
+      << "inline const std::map<std::string, Entry>& validators()\n"
+      << "{\n"
+      << "  static const std::map<std::string, Entry> table = {\n"
+      << table.str()
+      << "  };\n"
+      << "  return table;\n"
+      << "}\n"
+      << "\n"
+      << "} // namespace testvalidators\n"
+      << "\n"
+      << "#endif\n";
+  return out ? 0 : 1;
+}
@@ -1,9 +1,27 @@
 #define CATCH_CONFIG_MAIN
 #include"catch2/catch.hpp"
 
+#include<cerberus-cpp/codegen.hh>
+#include<cerberus-cpp/dsl.hh>
+#include<cerberus-cpp/flat.hh>
+#include<cerberus-cpp/streaming.hh>
 #include<cerberus-cpp/validator.hh>
 #include<yaml-cpp/yaml.h>
 
+#include"testvalidators.hh"
+#ifdef CERBERUS_CPP_TEST_CODEGEN
+#include"Person.hh"
+#endif
+
+#include<algorithm>
+#include<map>
+#include<memory>
+#include<regex>
+#include<sstream>
+#include<stdexcept>
+#include<thread>
+#include<vector>
+
 static const YAML::Node testdata = YAML::LoadFile("testdata.yml");
 static const YAML::Node illschemas = YAML::LoadFile("illformedschemas.yml");
 
@@ -12,6 +30,160 @@ class CustomValidator
   : public cerberus::Validator
 {};
 
+// A custom type that is ordered, but not hashable
+struct Year {
+  int year;
+  bool operator<(const Year& other) const { return year < other.year; }
+  bool operator==(const Year& other) const { return year == other.year; }
+};
+
+namespace YAML {
+  template<>
+  struct convert<Year>
+  {
+    static Node encode(const Year& rhs)
+    {
+      return Node(rhs.year);
+    }
+
+    static bool decode(const Node& node, Year& rhs)
+    {
+      return convert<int>::decode(node, rhs.year);
+    }
+  };
+}
+
+// A minimal document model that is not YAML, validated through document traits
+struct Value {
+  enum Kind { NUL, SCALAR, SEQUENCE, MAP } kind = NUL;
+  std::string scalar;
+  std::vector<Value> elements;
+  std::vector<std::pair<Value, Value>> items;
+};
+
+Value fromYaml(const YAML::Node& node)
+{
+  Value value;
+  if(node.IsScalar())
+  {
+    value.kind = Value::SCALAR;
+    value.scalar = node.Scalar();
+  }
+  if(node.IsSequence())
+  {
+    value.kind = Value::SEQUENCE;
+    for(auto element : node)
+      value.elements.push_back(fromYaml(element));
+  }
+  if(node.IsMap())
+  {
+    value.kind = Value::MAP;
+    for(auto item : node)
+      value.items.emplace_back(fromYaml(item.first), fromYaml(item.second));
+  }
+  return value;
+}
+
+// Write a YAML document as JSON, scalars that are valid JSON numbers or booleans are not quoted
+std::string toJson(const YAML::Node& node)
+{
+  if(node.IsMap())
+  {
+    std::string json = "{";
+    for(auto item : node)
+      json += (json.size() > 1 ? ", " : "") + toJson(YAML::Node(item.first.Scalar())) + ": " + toJson(item.second);
+    return json + "}";
+  }
+  if(node.IsSequence())
+  {
+    std::string json = "[";
+    for(auto element : node)
+      json += (json.size() > 1 ? ", " : "") + toJson(element);
+    return json + "]";
+  }
+  if(!node.IsScalar())
+    return "null";
+
+  static const std::regex literal("-?(0|[1-9][0-9]*)(\\.[0-9]+)?([eE][+-]?[0-9]+)?|true|false");
+  if((node.Tag() != "!") && std::regex_match(node.Scalar(), literal))
+    return node.Scalar();
+  std::string json = "\"";
+  for(char c : node.Scalar())
+  {
+    if((c == '"') || (c == '\\'))
+      json += std::string("\\") + c;
+    else if(c == '\n')
+      json += "\\n";
+    else
+      json += c;
+  }
+  return json + "\"";
+}
+
+namespace cerberus {
+  template<>
+  struct DocumentTraits<const Value*>
+  {
+    static const Value* undefined() { return nullptr; }
+    static bool is_defined(const Value* v) { return v != nullptr; }
+    static bool is_null(const Value* v) { return v && (v->kind == Value::NUL); }
+    static bool is_scalar(const Value* v) { return v && (v->kind == Value::SCALAR); }
+    static bool is_sequence(const Value* v) { return v && (v->kind == Value::SEQUENCE); }
+    static bool is_map(const Value* v) { return v && (v->kind == Value::MAP); }
+
+    static std::size_t size(const Value* v)
+    {
+      return v ? v->elements.size() + v->items.size() : 0;
+    }
+
+    static const Value* lookup(const Value* v, const std::string& key)
+    {
+      if(is_map(v))
+        for(const auto& item : v->items)
+          if((item.first.kind == Value::SCALAR) && (item.first.scalar == key))
+            return &item.second;
+      return nullptr;
+    }
+
+    static const Value* element(const Value* v, std::size_t i)
+    {
+      return (is_sequence(v) && (i < v->elements.size())) ? &v->elements[i] : nullptr;
+    }
+
+    template<typename F>
+    static void for_each_item(const Value* v, F&& f)
+    {
+      if(is_map(v))
+        for(const auto& item : v->items)
+          f(&item.first, &item.second);
+    }
+
+    template<typename F>
+    static void for_each_element(const Value* v, F&& f)
+    {
+      if(is_sequence(v))
+        for(const auto& element : v->elements)
+          f(&element);
+    }
+
+    static const std::string& scalar(const Value* v) { return v->scalar; }
+
+    static YAML::Node to_yaml(const Value* v)
+    {
+      if(!v)
+        return YAML::Node(YAML::NodeType::Undefined);
+      if(v->kind == Value::SCALAR)
+        return YAML::Node(v->scalar);
+      YAML::Node node(v->kind == Value::MAP ? YAML::NodeType::Map : (v->kind == Value::SEQUENCE ? YAML::NodeType::Sequence : YAML::NodeType::Null));
+      for(const auto& element : v->elements)
+        node.push_back(to_yaml(&element));
+      for(const auto& item : v->items)
+        node.force_insert(to_yaml(&item.first), to_yaml(&item.second));
+      return node;
+    }
+  };
+}
+
 TEMPLATE_TEST_CASE("Performing standard validation", "[validate]", cerberus::Validator, CustomValidator) {
   TestType validator;
   for(auto testcase : testdata)
@@ -43,6 +215,1397 @@ TEMPLATE_TEST_CASE("Performing standard validation", "[validate]", cerberus::Val
   }
 }
 
+TEMPLATE_TEST_CASE("Validating against compiled schemas", "[compile]", cerberus::Validator, CustomValidator) {
+  TestType validator;
+  for(auto testcase : testdata)
+  {
+    auto name = testcase.first;
+    SECTION(name.as<std::string>()) {
+      auto spec = testcase.second;
+
+      validator.setAllowUnknown(spec["allow_unknown"].as<bool>(false));
+      validator.setPurgeUnknown(spec["purge_unknown"].as<bool>(false));
+      validator.setRequireAll(spec["require_all"].as<bool>(false));
+      for (auto schema : spec["registry"])
+        validator.registerSchema(schema.first.as<std::string>(), schema.second);
+      auto compiled = validator.compile(spec["schema"]);
+
+      for (auto data : spec["success"])
+        REQUIRE(validator.validate(data, compiled));
+      for (auto data : spec["failure"])
+        REQUIRE(!validator.validate(data, compiled));
+    }
+  }
+}
+
+TEST_CASE("Validating other document models", "[traits]") {
+  for(auto testcase : testdata)
+  {
+    auto name = testcase.first;
+    SECTION(name.as<std::string>()) {
+      auto spec = testcase.second;
+
+      cerberus::BasicValidator<const Value*> validator;
+      validator.setAllowUnknown(spec["allow_unknown"].as<bool>(false));
+      validator.setRequireAll(spec["require_all"].as<bool>(false));
+      for (auto schema : spec["registry"])
+        validator.registerSchema(schema.first.as<std::string>(), schema.second);
+      auto compiled = validator.compile(spec["schema"]);
+
+      // Other document models are validated read-only, so normalization is not available
+      if(compiled.isNormalizing() || spec["purge_unknown"].as<bool>(false))
+        continue;
+
+      cerberus::Validator reference;
+      reference.setAllowUnknown(spec["allow_unknown"].as<bool>(false));
+      reference.setRequireAll(spec["require_all"].as<bool>(false));
+      for (auto schema : spec["registry"])
+        reference.registerSchema(schema.first.as<std::string>(), schema.second);
+
+      std::vector<std::pair<YAML::Node, bool>> cases;
+      for (auto data : spec["success"])
+        cases.push_back({data, true});
+      for (auto data : spec["failure"])
+        cases.push_back({data, false});
+
+      for (auto dataset : cases)
+      {
+        const Value document = fromYaml(dataset.first);
+        INFO("Validating the following document\n" << dataset.first);
+        REQUIRE(validator.validate(&document, compiled) == dataset.second);
+
+        // The errors are the same as for the YAML document
+        REQUIRE(!reference.validate(dataset.first, spec["schema"]) == !dataset.second);
+        std::stringstream expected, errors;
+        reference.printErrors(expected);
+        validator.printErrors(errors);
+        REQUIRE(errors.str() == expected.str());
+      }
+    }
+  }
+}
+
+TEST_CASE("Validating flat documents", "[flat]") {
+  for(auto testcase : testdata)
+  {
+    auto name = testcase.first;
+    SECTION(name.as<std::string>()) {
+      auto spec = testcase.second;
+
+      cerberus::FlatValidator validator;
+      validator.setAllowUnknown(spec["allow_unknown"].as<bool>(false));
+      validator.setRequireAll(spec["require_all"].as<bool>(false));
+      for (auto schema : spec["registry"])
+        validator.registerSchema(schema.first.as<std::string>(), schema.second);
+      auto compiled = validator.compile(spec["schema"]);
+
+      // Flat documents are read-only, so normalization is not available
+      if(compiled.isNormalizing() || spec["purge_unknown"].as<bool>(false))
+        continue;
+
+      cerberus::Validator reference;
+      reference.setAllowUnknown(spec["allow_unknown"].as<bool>(false));
+      reference.setRequireAll(spec["require_all"].as<bool>(false));
+      for (auto schema : spec["registry"])
+        reference.registerSchema(schema.first.as<std::string>(), schema.second);
+
+      std::vector<std::pair<YAML::Node, bool>> cases;
+      for (auto data : spec["success"])
+        cases.push_back({data, true});
+      for (auto data : spec["failure"])
+        cases.push_back({data, false});
+
+      for (auto dataset : cases)
+      {
+        auto document = cerberus::FlatDocument::fromYaml(dataset.first);
+        INFO("Validating the following document\n" << dataset.first);
+        REQUIRE(validator.validate(document.root(), compiled) == dataset.second);
+
+        reference.validate(dataset.first, spec["schema"]);
+        std::stringstream expected, errors;
+        reference.printErrors(expected);
+        validator.printErrors(errors);
+        REQUIRE(errors.str() == expected.str());
+      }
+    }
+  }
+}
+
+TEST_CASE("Flat documents are loaded from YAML and JSON", "[flat]") {
+  auto document = cerberus::FlatDocument::load(
+    "name: test                  \n"
+    "records:                    \n"
+    "  - &r {id: 1, tags: [a, b]}\n"
+    "  - {id: 2, tags: []}       \n"
+    "  - *r                      \n"
+    "empty: ~                    \n"
+    "id: 3                       \n"
+  );
+  auto root = document.root();
+  REQUIRE(root.isMap());
+  REQUIRE(root.size() == 4);
+  REQUIRE(root["name"].scalar() == "test");
+  REQUIRE(root["empty"].isNull());
+  REQUIRE(!root["missing"].isDefined());
+  REQUIRE(!root["name"]["id"].isDefined());
+  REQUIRE(root["records"].size() == 3);
+  REQUIRE(root["records"][2]["tags"][1].scalar() == "b");
+  REQUIRE(!root["records"][3].isDefined());
+
+  // Keys are interned and entries are iterated in the order of the document
+  std::vector<std::string> keys;
+  const std::string* id = nullptr;
+  root.forEachItem([&keys, &id](const cerberus::FlatNode& key, const cerberus::FlatNode&)
+  {
+    keys.push_back(key.scalar());
+    if(key.scalar() == "id")
+      id = &key.scalar();
+  });
+  REQUIRE(keys == std::vector<std::string>{"name", "records", "empty", "id"});
+  root["records"][1].forEachItem([id](const cerberus::FlatNode& key, const cerberus::FlatNode&)
+  {
+    if(key.scalar() == "id")
+      REQUIRE(&key.scalar() == id);
+  });
+
+  auto json = cerberus::FlatDocument::load(R"({"name": "test", "records": [{"id": 1, "tags": ["a"]}, {"id": -1, "tags": []}], "id": null})");
+  REQUIRE(json.root()["records"][0]["tags"][0].scalar() == "a");
+  REQUIRE(json.root()["id"].isNull());
+
+  cerberus::FlatValidator validator;
+  cerberus::Validator reference;
+  auto schema = YAML::Load(
+    "name: {type: string, regex: '[a-z]+'}\n"
+    "records: {type: list, schema: {type: dict, schema: {id: {type: integer, min: 0}, tags: {type: list, minlength: 1, schema: {type: string, allowed: [a, b]}}}}}\n"
+    "empty: {nullable: true}\n"
+    "id: {type: integer, nullable: false}\n"
+  );
+  REQUIRE(validator.validate(root, schema) == reference.validate(root.toYaml(), schema));
+  REQUIRE(!validator.validate(json.root(), schema));
+  std::stringstream expected, errors;
+  reference.validate(YAML::Load(R"({"name": "test", "records": [{"id": 1, "tags": ["a"]}, {"id": -1, "tags": []}], "id": null})"), schema);
+  reference.printErrors(expected);
+  validator.printErrors(errors);
+  REQUIRE(errors.str() == expected.str());
+
+  // Converting a flat document back yields the same YAML document
+  REQUIRE(YAML::Dump(cerberus::FlatDocument::fromYaml(json.root().toYaml()).root().toYaml()) == YAML::Dump(json.root().toYaml()));
+
+  // Converted scalars are independent of each other
+  auto name = json.root()["name"].toYaml();
+  auto tag = json.root()["records"][0]["tags"][0].toYaml();
+  name = "altered";
+  REQUIRE(tag.as<std::string>() == "a");
+  REQUIRE(json.root()["name"].toYaml().as<std::string>() == "test");
+}
+
+TEST_CASE("Validating JSON documents", "[json]") {
+  for(auto testcase : testdata)
+  {
+    auto name = testcase.first;
+    SECTION(name.as<std::string>()) {
+      auto spec = testcase.second;
+
+      cerberus::Validator validator;
+      validator.setAllowUnknown(spec["allow_unknown"].as<bool>(false));
+      validator.setPurgeUnknown(spec["purge_unknown"].as<bool>(false));
+      validator.setRequireAll(spec["require_all"].as<bool>(false));
+      for (auto schema : spec["registry"])
+        validator.registerSchema(schema.first.as<std::string>(), schema.second);
+      auto compiled = validator.compile(spec["schema"]);
+
+      cerberus::Validator reference;
+      reference.setAllowUnknown(spec["allow_unknown"].as<bool>(false));
+      reference.setPurgeUnknown(spec["purge_unknown"].as<bool>(false));
+      reference.setRequireAll(spec["require_all"].as<bool>(false));
+      for (auto schema : spec["registry"])
+        reference.registerSchema(schema.first.as<std::string>(), schema.second);
+
+      std::vector<std::pair<YAML::Node, bool>> cases;
+      for (auto data : spec["success"])
+        cases.push_back({data, true});
+      for (auto data : spec["failure"])
+        cases.push_back({data, false});
+
+      for (auto dataset : cases)
+      {
+        auto json = toJson(dataset.first);
+        INFO("Validating the following document\n" << json);
+        REQUIRE(validator.validateJson(json, compiled) == dataset.second);
+
+        reference.validate(YAML::Load(json), spec["schema"]);
+        std::stringstream expected, errors;
+        reference.printErrors(expected);
+        validator.printErrors(errors);
+        REQUIRE(errors.str() == expected.str());
+        REQUIRE(YAML::Dump(validator.getDocument()) == YAML::Dump(reference.getDocument()));
+      }
+    }
+  }
+}
+
+TEST_CASE("JSON documents are parsed exactly", "[json]") {
+  const std::string text = "{\n"
+                           "  \"name\": \"caf\\u00e9 \\ud83d\\ude00\",\n"
+                           "  \"escapes\": \"\\\"\\\\\\/\\b\\f\\n\\r\\t\",\n"
+                           "  \"numbers\": [0, -1, 2.5, 1e3, -0.25E-2],\n"
+                           "  \"flags\": [true, false, null],\n"
+                           "  \"empty\": {\"list\": [], \"map\": {}}\n"
+                           "}\n";
+  cerberus::Validator validator;
+  REQUIRE(validator.validateJson(text, YAML::Load(
+    "name: {type: string}\n"
+    "escapes: {type: string}\n"
+    "numbers: {type: list, schema: {type: float}}\n"
+    "flags: {type: list, schema: {type: boolean, nullable: true}}\n"
+    "empty: {type: dict, schema: {list: {type: list}, map: {type: dict}}}\n"
+  )));
+  auto document = validator.getDocument();
+  REQUIRE(document["name"].as<std::string>() == "caf\xc3\xa9 \xf0\x9f\x98\x80");
+  REQUIRE(document["escapes"].as<std::string>() == "\"\\/\b\f\n\r\t");
+  REQUIRE(document["numbers"][3].as<double>() == 1000.0);
+  REQUIRE(document["numbers"][4].as<std::string>() == "-0.25E-2");
+  REQUIRE(document["flags"][0].as<bool>());
+  REQUIRE(document["flags"][2].IsNull());
+  REQUIRE(document["empty"]["list"].IsSequence());
+  REQUIRE(document["empty"]["map"].IsMap());
+
+  // The parser builds flat documents as well
+  auto flat = cerberus::FlatDocument::loadJson(text);
+  REQUIRE(flat.root()["name"].scalar() == document["name"].as<std::string>());
+  REQUIRE(flat.root()["flags"][2].isNull());
+  REQUIRE(flat.root()["empty"]["map"].isMap());
+  REQUIRE(flat.root()["numbers"][4].scalar() == "-0.25E-2");
+
+  // Nesting is not limited by the call stack
+  auto deep = cerberus::FlatDocument::loadJson(std::string(100000, '[') + std::string(100000, ']'));
+  auto node = deep.root();
+  for(int depth = 1; depth < 100000; ++depth)
+    node = node[0];
+  REQUIRE(node.isSequence());
+  REQUIRE(node.size() == 0);
+}
+
+TEST_CASE("JSON parse errors are located", "[json]") {
+  auto location = [](const std::string& text)
+  {
+    cerberus::Validator validator;
+    try
+    {
+      validator.validateJson(text, YAML::Load("a: {}"));
+    }
+    catch(const cerberus::JsonError& e)
+    {
+      return std::make_pair(e.line(), e.column());
+    }
+    return std::make_pair(std::size_t(0), std::size_t(0));
+  };
+  using Location = std::pair<std::size_t, std::size_t>;
+  REQUIRE(location("") == Location(1, 1));
+  REQUIRE(location("{\"a\": 1,}") == Location(1, 9));
+  REQUIRE(location("{\n  \"a\": [1, 2\n  \"b\": 3\n}") == Location(3, 3));
+  REQUIRE(location("{\n  \"a\": tru\n}") == Location(2, 8));
+  REQUIRE(location("{\"a\": \"\\x\"}") == Location(1, 8));
+  REQUIRE(location("{\"a\": \"\\ud83d\"}") == Location(1, 8));
+  REQUIRE(location("{\"a\": \"line\nbreak\"}") == Location(1, 12));
+  REQUIRE(location("{\"a\": 01}") == Location(1, 8));
+  REQUIRE(location("{\"a\": -}") == Location(1, 8));
+  REQUIRE(location("{a: 1}") == Location(1, 2));
+  REQUIRE(location("{\"a\" 1}") == Location(1, 6));
+  REQUIRE(location("{\"a\": 1} {}") == Location(1, 10));
+  REQUIRE(location("[1, 2") == Location(1, 6));
+  REQUIRE(location("\"unterminated") == Location(1, 14));
+
+  cerberus::Validator validator;
+  REQUIRE_THROWS_WITH(validator.validateJson("{\"a\": 1,}", YAML::Load("a: {}")), "JSON parse error at line 1, column 9: Expected a string as object key");
+}
+
+TEST_CASE("Validating documents from a stream", "[streaming]") {
+  for(auto testcase : testdata)
+  {
+    auto name = testcase.first;
+    SECTION(name.as<std::string>()) {
+      auto spec = testcase.second;
+
+      cerberus::Validator validator;
+      validator.setAllowUnknown(spec["allow_unknown"].as<bool>(false));
+      validator.setPurgeUnknown(spec["purge_unknown"].as<bool>(false));
+      validator.setRequireAll(spec["require_all"].as<bool>(false));
+      for (auto schema : spec["registry"])
+        validator.registerSchema(schema.first.as<std::string>(), schema.second);
+      auto compiled = validator.compile(spec["schema"]);
+
+      // Schemas that need the entire document are rejected
+      std::unique_ptr<cerberus::StreamingValidator> streaming;
+      try
+      {
+        streaming = std::make_unique<cerberus::StreamingValidator>(validator, compiled);
+      }
+      catch(const cerberus::StreamingError&)
+      {
+        std::stringstream schema;
+        schema << spec["schema"];
+        REQUIRE((compiled.isNormalizing() || spec["purge_unknown"].as<bool>(false) ||
+                 (schema.str().find("dependencies") != std::string::npos) ||
+                 (schema.str().find("excludes") != std::string::npos)));
+        continue;
+      }
+
+      for (auto data : spec["success"])
+      {
+        std::stringstream stream;
+        stream << data;
+        INFO(stream.str());
+        REQUIRE(streaming->validate(stream));
+      }
+      for (auto data : spec["failure"])
+      {
+        std::stringstream stream;
+        stream << data;
+        INFO(stream.str());
+        REQUIRE(!streaming->validate(stream));
+      }
+    }
+  }
+}
+
+TEST_CASE("Streaming validation reports the errors of regular validation", "[streaming]") {
+  cerberus::Validator validator;
+  auto schema = validator.compile(YAML::Load(
+    "name: {type: string, required: true}                                                               \n"
+    "records: {type: list, schema: {type: dict, schema: {id: {type: integer, min: 0}, tags: {type: list, minlength: 1}}}} \n"
+    "lookup: {type: dict, valuesrules: {type: integer}, keysrules: {type: string, regex: '[a-z]+'}}    \n"
+    "pair: {type: list, items: [{type: integer}, {type: string, required: true}]}                       \n"
+  ));
+
+  std::string document =
+    "records:                \n"
+    "  - {id: 1, tags: [a]}  \n"
+    "  - {id: -1, tags: []}  \n"
+    "  - {x: 1}              \n"
+    "lookup: {a: 1, B: 2, c: x}\n"
+    "pair: [1]               \n"
+    "foo: 1                  \n";
+
+  REQUIRE(!validator.validate(YAML::Load(document), schema));
+  std::stringstream errors;
+  validator.printErrors(errors);
+  std::vector<std::string> expected;
+  for(std::string line; std::getline(errors, line);)
+    expected.push_back(line);
+
+  cerberus::StreamingValidator streaming(validator, schema);
+  std::stringstream stream(document);
+  REQUIRE(!streaming.validate(stream));
+  std::stringstream streamed_errors;
+  streaming.printErrors(streamed_errors);
+  std::vector<std::string> streamed;
+  for(std::string line; std::getline(streamed_errors, line);)
+    streamed.push_back(line);
+
+  // The errors are reported in the order of the document
+  REQUIRE(streamed.front() == "Error validating data field ^records[1].id");
+  std::sort(expected.begin(), expected.end());
+  std::sort(streamed.begin(), streamed.end());
+  REQUIRE(streamed == expected);
+
+  // Aliases to anchors outside of a record are reported
+  std::stringstream aliases("{name: x, records: [&a {id: 1, tags: [a]}, *a], pair: [1, &b x, *b]}");
+  REQUIRE(!streaming.validate(aliases));
+  REQUIRE(streaming.getErrors().size() == 1);
+  REQUIRE(streaming.getErrors().front().path == "^records[1]");
+
+  // Schemas that need the entire document are rejected
+  REQUIRE_THROWS_AS(cerberus::StreamingValidator(validator, validator.compile(YAML::Load("a: {default: 1}"))), cerberus::StreamingError);
+  REQUIRE_THROWS_AS(cerberus::StreamingValidator(validator, validator.compile(YAML::Load("a: {dependencies: b}"))), cerberus::StreamingError);
+}
+
+TEST_CASE("Generated validators behave like read-only validation", "[codegen]") {
+  // Most test cases are read-only and can be translated
+  REQUIRE(testvalidators::validators().size() > testdata.size() / 2);
+
+  for(auto testcase : testdata)
+  {
+    auto name = testcase.first;
+    SECTION(name.as<std::string>()) {
+      auto spec = testcase.second;
+      auto generated = testvalidators::validators().find(name.as<std::string>());
+      if(generated == testvalidators::validators().end())
+        continue;
+
+      const bool allow_unknown = spec["allow_unknown"].as<bool>(false);
+      const bool require_all = spec["require_all"].as<bool>(false);
+      cerberus::Validator reference;
+      reference.setValidationMode(cerberus::ValidationMode::READ_ONLY);
+      reference.setAllowUnknown(allow_unknown);
+      reference.setRequireAll(require_all);
+      for (auto schema : spec["registry"])
+        reference.registerSchema(schema.first.as<std::string>(), schema.second);
+
+      std::vector<std::pair<YAML::Node, bool>> cases;
+      for (auto data : spec["success"])
+        cases.push_back({data, true});
+      for (auto data : spec["failure"])
+        cases.push_back({data, false});
+
+      for (auto dataset : cases)
+      {
+        INFO("Validating the following document\n" << dataset.first);
+        std::stringstream expected, errors, flat_errors;
+        REQUIRE(generated->second.yaml(dataset.first, allow_unknown, require_all, errors) == dataset.second);
+
+        // The errors are the same as for the interpreting validator
+        REQUIRE(reference.validate(dataset.first, spec["schema"]) == dataset.second);
+        reference.printErrors(expected);
+        REQUIRE(errors.str() == expected.str());
+
+        // Generated validators work with any document model
+        auto document = cerberus::FlatDocument::fromYaml(dataset.first);
+        REQUIRE(generated->second.flat(document.root(), allow_unknown, require_all, flat_errors) == dataset.second);
+        REQUIRE(flat_errors.str() == expected.str());
+      }
+    }
+  }
+}
+
+TEST_CASE("Code generation rejects schemas it cannot translate", "[codegen]") {
+  cerberus::CodeGenerator generator;
+
+  // Invalid schemas are reported just like by the validator
+  REQUIRE_THROWS_AS(generator.generate(YAML::Load("field: {type: integer, foobar: true}"), "Invalid"), cerberus::SchemaError);
+
+  // Comparisons need a built-in type to decode values at generation time
+  REQUIRE_THROWS_AS(generator.generate(YAML::Load("field: {allowed: [a, b]}"), "Untyped"), cerberus::CodegenError);
+  REQUIRE_THROWS_AS(generator.generate(YAML::Load("field: {type: [integer, string], min: 1}"), "Untyped"), cerberus::CodegenError);
+  REQUIRE_THROWS_AS(generator.generate(YAML::Load("field: {type: integer, max: abc}"), "Undecodable"), cerberus::CodegenError);
+
+  // Normalization rules are not silently skipped
+  REQUIRE_THROWS_AS(generator.generate(YAML::Load("field: {type: integer, default: 1}"), "Normalizing"), cerberus::CodegenError);
+  REQUIRE_THROWS_AS(generator.generate(YAML::Load("field: {type: string, rename: other}"), "Normalizing"), cerberus::CodegenError);
+  REQUIRE_THROWS_AS(generator.generate(YAML::Load("field: {type: dict, purge_unknown: true}"), "Normalizing"), cerberus::CodegenError);
+  REQUIRE_NOTHROW(generator.generate(YAML::Load("field: {type: dict, purge_unknown: false}"), "Validating"));
+
+  // Registered schemas are resolved at generation time
+  generator.registerSchema("person", YAML::Load("name: {type: string}"));
+  auto header = generator.generateHeader(YAML::Load("people: {type: list, schema: {type: dict, schema: person}}"), "People", "app::schemas");
+  REQUIRE(header.find("#ifndef CERBERUS_GENERATED_APP__SCHEMAS_PEOPLE_HH") != std::string::npos);
+  REQUIRE(header.find("namespace app {") != std::string::npos);
+  REQUIRE(header.find("namespace schemas {") != std::string::npos);
+  REQUIRE(header.find("struct PeopleSchema") != std::string::npos);
+  REQUIRE(header.find("using People = cerberus::generated::Validator<PeopleSchema>;") != std::string::npos);
+}
+
+#ifdef CERBERUS_CPP_TEST_CODEGEN
+TEST_CASE("Validators are generated at build time", "[codegen]") {
+  codegen::test::Person validator;
+  REQUIRE(validator.validate(YAML::Load("{name: alice, age: 42, role: admin, tags: [a, b]}")));
+  REQUIRE(!validator.validate(YAML::Load("{name: Bob, age: 200, role: guest, tags: [1, [2]], other: 0}")));
+  REQUIRE(validator.getErrors().size() == 5);
+
+  std::stringstream errors;
+  errors << validator;
+  REQUIRE(errors.str().find("Error validating data field ^tags[1]\nMessage: Type-Rule violated") != std::string::npos);
+
+  validator.setAllowUnknown(true);
+  REQUIRE(validator.validate(YAML::Load("{name: carol, age: 1, role: user, other: 0}")));
+  validator.setRequireAll(true);
+  REQUIRE(!validator.validate(YAML::Load("{name: carol, age: 1, role: user, other: 0}")));
+  REQUIRE(validator.getErrors().size() == 1);
+  REQUIRE(validator.getErrors()[0].path == "^tags");
+  REQUIRE(validator.getErrors()[0].message == "Required-Rule violated!");
+}
+#endif
+
+// Test cases of the test data written with the compile-time schema DSL
+namespace dslschemas {
+
+  using namespace cerberus::dsl;
+
+  CERBERUS_DSL_STRING(Admin, "admin");
+  CERBERUS_DSL_STRING(Bar, "bar");
+  CERBERUS_DSL_STRING(Email, "email");
+  CERBERUS_DSL_STRING(EmailPattern, "^[a-zA-Z0-9_.+-]+@[a-zA-Z0-9-]+\\.[a-zA-Z0-9-.]+$");
+  CERBERUS_DSL_STRING(Field, "field");
+  CERBERUS_DSL_STRING(Field1, "field1");
+  CERBERUS_DSL_STRING(Field2, "field2");
+  CERBERUS_DSL_STRING(Field3, "field3");
+  CERBERUS_DSL_STRING(FieldName, "Field");
+  CERBERUS_DSL_STRING(Foo, "foo");
+  CERBERUS_DSL_STRING(Level, "level");
+  CERBERUS_DSL_STRING(Linear, "linear");
+  CERBERUS_DSL_STRING(Model, "model");
+  CERBERUS_DSL_STRING(Models, "models");
+  CERBERUS_DSL_STRING(Mylist, "mylist");
+  CERBERUS_DSL_STRING(Name, "name");
+  CERBERUS_DSL_STRING(Nested, "nested");
+  CERBERUS_DSL_STRING(Nonlinear, "nonlinear");
+  CERBERUS_DSL_STRING(Other, "other");
+  CERBERUS_DSL_STRING(OtherField1, "^other.field1");
+  CERBERUS_DSL_STRING(Roles, "roles");
+  CERBERUS_DSL_STRING(Root, "root");
+  CERBERUS_DSL_STRING(Sub, "sub");
+  CERBERUS_DSL_STRING(Sub1, "sub1");
+  CERBERUS_DSL_STRING(Sub2, "sub2");
+  CERBERUS_DSL_STRING(Third, "third");
+  CERBERUS_DSL_STRING(User, "user");
+  CERBERUS_DSL_STRING(Users, "users");
+  CERBERUS_DSL_STRING(UsersName, "^users[1].name");
+  CERBERUS_DSL_STRING(Uuid, "uuid");
+  CERBERUS_DSL_STRING(Values, "values");
+
+  using AllowUnknownSimple = dict<field<Field, type<types::dict>, schema<dict<field<Sub, type<types::string>>>>, allow_unknown<true>>>;
+  using AllowedList = dict<field<Models, type<types::list>, schema<rules<type<types::string>, allowed<Linear, Nonlinear>>>>>;
+  using AllowedInteger = dict<field<Level, type<types::integer>, allowed<int_<1>, int_<2>, int_<16>>>>;
+  using AllowedSimple = dict<field<Model, type<types::string>, allowed<Linear, Nonlinear>>>;
+  using ContainsList = dict<field<Users, type<types::list>, contains<Admin, Root>>>;
+  using ContainsSimple = dict<field<Users, type<types::list>, contains<Admin>>>;
+  using DefaultSimple = dict<field<Uuid, type<types::integer>, default_<int_<1042>>>>;
+  using DependenciesDict = dict<field<Field1, required<false>>, field<Field2, required<false>, dependencies<dependency<Field1, Foo>>>>;
+  using DependenciesDictWithList = dict<field<Field1, required<false>>, field<Field2, required<false>, dependencies<dependency<Field1, Foo, Bar>>>>;
+  using DependenciesList = dict<field<Field1, required<false>>, field<Field2, required<false>>, field<Field3, required<false>, dependencies<Field1, Field2>>>;
+  using DependenciesListIndex = dict<field<Field, required<false>, dependencies<UsersName>>, field<Users, type<types::list>>>;
+  using DependenciesRoot = dict<field<Nested, type<types::dict>, schema<dict<field<Field2, required<false>, dependencies<OtherField1>>>>>,
+                                field<Other, type<types::dict>, schema<dict<field<Field1, required<false>>>>>>;
+  using DependenciesSimple = dict<field<Field1, required<false>>, field<Field2, required<false>, dependencies<Field1>>>;
+  using EmptySimple = dict<field<Mylist, type<types::list>, empty<false>>>;
+  using ExcludesList = dict<field<Field, required<false>, excludes<Other, Third>>, field<Other, required<false>>, field<Third, required<false>>>;
+  using ExcludesSimple = dict<field<Field, required<false>, excludes<Other>>, field<Other, required<false>>>;
+  using ForbiddenSimple = dict<field<User, type<types::string>, forbidden<Admin, Root>>>;
+  using ItemsSimple = dict<field<Field, type<types::list>, items<rules<type<types::integer>>, rules<type<types::string>>>>>;
+  using KeysrulesSimple = dict<field<Users, type<types::dict>, keysrules<type<types::string>, forbidden<Admin>>>>;
+  using MinSimple = dict<field<Uuid, type<types::integer>, min<1000>>>;
+  using MaxSimple = dict<field<Uuid, type<types::integer>, max<1000>>>;
+  using MinMaxFloatList = dict<field<Values, type<types::list>, schema<rules<type<types::float_>, min_value<ratio<-1, 2>>, max_value<ratio<25>>>>>>;
+  using MinlengthListSimple = dict<field<Field, type<types::list>, minlength<2>, schema<rules<type<types::integer>>>>>;
+  using MaxlengthListSimple = dict<field<Field, type<types::list>, maxlength<1>, schema<rules<type<types::integer>>>>>;
+  using MetaSimple = dict<field<Field, type<types::string>, meta<entry<Name, FieldName>>>>;
+  using NullableSimple = dict<field<Field, nullable<true>, type<types::string>>>;
+  using NullableWithout = dict<field<Field, type<types::string>>>;
+  using RegexSimple = dict<field<Email, type<types::string>, regex<EmailPattern>>>;
+  using RenameSimple = dict<field<Foo, type<types::string>, cerberus::dsl::rename<Bar>>>;
+  using RequireAllSimple = dict<field<Foo, type<types::dict>, require_all<true>, schema<dict<field<Sub1, type<types::string>>, field<Sub2, type<types::string>>>>>,
+                                field<Bar, type<types::string>>>;
+  using RequiredSimple = dict<field<Uuid, type<types::integer>, required<true>>>;
+  using SchemaDictSimple = dict<field<User, type<types::dict>, schema<dict<field<Uuid, type<types::integer>, required<true>>>>>>;
+  using SchemaListSimple = dict<field<Field, type<types::list>, schema<rules<type<types::integer>>>>>;
+  using TypeSimple = dict<field<Field, type<types::integer>>>;
+  using TypeList = dict<field<Field, type<types::integer, types::float_>>>;
+  using ValuesrulesSimple = dict<field<Roles, type<types::dict>, valuesrules<type<types::string>, forbidden<Admin>>>>;
+
+  struct Case
+  {
+    YAML::Node (*schema)();
+    bool (*yaml)(const YAML::Node&, bool, bool, std::ostream&);
+    bool (*flat)(const cerberus::FlatNode&, bool, bool, std::ostream&);
+  };
+
+  template<typename Schema>
+  Case make_case()
+  {
+    return {&to_yaml<Schema>,
+            &testvalidators::run<Validator<Schema>, YAML::Node>,
+            &testvalidators::run<Validator<Schema>, cerberus::FlatNode>};
+  }
+
+  const std::map<std::string, Case> cases = {
+    {"allow_unknown-simple", make_case<AllowUnknownSimple>()},
+    {"allowed-list", make_case<AllowedList>()},
+    {"allowed-integer", make_case<AllowedInteger>()},
+    {"allowed-simple", make_case<AllowedSimple>()},
+    {"contains-list", make_case<ContainsList>()},
+    {"contains-simple", make_case<ContainsSimple>()},
+    {"default-simple", make_case<DefaultSimple>()},
+    {"dependencies-dict", make_case<DependenciesDict>()},
+    {"dependencies-dict-with-list", make_case<DependenciesDictWithList>()},
+    {"dependencies-list", make_case<DependenciesList>()},
+    {"dependencies-list-index", make_case<DependenciesListIndex>()},
+    {"dependencies-root", make_case<DependenciesRoot>()},
+    {"dependencies-simple", make_case<DependenciesSimple>()},
+    {"empty-simple", make_case<EmptySimple>()},
+    {"excludes-list", make_case<ExcludesList>()},
+    {"excludes-simple", make_case<ExcludesSimple>()},
+    {"forbidden-simple", make_case<ForbiddenSimple>()},
+    {"items-simple", make_case<ItemsSimple>()},
+    {"keysrules-simple", make_case<KeysrulesSimple>()},
+    {"min-simple", make_case<MinSimple>()},
+    {"max-simple", make_case<MaxSimple>()},
+    {"min-max-float-list", make_case<MinMaxFloatList>()},
+    {"minlength-list-simple", make_case<MinlengthListSimple>()},
+    {"maxlength-list-simple", make_case<MaxlengthListSimple>()},
+    {"meta-simple", make_case<MetaSimple>()},
+    {"nullable-simple", make_case<NullableSimple>()},
+    {"nullable-without", make_case<NullableWithout>()},
+    {"regex-simple", make_case<RegexSimple>()},
+    {"rename-simple", make_case<RenameSimple>()},
+    {"require_all-simple", make_case<RequireAllSimple>()},
+    {"required-simple", make_case<RequiredSimple>()},
+    {"schema-dict-simple", make_case<SchemaDictSimple>()},
+    {"schema-list-simple", make_case<SchemaListSimple>()},
+    {"type-simple", make_case<TypeSimple>()},
+    {"type-list", make_case<TypeList>()},
+    {"valuesrules-simple", make_case<ValuesrulesSimple>()},
+  };
+
+} // namespace dslschemas
+
+TEST_CASE("Schemas written with the DSL behave like their YAML equivalent", "[dsl]") {
+  for(const auto& testcase : dslschemas::cases)
+  {
+    SECTION(testcase.first) {
+      auto spec = testdata[testcase.first];
+      const auto schema = testcase.second.schema();
+      const bool allow_unknown = spec["allow_unknown"].as<bool>(false);
+      const bool require_all = spec["require_all"].as<bool>(false);
+
+      // The exported schema is a valid schema, which is validated read-only just like the DSL
+      cerberus::Validator reference;
+      reference.setValidationMode(cerberus::ValidationMode::READ_ONLY);
+      reference.setAllowUnknown(allow_unknown);
+      reference.setRequireAll(require_all);
+      auto compiled = reference.compile(schema);
+
+      std::vector<std::pair<YAML::Node, bool>> cases;
+      for (auto data : spec["success"])
+        cases.push_back({data, true});
+      for (auto data : spec["failure"])
+        cases.push_back({data, false});
+
+      for (auto dataset : cases)
+      {
+        INFO("Validating the following document\n" << dataset.first);
+        std::stringstream expected, errors, flat_errors;
+        const bool valid = reference.validate(dataset.first, compiled);
+        reference.printErrors(expected);
+
+        // Without normalization, the documents of the test data are classified as expected
+        if(!compiled.isNormalizing())
+          REQUIRE(valid == dataset.second);
+
+        REQUIRE(testcase.second.yaml(dataset.first, allow_unknown, require_all, errors) == valid);
+        REQUIRE(errors.str() == expected.str());
+
+        auto document = cerberus::FlatDocument::fromYaml(dataset.first);
+        REQUIRE(testcase.second.flat(document.root(), allow_unknown, require_all, flat_errors) == valid);
+        REQUIRE(flat_errors.str() == expected.str());
+      }
+    }
+  }
+}
+
+TEST_CASE("Schemas written with the DSL are exported to YAML", "[dsl]") {
+  using namespace dslschemas;
+  using Server = dict<field<Name, type<types::string>, required<true>, regex<EmailPattern>>,
+                      field<Level, type<types::integer>, min<1>, max<65535>, allowed<int_<80>, int_<443>>, default_<int_<80>>>,
+                      field<Values, type<types::float_>, min_value<ratio<-1, 2>>, nullable<true>>,
+                      field<Users, type<types::list>, minlength<1>, schema<rules<type<types::string>, forbidden<Root>>>>,
+                      field<Roles, type<types::dict>, allow_unknown<true>, keysrules<type<types::string>>, valuesrules<contains<Admin>>>,
+                      field<Other, excludes<Users>, dependencies<dependency<Level, int_<80>>>, cerberus::dsl::rename<Third>, meta<entry<Name, FieldName>>>>;
+
+  const auto schema = to_yaml<Server>();
+  REQUIRE(schema["name"]["regex"].as<std::string>() == EmailPattern::value());
+  REQUIRE(schema["level"]["allowed"][1].as<int>() == 443);
+  REQUIRE(schema["values"]["min"].as<double>() == -0.5);
+  REQUIRE(schema["users"]["schema"]["forbidden"][0].as<std::string>() == "root");
+  REQUIRE(schema["roles"]["valuesrules"]["contains"][0].as<std::string>() == "admin");
+  REQUIRE(schema["other"]["dependencies"]["level"][0].as<int>() == 80);
+  REQUIRE(schema["other"]["meta"]["name"].as<std::string>() == "Field");
+
+  // Fields and rules keep their order
+  std::vector<std::string> fields, rules;
+  for(auto f : schema)
+    fields.push_back(f.first.as<std::string>());
+  for(auto r : schema["level"])
+    rules.push_back(r.first.as<std::string>());
+  REQUIRE(fields == std::vector<std::string>{"name", "level", "values", "users", "roles", "other"});
+  REQUIRE(rules == std::vector<std::string>{"type", "min", "max", "allowed", "default"});
+
+  cerberus::Validator reference;
+  reference.setValidationMode(cerberus::ValidationMode::READ_ONLY);
+  auto compiled = reference.compile(schema);
+  Validator<Server> validator;
+  for(auto document : {"{name: a@b.c, level: 80, values: [1.5], users: [a], roles: {x: [admin]}}",
+                       "{name: x, level: 81, values: -1, users: [], roles: {1: [a]}, other: 1}",
+                       "{name: abc, level: 443, values: ~, users: [root, [1]], roles: [], unknown: 1}"})
+  {
+    INFO("Validating the following document\n" << document);
+    const bool valid = reference.validate(YAML::Load(document), compiled);
+    REQUIRE(validator.validate(YAML::Load(document)) == valid);
+    std::stringstream expected, errors;
+    reference.printErrors(expected);
+    validator.printErrors(errors);
+    REQUIRE(errors.str() == expected.str());
+  }
+}
+
+TEST_CASE("Prepared schemas are cached", "[compile]") {
+  cerberus::Validator validator;
+  auto schema = testdata["schema-dict-registry"]["schema"];
+  validator.registerSchema("foo", testdata["schema-dict-registry"]["registry"]["foo"]);
+
+  auto prepared = validator.prepare(schema);
+  REQUIRE(&prepared.root() == &validator.prepare(YAML::Clone(schema)).root());
+  REQUIRE(&prepared.root() != &validator.compile(schema).root());
+
+  validator.registerSchema("bar", schema);
+  REQUIRE(&prepared.root() != &validator.prepare(schema).root());
+  REQUIRE(&validator.prepare("bar").root() == &validator.prepare("bar").root());
+
+  // Schema nodes are recognized by identity, copies by their content
+  auto identical = validator.prepare(schema);
+  REQUIRE(&identical.root() == &validator.prepare(schema).root());
+  REQUIRE(&identical.root() == &validator.prepare(YAML::Clone(schema)).root());
+
+  // Schemas altered in place are not validated against their previous content
+  auto altered = YAML::Load("a: {type: integer}");
+  REQUIRE(!validator.validate(YAML::Load("{a: x}"), altered));
+  altered["a"]["type"] = "string";
+  REQUIRE(validator.validate(YAML::Load("{a: x}"), altered));
+  REQUIRE(&validator.prepare(altered).root() == &validator.prepare(altered).root());
+
+  // Registered schemas are cached with the same limit
+  validator.setSchemaCacheSize(1);
+  auto registered = validator.prepare("bar");
+  REQUIRE(&registered.root() == &validator.prepare("bar").root());
+  validator.prepare("foo");
+  REQUIRE(&registered.root() != &validator.prepare("bar").root());
+
+  validator.setSchemaCacheSize(0);
+  REQUIRE(&validator.prepare(schema).root() != &validator.prepare(schema).root());
+  REQUIRE(&validator.prepare("bar").root() != &validator.prepare("bar").root());
+}
+
+TEST_CASE("Regular expressions are compiled once", "[compile]") {
+  cerberus::Validator validator;
+  auto schema = YAML::Load(
+    "first: {type: string, regex: '[a-z]+'}  \n"
+    "second: {type: string, regex: '[a-z]+'} \n"
+  );
+  auto compiled = validator.compile(schema);
+  REQUIRE(validator.getRegexCache().misses() == 1);
+  REQUIRE(validator.getRegexCache().hits() == 1);
+
+  REQUIRE(validator.validate(YAML::Load("{first: abc, second: def}"), compiled));
+  REQUIRE(!validator.validate(YAML::Load("{first: abc, second: '42'}"), compiled));
+  REQUIRE(validator.getRegexCache().misses() == 1);
+  REQUIRE(validator.getRegexCache().hits() == 1);
+}
+
+TEST_CASE("Read-only validation works in place", "[readonly]") {
+  cerberus::Validator validator;
+  auto document = YAML::Load("{field: 42}");
+  auto schema = YAML::Load("field: {type: integer}");
+  auto normalizing = YAML::Load("{field: {type: integer}, other: {type: integer, default: 0}}");
+
+  REQUIRE(validator.validate(document, schema));
+  REQUIRE(validator.getDocument().is(document));
+
+  REQUIRE(validator.validate(document, normalizing));
+  REQUIRE(!validator.getDocument().is(document));
+  REQUIRE(validator.getDocument()["other"].as<int>() == 0);
+
+  validator.setValidationMode(cerberus::ValidationMode::READ_ONLY);
+  REQUIRE(validator.validate(document, normalizing));
+  REQUIRE(validator.getDocument().is(document));
+  REQUIRE(!document["other"]);
+
+  validator.setValidationMode(cerberus::ValidationMode::NORMALIZING);
+  REQUIRE(validator.validate(document, schema));
+  REQUIRE(!validator.getDocument().is(document));
+}
+
+TEST_CASE("Custom rules do not alter the given document", "[readonly]") {
+  cerberus::Validator validator;
+  validator.registerRule(
+    YAML::Load("overwrite: {type: boolean}"),
+    [](auto& v)
+    {
+      v.getDocument() = 99;
+    }
+  );
+  auto document = YAML::Load("{a: 1, b: 1}");
+
+  REQUIRE(validator.validate(document, YAML::Load("{a: {type: integer}, b: {overwrite: true}}")));
+  REQUIRE(document["b"].as<int>() == 1);
+  REQUIRE(validator.getDocument()["b"].as<int>() == 99);
+  REQUIRE(validator.getDocument()["a"].is(document["a"]));
+}
+
+TEST_CASE("Custom rules insert missing keys when normalizing", "[readonly]") {
+  cerberus::Validator validator;
+  validator.registerRule(
+    YAML::Load("setme: {type: boolean}"),
+    [](auto& v)
+    {
+      if(!v.getDocument().IsDefined())
+        v.getDocument() = 42;
+    }
+  );
+  validator.registerRule(
+    YAML::Load("setstack: {type: boolean}"),
+    [](auto& v)
+    {
+      auto node = v.getDocumentStack().get();
+      if(!node.IsDefined())
+        node = 43;
+    }
+  );
+  validator.setValidationMode(cerberus::ValidationMode::NORMALIZING);
+  auto document = YAML::Load("{}");
+
+  REQUIRE(validator.validate(document, YAML::Load("{a: {setme: true}, b: {setstack: true}}")));
+  REQUIRE(validator.getDocument()["a"].as<int>() == 42);
+  REQUIRE(validator.getDocument()["b"].as<int>() == 43);
+  REQUIRE(document.size() == 0);
+}
+
+TEST_CASE("Normalization only copies altered subtrees", "[readonly]") {
+  cerberus::Validator validator;
+  auto document = YAML::Load("{unchanged: {value: 1}, changed: {value: 2}, list: [{}, {id: 1}]}");
+  auto original = YAML::Clone(document);
+  auto schema = YAML::Load(
+    "unchanged: {type: dict, schema: {value: {type: integer}}}                  \n"
+    "changed: {type: dict, schema: {value: {type: integer}, other: {default: 3}}} \n"
+    "list: {type: list, schema: {type: dict, schema: {id: {default: 0}}}}       \n"
+  );
+
+  REQUIRE(validator.validate(document, schema));
+  auto normalized = validator.getDocument();
+  REQUIRE(YAML::Dump(document) == YAML::Dump(original));
+  REQUIRE(normalized["unchanged"].is(document["unchanged"]));
+  REQUIRE(normalized["list"][1].is(document["list"][1]));
+  REQUIRE(normalized["changed"]["value"].is(document["changed"]["value"]));
+  REQUIRE(normalized["changed"]["other"].as<int>() == 3);
+  REQUIRE(normalized["list"][0]["id"].as<int>() == 0);
+  REQUIRE(normalized["list"][1]["id"].as<int>() == 1);
+}
+
+TEST_CASE("Normalizing a key of a wide mapping copies it in linear time", "[readonly]") {
+  std::ostringstream document_text, schema_text;
+  document_text << "wide: {";
+  schema_text << "wide: {type: dict, schema: {";
+  for(int i = 0; i < 5000; ++i)
+  {
+    document_text << (i ? ", " : "") << "key" << i << ": {value: " << i << "}";
+    schema_text << (i ? ", " : "") << "key" << i << ": {type: dict, schema: {value: {type: integer}"
+                << ((i == 42) ? ", other: {default: 3}" : "") << "}}";
+  }
+  document_text << "}";
+  schema_text << "}}";
+  auto document = YAML::Load(document_text.str());
+  auto original = YAML::Clone(document);
+
+  cerberus::Validator validator;
+  validator.setValidationMode(cerberus::ValidationMode::COPY_ON_WRITE);
+  REQUIRE(validator.validate(document, YAML::Load(schema_text.str())));
+  auto normalized = validator.getDocument();
+  REQUIRE(YAML::Dump(document) == YAML::Dump(original));
+  REQUIRE(normalized["wide"].size() == 5000);
+  REQUIRE(normalized["wide"]["key42"]["other"].as<int>() == 3);
+  REQUIRE(normalized["wide"]["key4999"]["value"].as<int>() == 4999);
+  REQUIRE(normalized["wide"]["key43"].is(document["wide"]["key43"]));
+}
+
+TEST_CASE("Error paths are rendered from the document stack", "[error]") {
+  cerberus::Validator validator;
+  auto schema = YAML::Load("users: {type: list, schema: {type: dict, schema: {name: {type: string}, age: {type: integer}}}}");
+
+  REQUIRE(!validator.validate(YAML::Load("{users: [{name: a, age: 1}, {name: b, age: x}]}"), schema));
+  std::stringstream errors;
+  validator.printErrors(errors);
+  REQUIRE(errors.str().find("^users[1].age") != std::string::npos);
+
+  REQUIRE(!validator.validate(YAML::Load("{users: [{name: [], age: 1}]}"), schema));
+  errors.str("");
+  validator.printErrors(errors);
+  REQUIRE(errors.str().find("^users[0].name") != std::string::npos);
+}
+
+TEST_CASE("Allowed values are decoded once", "[compile]") {
+  cerberus::Validator validator;
+  validator.registerType<Year>("year");
+  auto schema = YAML::Load(
+    "released: {type: year, allowed: [2001, 1984, 2020]}\n"
+    "level: {type: integer, forbidden: [3, 7]}          \n"
+  );
+
+  REQUIRE(validator.validate(YAML::Load("{released: 1984, level: 1}"), schema));
+  REQUIRE(validator.validate(YAML::Load("{released: '2020'}"), schema));
+  REQUIRE(!validator.validate(YAML::Load("{released: 1985}"), schema));
+  REQUIRE(!validator.validate(YAML::Load("{released: abc}"), schema));
+  REQUIRE(!validator.validate(YAML::Load("{level: 7}"), schema));
+
+  std::stringstream errors;
+  validator.printErrors(errors);
+  REQUIRE(errors.str().find("Forbidden-Rule violated: 7") != std::string::npos);
+}
+
+TEST_CASE("Custom rules validate against uncompiled subschemas", "[compile]") {
+  cerberus::Validator validator;
+  validator.registerRule(
+    YAML::Load("nested: {type: dict}"),
+    [](auto& v)
+    {
+      v.validateDict(v.getSchema());
+    }
+  );
+  auto schema = YAML::Load("item: {type: dict, nested: {name: {type: string, regex: '[a-z]+'}, count: {default: 3}}}");
+  auto document = YAML::Load("{item: {name: abc}}");
+  auto original = YAML::Clone(document);
+
+  // The normalizing subschema switches the automatically chosen read-only access to copy-on-write
+  REQUIRE(validator.validate(document, schema));
+  REQUIRE(YAML::Dump(document) == YAML::Dump(original));
+  REQUIRE(validator.getDocument()["item"]["count"].as<int>() == 3);
+  REQUIRE(validator.getDocument()["item"]["name"].is(document["item"]["name"]));
+
+  // The subschema is compiled once, which looks up its regex once
+  REQUIRE(!validator.validate(YAML::Load("{item: {name: ABC}}"), schema));
+  REQUIRE(validator.validate(YAML::Load("{item: {name: xyz, count: 1}}"), schema));
+  REQUIRE(validator.getDocument()["item"]["count"].as<int>() == 1);
+  REQUIRE(validator.getRegexCache().misses() + validator.getRegexCache().hits() == 1);
+
+  // A subschema altered in place is compiled again
+  auto bounds = YAML::Load("{type: integer, min: 0}");
+  validator.registerRule(
+    YAML::Load("bounded: {type: boolean}"),
+    [bounds](auto& v)
+    {
+      v.validateItem(bounds);
+    }
+  );
+  auto bounded = YAML::Load("value: {bounded: true}");
+  REQUIRE(validator.validate(YAML::Load("{value: 5}"), bounded));
+  bounds["min"] = 10;
+  REQUIRE(!validator.validate(YAML::Load("{value: 5}"), bounded));
+}
+
+TEST_CASE("Unknown keys are detected in large mappings", "[validate]") {
+  cerberus::Validator validator;
+  YAML::Node schema, document;
+  for(int i = 0; i < 2000; ++i)
+  {
+    schema["key" + std::to_string(i)]["type"] = "integer";
+    document["key" + std::to_string(i)] = i;
+  }
+  schema["old"]["rename"] = "new";
+  document["old"] = 1;
+
+  REQUIRE(validator.validate(document, schema));
+
+  document["unknown"] = 42;
+  REQUIRE(!validator.validate(document, schema));
+
+  validator.setPurgeUnknown(true);
+  REQUIRE(validator.validate(document, schema));
+  REQUIRE(!validator.getDocument()["unknown"]);
+  REQUIRE(validator.getDocument()["new"].as<int>() == 1);
+  REQUIRE(validator.getDocument().size() == 2001);
+}
+
+TEST_CASE("Lookups in large mappings are indexed", "[validate]") {
+  YAML::Node schema, document;
+  for(int i = 0; i < 100; ++i)
+  {
+    schema["key" + std::to_string(i)]["type"] = "integer";
+    document["key" + std::to_string(i)] = i;
+  }
+  schema["defaulted"]["default"] = 1;
+  schema["dependent"]["dependencies"] = "defaulted";
+  schema["old"]["rename"] = "new";
+  schema["new"]["dependencies"] = "^key42";
+  document["dependent"] = 2;
+  document["old"] = 3;
+
+  for(auto mode : {cerberus::ValidationMode::AUTOMATIC, cerberus::ValidationMode::NORMALIZING})
+  {
+    cerberus::Validator validator;
+    validator.setValidationMode(mode);
+    REQUIRE(validator.validate(document, schema));
+    auto normalized = validator.getDocument();
+    REQUIRE(normalized["defaulted"].as<int>() == 1);
+    REQUIRE(normalized["new"].as<int>() == 3);
+    REQUIRE(!normalized["old"]);
+    REQUIRE(normalized["key99"].as<int>() == 99);
+    REQUIRE(!document["defaulted"]);
+  }
+
+  cerberus::Validator validator;
+  validator.setValidationMode(cerberus::ValidationMode::READ_ONLY);
+  REQUIRE(!validator.validate(document, schema));
+  schema.remove("defaulted");
+  document["key42"] = "abc";
+  REQUIRE(!validator.validate(document, schema));
+}
+
+TEST_CASE("Validation stops at the maximum number of errors", "[error]") {
+  cerberus::Validator validator;
+  auto schema = YAML::Load("{values: {type: list, schema: {type: integer}}, other: {type: integer}}");
+  auto document = YAML::Load("{values: [a, 1, b, c], other: d}");
+  auto count = [&validator]()
+  {
+    std::stringstream errors;
+    validator.printErrors(errors);
+    auto text = errors.str();
+    std::size_t n = 0;
+    for(auto pos = text.find("Message"); pos != std::string::npos; pos = text.find("Message", pos + 1))
+      ++n;
+    return n;
+  };
+
+  REQUIRE(!validator.validate(document, schema));
+  REQUIRE(count() == 4);
+  REQUIRE(!validator.getErrorsTruncated());
+
+  validator.setMaxErrors(1);
+  REQUIRE(!validator.validate(document, schema));
+  REQUIRE(count() == 1);
+  REQUIRE(validator.getErrorsTruncated());
+
+  validator.setMaxErrors(3);
+  REQUIRE(!validator.validate(document, schema));
+  REQUIRE(count() == 3);
+  REQUIRE(validator.getErrorsTruncated());
+
+  REQUIRE(validator.validate(YAML::Load("{values: [1], other: 2}"), schema));
+  REQUIRE(!validator.getErrorsTruncated());
+}
+
+TEST_CASE("A validator can be shared between threads", "[concurrency]") {
+  cerberus::Validator validator;
+  auto schema = validator.compile(YAML::Load(
+    "name: {type: string, regex: '[a-z]+'}                                       \n"
+    "level: {type: integer, min: 0, default: 1}                                  \n"
+    "extra: {type: dict, allow_unknown: true, schema: {id: {type: integer}}}     \n"
+    "tags: {type: list, schema: {type: string, allowed: [a, b, c]}}              \n"
+  ));
+
+  std::vector<YAML::Node> documents;
+  std::vector<bool> expected;
+  for(int i = 0; i < 64; ++i)
+  {
+    auto document = YAML::Load("{name: abc, extra: {id: 1, other: 2}, tags: [a, b]}");
+    if(i % 3 == 0)
+      document["tags"].push_back("d");
+    if(i % 5 == 0)
+      document["unknown"] = i;
+    documents.push_back(document);
+    expected.push_back(validator.validate(document, schema));
+  }
+
+  std::vector<std::vector<bool>> results(4, std::vector<bool>(documents.size()));
+  std::vector<std::thread> threads;
+  for(std::size_t t = 0; t < results.size(); ++t)
+  {
+    // Normalization shares nodes with the given document, so each thread validates its own copy
+    std::vector<YAML::Node> copies;
+    for(const auto& document : documents)
+      copies.push_back(YAML::Clone(document));
+
+    threads.emplace_back([&, t, copies]()
+    {
+      const cerberus::Validator& shared = validator;
+      cerberus::Validator::ValidationContext context(shared);
+      for(int repeat = 0; repeat < 10; ++repeat)
+        for(std::size_t i = 0; i < copies.size(); ++i)
+        {
+          results[t][i] = shared.validate(copies[i], schema, context);
+          if(results[t][i] && (context.getDocument()["level"].as<int>() != 1))
+            results[t][i] = false;
+        }
+    });
+  }
+  for(auto& thread : threads)
+    thread.join();
+
+  for(const auto& result : results)
+    REQUIRE(result == expected);
+}
+
+TEST_CASE("Batches of documents are validated in parallel", "[concurrency]") {
+  cerberus::Validator validator;
+  auto schema = validator.compile(YAML::Load(
+    "name: {type: string, regex: '[a-z]+'}                                       \n"
+    "level: {type: integer, min: 0, default: 1}                                  \n"
+    "tags: {type: list, schema: {type: string, allowed: [a, b, c]}}              \n"
+  ));
+
+  // The documents of a sequence share their memory, which batches need to cope with
+  auto documents = YAML::Load("[]");
+  for(int i = 0; i < 500; ++i)
+  {
+    documents.push_back(YAML::Load("{name: abc, tags: [a, b]}"));
+    if(i % 3 == 0)
+      documents[i]["tags"].push_back("d");
+    if(i % 7 == 0)
+      documents[i]["level"] = -i;
+  }
+
+  cerberus::ThreadPool pool(4);
+  cerberus::BatchOptions options;
+  options.pool = &pool;
+  cerberus::Validator::ValidationContext context(validator);
+  for(std::size_t chunk : {0, 1, 7, 1000})
+  {
+    options.chunk_size = chunk;
+    auto results = validator.validateBatch(documents, schema, options);
+    REQUIRE(results.size() == documents.size());
+    for(std::size_t i = 0; i < results.size(); ++i)
+    {
+      REQUIRE(results[i].success == validator.validate(documents[i], schema, context));
+      REQUIRE(results[i].success == ((i % 3 != 0) && ((i % 7 != 0) || (i == 0))));
+      REQUIRE(results[i].errors.size() == context.getErrors().size());
+      if(results[i].success)
+        REQUIRE(results[i].document["level"].as<int>() == ((i % 7 == 0) ? 0 : 1));
+    }
+  }
+  REQUIRE(!documents[1]["level"]);
+
+  // Without a pool, a temporary one is used
+  options.pool = nullptr;
+  options.threads = 2;
+  REQUIRE(validator.validateBatch(std::vector<YAML::Node>{YAML::Load("{name: x}")}, schema, options)[0].success);
+  REQUIRE(validator.validateBatch(std::vector<YAML::Node>{}, schema, options).empty());
+
+  // Exceptions from workers are rethrown on the calling thread
+  std::vector<int> hits(100, 0);
+  REQUIRE_THROWS(pool.parallelFor(hits.size(), 3, [&](std::size_t, std::size_t begin, std::size_t end)
+  {
+    for(std::size_t i = begin; i < end; ++i)
+      ++hits[i];
+    if(begin == 42)
+      throw std::runtime_error("failed");
+  }));
+  for(auto hit : hits)
+    REQUIRE(hit == 1);
+}
+
+TEST_CASE("Streams of documents are validated in a pipeline", "[concurrency]") {
+  cerberus::Validator validator;
+  auto schema = validator.compile(YAML::Load(
+    "name: {type: string, required: true}                                        \n"
+    "level: {type: integer, min: 0, default: 1}                                  \n"
+  ));
+
+  std::stringstream input;
+  std::vector<bool> expected;
+  for(int i = 0; i < 200; ++i)
+  {
+    std::string document = (i % 3 == 0) ? "{level: 2}" : "{name: doc" + std::to_string(i) + "}";
+    input << "---\n" << document << "\n";
+    expected.push_back(validator.validate(YAML::Load(document), schema));
+  }
+
+  cerberus::ThreadPool pool(3);
+  cerberus::BatchOptions options;
+  options.pool = &pool;
+  options.queue_size = 2;
+  std::vector<std::size_t> indices;
+  std::vector<bool> results;
+  auto count = validator.validateStream(input, schema, [&](std::size_t index, cerberus::ValidationResult&& result)
+  {
+    indices.push_back(index);
+    // Assertions are only made on the main thread
+    results.push_back(result.success && (result.document["level"].as<int>() == 1));
+  }, options);
+  REQUIRE(count == expected.size());
+  REQUIRE(results == expected);
+  for(std::size_t i = 0; i < indices.size(); ++i)
+    REQUIRE(indices[i] == i);
+
+  // The documents before a syntax error are reported before the error is thrown
+  std::stringstream broken("---\n{name: a}\n---\n{name: b}\n---\n{name: [c\n");
+  std::size_t reported = 0;
+  REQUIRE_THROWS_AS(validator.validateStream(broken, schema, [&](std::size_t, cerberus::ValidationResult&&){ ++reported; }, options), YAML::ParserException);
+  REQUIRE(reported == 2);
+
+  // Exceptions from the callback stop the pipeline
+  input.clear();
+  input.seekg(0);
+  REQUIRE_THROWS_AS(validator.validateStream(input, schema, [](std::size_t index, cerberus::ValidationResult&&)
+  {
+    if(index == 10)
+      throw std::runtime_error("stop");
+  }, options), std::runtime_error);
+
+  std::stringstream empty;
+  REQUIRE(validator.validateStream(empty, schema, [](std::size_t, cerberus::ValidationResult&&){}) == 0);
+}
+
+TEST_CASE("Large lists are validated in parallel", "[concurrency]") {
+  auto schema = YAML::Load(
+    "records:                                                                    \n"
+    "  type: list                                                                \n"
+    "  schema: {type: dict, schema: {id: {type: integer, min: 0}, name: {type: string, regex: '[a-z]+'}}} \n"
+    "pair: {type: list, items: [{type: integer}, {type: list, schema: {type: integer, max: 10}}]}         \n"
+    "lookup: {type: dict, valuesrules: {type: integer, min: 0}}                  \n"
+  );
+
+  auto document = YAML::Load("{records: [], pair: [1, []], lookup: {}}");
+  for(int i = 0; i < 5000; ++i)
+  {
+    auto record = YAML::Load("{id: 0, name: abc}");
+    record["id"] = (i % 97 == 0) ? -i : i;
+    if(i % 131 == 0)
+      record["name"] = "ABC";
+    document["records"].push_back(record);
+    document["pair"][1].push_back(i % 20);
+    document["lookup"]["key" + std::to_string(i)] = (i % 89 == 0) ? -1 : i;
+  }
+
+  cerberus::Validator serial(schema);
+  REQUIRE(!serial.validate(document));
+  std::stringstream expected;
+  serial.printErrors(expected);
+
+  cerberus::Validator parallel(schema);
+  parallel.setParallelThreads(4);
+  parallel.setParallelThreshold(100);
+  REQUIRE(!parallel.validate(document));
+  std::stringstream errors;
+  parallel.printErrors(errors);
+  REQUIRE(errors.str() == expected.str());
+  REQUIRE(errors.str().find("^records[97].id") != std::string::npos);
+
+  // The errors reported before validation stops are the same as with serial validation
+  for(std::size_t max : {1, 5, 60, 10000})
+  {
+    serial.setMaxErrors(max);
+    parallel.setMaxErrors(max);
+    serial.validate(document);
+    parallel.validate(document);
+    std::stringstream expected_truncated, truncated;
+    serial.printErrors(expected_truncated);
+    parallel.printErrors(truncated);
+    REQUIRE(truncated.str() == expected_truncated.str());
+    REQUIRE(parallel.getErrorsTruncated() == serial.getErrorsTruncated());
+  }
+
+  // Lists below the threshold and normalized documents are validated serially
+  parallel.setMaxErrors(0);
+  parallel.setParallelThreshold(10000);
+  REQUIRE(!parallel.validate(document));
+  parallel.setParallelThreshold(100);
+  parallel.setValidationMode(cerberus::ValidationMode::NORMALIZING);
+  REQUIRE(!parallel.validate(document));
+  std::stringstream mutable_errors;
+  parallel.printErrors(mutable_errors);
+  REQUIRE(mutable_errors.str() == expected.str());
+}
+
+TEST_CASE("Rules are profiled", "[profile]") {
+  auto schema = YAML::Load(
+    "values: {type: list, schema: {type: integer, min: 0}}  \n"
+    "name: {type: string, regex: '[a-z]+'}                   \n"
+  );
+  auto document = YAML::Load("{values: [], name: abc}");
+  for(int i = 1; i <= 1000; ++i)
+    document["values"].push_back(i);
+
+  cerberus::Validator validator(schema);
+  REQUIRE(validator.validate(document));
+  REQUIRE(validator.getProfile().empty());
+
+#ifdef CERBERUS_CPP_PROFILING
+  validator.setProfiling(true);
+  REQUIRE(validator.validate(document));
+  const auto& profile = validator.getProfile();
+  auto min = profile.find("min");
+  REQUIRE(min != nullptr);
+  REQUIRE(min->count == 1000);
+  REQUIRE(min->max <= min->total);
+  REQUIRE(min->slowest_path.find("^values[") == 0);
+  REQUIRE(min->slowest_schema_path == "^values.schema.min");
+  REQUIRE(profile.find("type", cerberus::RulePriority::TYPECHECKING)->count == 1002);
+  REQUIRE(profile.find("type") == nullptr);
+  REQUIRE(profile.find("regex")->slowest_path == "^name");
+  REQUIRE(profile.find("regex")->slowest_schema_path == "^name.regex");
+
+  // Times include the rules applied to subdocuments
+  auto list = profile.find("schema");
+  REQUIRE(list->count == 1);
+  REQUIRE(list->total >= min->total);
+  REQUIRE(list->slowest_path == "^values");
+
+  auto entries = profile.entries();
+  REQUIRE(entries.front().rule == "schema");
+  REQUIRE(std::is_sorted(entries.begin(), entries.end(), [](const auto& a, const auto& b){ return a.total > b.total; }));
+  std::stringstream report;
+  report << profile;
+  REQUIRE(report.str().find("TYPECHECKING") != std::string::npos);
+
+  // Each validation starts a new profile, which includes lists validated in parallel
+  validator.setParallelThreads(4);
+  validator.setParallelThreshold(100);
+  REQUIRE(validator.validate(document));
+  REQUIRE(validator.getProfile().find("min")->count == 1000);
+  REQUIRE(validator.getProfile().find("type", cerberus::RulePriority::TYPECHECKING)->count == 1002);
+
+  validator.setProfiling(false);
+  REQUIRE(validator.validate(document));
+  REQUIRE(validator.getProfile().empty());
+#endif
+}
+
+TEST_CASE("Validation is traced", "[trace]") {
+  auto schema = YAML::Load(
+    "values: {type: list, schema: {type: integer}}  \n"
+    "'quoted \"key\"': {type: string}               \n"
+  );
+  auto document = YAML::Load("{values: [1, 2, 3], 'quoted \"key\"': abc}");
+
+  cerberus::Validator validator(schema);
+  validator.setParallelThreads(2);
+  validator.setParallelThreshold(2);
+  cerberus::TraceBuffer trace(1000);
+  validator.setTrace(&trace);
+  REQUIRE(validator.validate(document));
+  REQUIRE(trace.dropped() == 0);
+
+  // The trace is valid JSON in the trace-event format
+  std::stringstream json;
+  trace.writeJson(json);
+  auto events = YAML::Load(json.str())["traceEvents"];
+  REQUIRE(events.size() == trace.size());
+  std::vector<std::pair<std::string, std::string>> spans;
+  for(auto event : events)
+  {
+    REQUIRE(event["ph"].as<std::string>() == "X");
+    REQUIRE(event["dur"].as<double>() >= 0.0);
+    spans.emplace_back(event["name"].as<std::string>(), event["args"]["path"].as<std::string>());
+  }
+  auto traced = [&spans](const std::string& name, const std::string& path)
+  {
+    return std::find(spans.begin(), spans.end(), std::make_pair(name, path)) != spans.end();
+  };
+  REQUIRE(traced("validateDict", "^"));
+  REQUIRE(traced("validateItem", "^values"));
+  REQUIRE(traced("schema", "^values"));
+  REQUIRE(traced("validateItem", "^values[2]"));
+  REQUIRE(traced("type", "^values[2]"));
+  REQUIRE(traced("type", "^quoted \"key\""));
+  // Spans are recorded when they end, so the root dictionary comes last
+  REQUIRE(spans.back() == std::make_pair(std::string("validateDict"), std::string("^")));
+
+  // Full buffers keep the most recent spans
+  cerberus::TraceBuffer small(4);
+  validator.setTrace(&small);
+  REQUIRE(validator.validate(document));
+  REQUIRE(small.size() == 4);
+  REQUIRE(small.dropped() == trace.size() - 4);
+  std::stringstream small_json;
+  small.writeJson(small_json);
+  auto recent = YAML::Load(small_json.str())["traceEvents"];
+  REQUIRE(recent.size() == 4);
+  REQUIRE(recent[3]["name"].as<std::string>() == "validateDict");
+
+  // Traces are kept across validations until they are detached
+  REQUIRE(validator.validate(document));
+  REQUIRE(small.dropped() == 2 * trace.size() - 4);
+  validator.setTrace(nullptr);
+  REQUIRE(validator.validate(document));
+  REQUIRE(small.dropped() == 2 * trace.size() - 4);
+}
+
 TEST_CASE("Faulty schema throws error", "[error]") {
   cerberus::Validator validator;
   for(auto testcase : illschemas)